@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include <stdint.h>
+
+#ifdef _MIOSIX
+#include <interfaces/arch_registers.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Shared cycle counter.
+ *
+ * On Cortex-M targets the profiler, the trace recorder and the latency probes
+ * all timestamp with the DWT cycle counter. The counter is enabled once at
+ * boot by cycles_init() and never reset afterwards, so that timestamps taken
+ * by different modules share the same timebase. On linux the modules use the
+ * system clocks and cycles_init() does nothing.
+ */
+
+/**
+ * Enable the cycle counter. To be called once, right after platform_init()
+ * and before any other module reads the counter.
+ */
+void cycles_init();
+
+#ifdef _MIOSIX
+
+/**
+ * Read the cycle counter.
+ *
+ * @return current value of the free-running 32-bit cycle counter.
+ */
+static inline uint32_t cycles_get()
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * Get the number of counter cycles in one microsecond at the current core
+ * clock frequency.
+ *
+ * @return cycles per microsecond.
+ */
+static inline uint32_t cycles_perUs()
+{
+    return SystemCoreClock / 1000000;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYCLES_H */
@@ -34,11 +34,13 @@
  * This enum describes the event message type:
  * - EVENT_KBD is used to send a keypress
  * - EVENT_STATUS is used to send a status change notification
+ * - EVENT_FRAME is used by the frame scheduler to request a new frame
  */
 enum eventType_t
 {
     EVENT_KBD = 0,
-    EVENT_STATUS = 1
+    EVENT_STATUS = 1,
+    EVENT_FRAME = 2
 };
 
 /**
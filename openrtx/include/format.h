@@ -0,0 +1,153 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <datatypes.h>
+#include <interfaces/rtc.h>
+
+/**
+ * Allocation-free text formatting routines, meant to replace the printf family
+ * in the drawing paths of the user interface.
+ *
+ * All the functions write into a buffer provided by the caller, truncating the
+ * output to the buffer length and always terminating it, when the length is
+ * not zero. The return value is the number of characters written, excluding
+ * the terminator: it is always less than the buffer length, thus the output of
+ * several calls can be chained as follows:
+ *
+ *     size_t n = fmt_string(buf, sizeof(buf), "Rx:", 3);
+ *     n += fmt_frequency(buf + n, sizeof(buf) - n, freq);
+ */
+
+#define FMT_CALLSIGN_LEN 10   /**< Maximum length of a formatted callsign */
+
+/**
+ * Copy a string, like printf("%.*s", maxLen, str).
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param str: source string.
+ * @param maxLen: maximum number of characters to copy from the source.
+ * @return number of characters written.
+ */
+size_t fmt_string(char *buf, size_t len, const char *str, size_t maxLen);
+
+/**
+ * Format an unsigned integer in decimal notation, like printf("%0*u").
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param value: value to be formatted.
+ * @param width: minimum number of characters, filled on the left.
+ * @param pad: character used to fill the field, typically '0' or ' '.
+ * @return number of characters written.
+ */
+size_t fmt_unsigned(char *buf, size_t len, uint32_t value, uint8_t width,
+                    char pad);
+
+/**
+ * Format a signed integer in decimal notation, like printf("%0*d"). The minus
+ * sign is counted in the field width and always precedes the zero padding.
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param value: value to be formatted.
+ * @param width: minimum number of characters, filled on the left.
+ * @param pad: character used to fill the field, typically '0' or ' '.
+ * @return number of characters written.
+ */
+size_t fmt_integer(char *buf, size_t len, int32_t value, uint8_t width,
+                   char pad);
+
+/**
+ * Format a fixed-point number, given as an integer counting units of
+ * 10^-scale, with the requested number of decimal digits. The value is
+ * rounded half away from zero, for example 4960 with scale 3 and one decimal
+ * digit gives "5.0".
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param value: fixed-point value to be formatted.
+ * @param scale: number of decimal digits of the value, at most 9.
+ * @param decimals: number of decimal digits to print, at most scale.
+ * @return number of characters written.
+ */
+size_t fmt_decimal(char *buf, size_t len, int32_t value, uint8_t scale,
+                   uint8_t decimals);
+
+/**
+ * Format a frequency in MHz with 10Hz resolution, at least three integer
+ * digits and no rounding, for example 430125000 gives "430.12500".
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param freq: frequency in Hz.
+ * @return number of characters written.
+ */
+size_t fmt_frequency(char *buf, size_t len, freq_t freq);
+
+/**
+ * Format the time of the day as "HH:MM:SS".
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param time: time to be formatted.
+ * @return number of characters written.
+ */
+size_t fmt_time(char *buf, size_t len, curTime_t time);
+
+/**
+ * Format the date as "DD/MM/YY".
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param time: date to be formatted.
+ * @return number of characters written.
+ */
+size_t fmt_date(char *buf, size_t len, curTime_t time);
+
+/**
+ * Format a callsign: leading spaces are skipped, letters are converted to
+ * upper case and the output stops at the first character which cannot be
+ * part of a callsign or after FMT_CALLSIGN_LEN characters. Allowed characters
+ * are letters, digits, '/' and '-'.
+ *
+ * @param buf: destination buffer.
+ * @param len: destination buffer length.
+ * @param callsign: source callsign.
+ * @return number of characters written.
+ */
+size_t fmt_callsign(char *buf, size_t len, const char *callsign);
+
+#endif /* FORMAT_H */
@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef FRAMESCHED_H
+#define FRAMESCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+
+/**
+ * Frame scheduler for the UI thread.
+ *
+ * Events are applied to the UI state as soon as they are received, while the
+ * screen is redrawn at most once per frame period: the UI thread drains all
+ * the pending events, notifying each of them to the scheduler, and then asks
+ * whether a frame is due. When the previous frame is too recent, the scheduler
+ * arms a one-shot software timer posting a coalesced EVENT_FRAME to the UI
+ * queue at the beginning of the next frame slot.
+ * Widgets needing a continuous refresh, like scopes or meters, register a
+ * refresh period and get a frame at each period expiration without any other
+ * event.
+ */
+
+#ifndef FRAMESCHED_DEFAULT_FPS
+#define FRAMESCHED_DEFAULT_FPS 30  /**< Default frame rate cap               */
+#endif
+
+#define FRAMESCHED_MAX_PERIODIC 4  /**< Maximum number of periodic refreshes */
+
+/**
+ * Data structure holding the frame scheduler counters.
+ */
+typedef struct
+{
+    uint32_t events;        /**< Number of events processed                   */
+    uint32_t redraws;       /**< Events requesting a redraw                   */
+    uint32_t frames;        /**< Number of frames rendered                    */
+    uint32_t deferred;      /**< Frames delayed by the frame rate cap         */
+    uint32_t periodic;      /**< Frames requested only by periodic refreshes  */
+}
+frameschedStats_t;
+
+/**
+ * Initialise the frame scheduler, clearing the periodic refreshes and the
+ * counters.
+ *
+ * @param queue: queue where to post the frame events.
+ * @param maxFps: maximum frame rate, zero for no limit.
+ */
+void framesched_init(queue_t *queue, uint16_t maxFps);
+
+/**
+ * Change the maximum frame rate.
+ *
+ * @param maxFps: maximum frame rate, zero for no limit.
+ */
+void framesched_setMaxFps(uint16_t maxFps);
+
+/**
+ * Set the period of a continuous refresh. The first refresh happens one period
+ * after the call; setting again the same period leaves the refresh unchanged.
+ *
+ * @param id: refresh slot, from 0 to FRAMESCHED_MAX_PERIODIC - 1.
+ * @param period: refresh period in milliseconds, zero to disable the refresh.
+ */
+void framesched_setPeriodic(uint8_t id, uint16_t period);
+
+/**
+ * Notify the processing of an event.
+ *
+ * @param redraw: true if the event changed what is shown on the screen.
+ */
+void framesched_event(bool redraw);
+
+/**
+ * Check whether a frame has to be rendered now. If a frame is needed but the
+ * frame rate cap does not allow it yet, or a periodic refresh is active, the
+ * frame event timer is armed for the next deadline.
+ *
+ * @return true if a frame has to be rendered, followed by a call to
+ * framesched_frameDone().
+ */
+bool framesched_frameDue();
+
+/**
+ * Notify the rendering of a frame.
+ */
+void framesched_frameDone();
+
+/**
+ * Get the frame scheduler counters.
+ *
+ * @return counters since the scheduler initialisation.
+ */
+frameschedStats_t framesched_getStats();
+
+#endif /* FRAMESCHED_H */
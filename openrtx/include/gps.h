@@ -35,8 +35,13 @@
 /**
  * This function perfoms the task of reading data from the GPS module,
  * if available, enabled and ready, decode NMEA sentences and update
- * the radio state with the retrieved data.
+ * the GPS data with the retrieved information.
+ *
+ * @param line: NMEA sentence.
+ * @param len: length of the NMEA sentence.
+ * @param gps_data: GPS data to be updated.
+ * @param set_time: synchronise the RTC with the GPS time once a fix is done.
  */
-void gps_taskFunc(char *line, int len, state_t *state);
+void gps_taskFunc(char *line, int len, gps_t *gps_data, bool set_time);
 
 #endif /* GPS_H */
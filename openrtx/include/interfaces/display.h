@@ -90,12 +90,29 @@ void display_terminate();
 
 /**
  * Copy a given section, between two given rows, of framebuffer content to the
- * display.
+ * display. A transfer still in progress is completed before starting the new
+ * one; drivers may then return before the end of the transfer, in which case
+ * the framebuffer must not be modified until display_renderingInProgress()
+ * returns false.
+ * On displays with a 1bpp framebuffer rows are counted in pages of eight pixel
+ * rows, matching the framebuffer layout.
  * @param startRow: first row of the framebuffer section to be copied
  * @param endRow: last row of the framebuffer section to be copied
  */
 void display_renderRows(uint8_t startRow, uint8_t endRow);
 
+/**
+ * Copy a given rectangular section of framebuffer content to the display.
+ * Drivers not supporting windowed updates may copy a larger area, containing
+ * the requested one. As for display_renderRows(), drivers may return before
+ * the end of the transfer.
+ * @param x0: first column of the framebuffer section to be copied
+ * @param y0: first row of the framebuffer section to be copied
+ * @param x1: column after the last one to be copied
+ * @param y1: row after the last one to be copied
+ */
+void display_renderRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
+
 /**
  * Copy framebuffer content to the display internal buffer, to be called
  * whenever there is need to update the display.
@@ -110,6 +127,19 @@ void display_render();
  */
 bool display_renderingInProgress();
 
+/**
+ * Block the caller until the framebuffer transfer in progress, if any, is
+ * completed.
+ */
+void display_waitRender();
+
+/**
+ * Signal that all the areas of the current frame have been sent through
+ * display_renderRows() or display_renderRect(). Drivers can use it to handle
+ * complete frames instead of the single transfers.
+ */
+void display_frameDone();
+
 /**
  * Set display contrast.
  * NOTE: not all the display controllers support contrast control, thus on some
@@ -140,27 +140,45 @@ void gfx_terminate();
 /**
  * This function calls the correspondent method of the low level interface display.h
  * Copy a given section, between two given rows, of framebuffer content to the
- * display.
+ * display. On 1bpp displays rows are counted in pages of eight pixel rows.
  * @param startRow: first row of the framebuffer section to be copied
  * @param endRow: last row of the framebuffer section to be copied
  */
 void gfx_renderRows(uint8_t startRow, uint8_t endRow);
 
 /**
- * This function calls the correspondent method of the low level interface display.h
  * Copy framebuffer content to the display internal buffer. To be called
  * whenever there is need to update the display.
+ * Only the framebuffer rows changed since the previous call, restricted to the
+ * columns touched by the drawing functions, are sent to the display.
+ * Drawing functions operate on a back buffer: this function copies the changed
+ * area to the display framebuffer, starts the transfer and returns without
+ * waiting for its end, so that the next frame can be drawn in the meantime.
  */
 void gfx_render();
 
+/**
+ * Get the number of pixels sent to the display by gfx_render() since the
+ * graphics initialisation.
+ * @return number of pixels rendered.
+ */
+uint32_t gfx_getRenderedPixels();
+
 /**
  * This function calls the correspondent method of the low level interface display.h
- * Check if framebuffer is being copied to the screen or not, in which case it
- * can be modified without problems.
+ * Check if framebuffer is being copied to the screen or not. Drawing functions
+ * can be used in any case, since they operate on a separate back buffer.
  * @return false if rendering is not in progress.
  */
 bool gfx_renderingInProgress();
 
+/**
+ * This function calls the correspondent method of the low level interface display.h
+ * Block the caller until the framebuffer transfer in progress, if any, is
+ * completed.
+ */
+void gfx_waitRender();
+
 /**
  * Clears a portion of the screen content
  * This results in a black screen on color displays
@@ -253,6 +271,20 @@ uint8_t gfx_getFontHeight(fontSize_t size);
 point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
                         color_t color, const char *buf);
 
+/**
+ * Compute the area covered by the pixels of a single line of text printed by
+ * gfx_printBuffer() with the same parameters, without drawing it.
+ * @param start: text line start point, in pixel coordinates.
+ * @param size: text font size, defined as enum.
+ * @param alignment: text alignment type, defined as enum.
+ * @param buf: char buffer
+ * @param boxStart: filled with the top left corner of the covered area.
+ * @return width and height of the covered area as point_t coordinates, zero
+ * if no pixel is covered.
+ */
+point_t gfx_getTextBox(point_t start, fontSize_t size, textAlign_t alignment,
+                       const char *buf, point_t *boxStart);
+
 /**
  * Prints text on the screen at the specified coordinates.
  * @param start: text line start point, in pixel coordinates.
@@ -283,6 +315,25 @@ point_t gfx_printLine(uint8_t cur, uint8_t tot, uint16_t startY, uint16_t endY,
                       uint16_t startX, fontSize_t size, textAlign_t alignment,
                       color_t color, const char* fmt, ... );
 
+/**
+ * Prints text on the screen, calculating the print position like
+ * gfx_printLine() does. Reads text from a given char buffer.
+ * @param cur: current line number over total (1-based)
+ * @param tot: number of lines to fit in screen
+ * @param startY: starting Y coordinate to leave space at the top, use 0 to leave no space
+ * @param endY: ending Y coordinate to leave space at the bottom, use 0 to leave no space
+ * @param startX: starting X coordinate to leave space on the screen sides
+ * @param size: text font size, defined as enum.
+ * @param alignment: text alignment type, defined as enum.
+ * @param color: text color, in color_t format.
+ * @param buf: char buffer
+ * @return text width and height as point_t coordinates
+ */
+point_t gfx_printLineBuffer(uint8_t cur, uint8_t tot, uint16_t startY,
+                            uint16_t endY, uint16_t startX, fontSize_t size,
+                            textAlign_t alignment, color_t color,
+                            const char *buf);
+
 /**
  * Prints an error message surrounded by a red box on the screen.
  * @param text: text to print.
@@ -312,6 +363,24 @@ void gfx_drawBattery(point_t start, uint16_t width, uint16_t height, uint8_t per
  */
 void gfx_drawSmeter(point_t start, uint16_t width, uint16_t height, float rssi, float squelch, color_t color);
 
+/**
+ * Function to draw a band scope bar graph of arbitrary size, one bar for each
+ * point. Only the bars of a given range of points are drawn, to allow
+ * updating the graph incrementally as new points are acquired.
+ * Starting coordinates are relative to the top left point.
+ * @param start: bar graph start point, in pixel coordinates.
+ * @param width: bar graph width
+ * @param height: bar graph height
+ * @param data: array of RSSI levels in dBm, one for each point
+ * @param points: total number of points of the graph
+ * @param first: index of the first point to be drawn
+ * @param count: number of points to be drawn, wrapping around at the end
+ * @param color: color of the bars
+ */
+void gfx_drawBandScope(point_t start, uint16_t width, uint16_t height,
+                       const int8_t *data, uint16_t points, uint16_t first,
+                       uint16_t count, color_t color);
+
 /**
  * Function to draw GPS SNR bar graph of arbitrary size.
  * Starting coordinates are relative to the top left point.
@@ -119,6 +119,17 @@ void radio_disableRtx();
  */
 void radio_updateConfiguration();
 
+/**
+ * Update the RX frequency of the radio module to match the one currently set
+ * in the rtxStatus_t configuration data structure, without reloading all the
+ * other operating parameters. This provides a fast retune path for functions
+ * hopping between frequencies, like dual watch or band scope, and falls back to
+ * a full configuration update if the new frequency lies in a different band.
+ * If the RX stage is not active, the new frequency is applied the next time
+ * radio_enableRx() is called.
+ */
+void radio_updateRxFrequency();
+
 /**
  * Get the current RSSI level in dBm.
  *
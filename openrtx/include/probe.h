@@ -0,0 +1,137 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Named latency probes for hot paths.
+ *
+ * A probe measures the time elapsed between PROBE_BEGIN and PROBE_END, which
+ * can be placed in different functions or threads, and aggregates the results
+ * in minimum, maximum, mean and a log2 histogram. Time is measured in ticks of
+ * the DWT cycle counter on Cortex-M targets and in nanoseconds of the monotonic
+ * clock on linux; durations longer than a full wrap of the 32-bit tick counter
+ * are not supported.
+ *
+ * Probes are statically allocated through PROBE_DEFINE and added to a global
+ * registry the first time they complete a measurement. Only one measurement
+ * per probe can be in progress: a new PROBE_BEGIN restarts it.
+ */
+
+#define PROBE_HIST_BINS 32         /**< Bin i counts durations in [2^i, 2^(i+1)) ticks */
+
+/**
+ * Data of a single probe.
+ */
+typedef struct probe_s
+{
+    const char      *name;                   /**< Probe name              */
+    uint32_t         count;                  /**< Completed measurements  */
+    uint32_t         min;                    /**< Minimum duration, ticks */
+    uint32_t         max;                    /**< Maximum duration, ticks */
+    uint64_t         sum;                    /**< Sum of durations, ticks */
+    uint32_t         hist[PROBE_HIST_BINS];  /**< Log2 histogram          */
+    uint32_t         start;                  /**< Start of the measurement in progress */
+    bool             running;                /**< Measurement in progress */
+    uint8_t          registered;             /**< Probe is in the registry */
+    struct probe_s  *next;                   /**< Next probe in the registry */
+}
+probe_t;
+
+/**
+ * Define a probe. Can be preceded by "static" to limit its scope to a file.
+ */
+#define PROBE_DEFINE(name)  probe_t probe_##name = {#name, 0, 0, 0, 0, {0}, 0, \
+                                                    false, 0, 0}
+
+/**
+ * Declare a probe defined in another file.
+ */
+#define PROBE_DECLARE(name) extern probe_t probe_##name
+
+#define PROBE_BEGIN(name)   probe_begin(&probe_##name)
+#define PROBE_END(name)     probe_end(&probe_##name)
+
+/**
+ * Start a new measurement.
+ *
+ * @param probe: pointer to the probe.
+ */
+void probe_begin(probe_t *probe);
+
+/**
+ * Complete the measurement in progress and update the statistics of the probe.
+ * Does nothing if no measurement was started.
+ *
+ * @param probe: pointer to the probe.
+ */
+void probe_end(probe_t *probe);
+
+/**
+ * Clear the statistics of a probe, leaving it in the registry.
+ *
+ * @param probe: pointer to the probe.
+ */
+void probe_reset(probe_t *probe);
+
+/**
+ * Get the first probe in the registry.
+ *
+ * @return pointer to the first probe or NULL if the registry is empty. The
+ * other probes are reached through the "next" field.
+ */
+const probe_t *probe_getFirst();
+
+/**
+ * Convert a duration from ticks to nanoseconds.
+ *
+ * @param ticks: duration in ticks.
+ * @return duration in nanoseconds.
+ */
+uint64_t probe_toNs(uint64_t ticks);
+
+/**
+ * Print the statistics of all the registered probes.
+ */
+void probe_dump();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROBE_H */
@@ -0,0 +1,144 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Per-thread CPU and stack profiler.
+ *
+ * Each thread registers itself and brackets its work with prof_begin() and
+ * prof_end(). Run time is accumulated with the DWT cycle counter on Cortex-M
+ * targets, while on linux it is read from the thread CPU clock. Stack usage is
+ * sampled by each thread on its own through memory_profiling.h, since miosix
+ * provides stack information only for the calling thread.
+ */
+
+/*
+ * Define PROF_DUMP_PERIOD, in seconds, to periodically print the profiling data
+ * of all the threads.
+ */
+
+#define PROF_MAX_THREADS   6
+#define PROF_STACK_PERIOD  100     /**< Minimum stack sampling period, in ms  */
+
+/**
+ * Profiling data of a thread.
+ */
+typedef struct
+{
+    const char *name;              /**< Thread name                           */
+    uint32_t    stackSize;         /**< Stack size, in bytes                  */
+    uint32_t    stackUsed;         /**< Maximum stack usage, in bytes         */
+    uint32_t    cpuTime;           /**< Run time, in us, wraps around         */
+    uint8_t     cpuLoad;           /**< CPU load in last update period, in %  */
+}
+profThread_t;
+
+/**
+ * Heap usage.
+ */
+typedef struct
+{
+    uint32_t size;                 /**< Heap size, in bytes                   */
+    uint32_t used;                 /**< Current heap usage, in bytes          */
+    uint32_t maxUsed;              /**< Maximum heap usage, in bytes          */
+}
+profHeap_t;
+
+/**
+ * Register the calling thread in the profiler.
+ *
+ * @param name: thread name, must be a string literal.
+ * @return thread ID for the profiler or -1 if no more threads can be registered.
+ */
+int8_t prof_registerThread(const char *name);
+
+/**
+ * Mark the beginning of a work unit of the calling thread.
+ *
+ * @param id: thread ID.
+ */
+void prof_begin(int8_t id);
+
+/**
+ * Mark the end of a work unit of the calling thread, updating its run time and,
+ * at most every PROF_STACK_PERIOD milliseconds, its stack usage.
+ *
+ * @param id: thread ID.
+ */
+void prof_end(int8_t id);
+
+/**
+ * Update the CPU load of all the registered threads, computed over the time
+ * elapsed since the previous call. To be called periodically.
+ */
+void prof_update();
+
+/**
+ * Get the number of registered threads.
+ *
+ * @return number of registered threads.
+ */
+uint8_t prof_getThreadCount();
+
+/**
+ * Get the profiling data of a thread.
+ *
+ * @param id: thread ID.
+ * @param info: pointer where to store the data.
+ * @return false if the ID is not valid.
+ */
+bool prof_getThreadInfo(int8_t id, profThread_t *info);
+
+/**
+ * Get the heap usage.
+ *
+ * @return heap usage.
+ */
+profHeap_t prof_getHeapInfo();
+
+/**
+ * Print the profiling data of all the threads and the heap usage.
+ */
+void prof_dump();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILER_H */
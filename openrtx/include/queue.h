@@ -36,39 +36,138 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 
-// Ring buffer size (MAX = 255)
-#define MSG_QTY 10
+/*
+ * Multi-producer, single-consumer lock-free message queue.
+ *
+ * Messages are stored in two ring buffers, or lanes: messages posted to the
+ * high priority lane are always delivered before the ones in the normal lane.
+ * In addition, up to 32 coalesced message slots are available: a coalesced
+ * message is stored in the slot selected by its key and only the most recent
+ * message for each key is kept pending. Coalesced messages are delivered after
+ * both lanes are empty, and can never overflow. The consumer takes a message
+ * out of its slot with an atomic exchange, so that each message is delivered
+ * at most once.
+ *
+ * Producers never block. The consumer sleeps only when all the lanes and slots
+ * are empty, waiting on a single sequence counter incremented on each post.
+ */
+
+// Capacity of each lane, must be a power of two
+#ifndef QUEUE_SIZE
+#define QUEUE_SIZE 16
+#endif
+
+#if (QUEUE_SIZE & (QUEUE_SIZE - 1)) != 0
+#error "QUEUE_SIZE must be a power of two"
+#endif
+
+#define QUEUE_MAX_KEYS 32
+
+// Marks an empty coalesced slot, cannot be posted as a coalesced message
+#define QUEUE_NO_MSG   0xFFFFFFFF
+
+/**
+ * Single ring buffer slot, the sequence number tells whether the slot is ready
+ * to be written or read in the current lap of the ring.
+ */
+typedef struct
+{
+    atomic_uint          seq;     /**< Slot sequence number                   */
+    uint32_t             msg;     /**< Message stored in the slot             */
+}
+queueCell_t;
+
+/**
+ * Bounded ring buffer, written by any thread and read by the consumer only.
+ */
+typedef struct
+{
+    atomic_uint          head;    /**< Next position to be written            */
+    uint32_t             tail;    /**< Next position to be read               */
+    queueCell_t          cells[QUEUE_SIZE];
+}
+queueLane_t;
 
 typedef struct queue_t
 {
-    pthread_mutex_t mutex;
-    pthread_cond_t not_empty;
-    uint8_t read_pos;
-    uint8_t write_pos;
-    uint8_t msg_num;
-    uint32_t buffer[MSG_QTY];
+    queueLane_t      high;                       /**< High priority lane      */
+    queueLane_t      normal;                     /**< Normal priority lane    */
+    atomic_uint      pending;                    /**< Pending coalesced keys  */
+    atomic_uint      slots[QUEUE_MAX_KEYS];      /**< Coalesced messages      */
+    atomic_uint      overflows;                  /**< Messages dropped        */
+    atomic_uint      seq;                        /**< Incremented on post     */
+    atomic_uint      waiters;                    /**< Consumer sleeping       */
+#ifndef __linux__
+    pthread_mutex_t  mutex;
+    pthread_cond_t   not_empty;
+#endif
 }
 queue_t;
 
 /**
+ * Initialise a message queue.
  *
+ * @param q: pointer to the queue.
  */
 void queue_init(queue_t *q);
 
 /**
+ * Release the resources of a message queue.
  *
+ * @param q: pointer to the queue.
  */
 void queue_terminate(queue_t *q);
 
 /**
+ * Retrieve the next message from a queue, picking it from the high priority
+ * lane first, then from the normal lane and finally from the coalesced slots.
+ * This function must be called by a single consumer thread.
  *
+ * @param q: pointer to the queue.
+ * @param msg: pointer where to store the message.
+ * @param blocking: if true, wait until a message is available.
+ * @return true if a message has been retrieved.
  */
 bool queue_pend(queue_t *q, uint32_t *msg, bool blocking);
 
 /**
+ * Post a message in the normal priority lane of a queue.
  *
+ * @param q: pointer to the queue.
+ * @param msg: message to be posted.
+ * @return false if the lane is full and the message has been dropped.
  */
 bool queue_post(queue_t *q, uint32_t msg);
 
+/**
+ * Post a message in the high priority lane of a queue.
+ *
+ * @param q: pointer to the queue.
+ * @param msg: message to be posted.
+ * @return false if the lane is full and the message has been dropped.
+ */
+bool queue_postPriority(queue_t *q, uint32_t msg);
+
+/**
+ * Post a coalesced message: if a message with the same key is still pending,
+ * it is replaced by the new one.
+ *
+ * @param q: pointer to the queue.
+ * @param msg: message to be posted.
+ * @param key: coalescing key, from 0 to QUEUE_MAX_KEYS - 1.
+ * @return false if the key is not valid or the message is QUEUE_NO_MSG.
+ */
+bool queue_postCoalesced(queue_t *q, uint32_t msg, uint8_t key);
+
+/**
+ * Get the number of messages dropped since queue initialisation because of a
+ * full lane.
+ *
+ * @param q: pointer to the queue.
+ * @return number of dropped messages.
+ */
+uint32_t queue_getOverflows(queue_t *q);
+
 #endif
@@ -38,12 +38,20 @@
  * The class is then specialised for each operating mode and its implementation
  * groups all the common code required to manage the given mode, like data
  * encoding and decoding, squelch management, ...
+ *
+ * Dispatch to the operating modes is resolved at compile time by the OpModeSet
+ * template, thus member functions are not virtual: each specialisation has to
+ * provide its own version of them and to define a static ID member with its
+ * identifier. This base class implements the empty operating mode, used for
+ * opmode::NONE.
  */
 
 class OpMode
 {
 public:
 
+    static constexpr opmode ID = NONE;  ///< Operating mode identifier.
+
     /**
      * Constructor.
      */
@@ -52,7 +60,7 @@ public:
     /**
      * Destructor.
      */
-    virtual ~OpMode() { }
+    ~OpMode() { }
 
     /**
      * Enable the operating mode.
@@ -60,7 +68,7 @@ public:
      * Application must ensure this function is being called when entering the
      * new operating mode and always before the first call of "update".
      */
-    virtual void enable() { }
+    void enable() { }
 
     /**
      * Disable the operating mode. This function ensures that, after being
@@ -69,7 +77,7 @@ public:
      * Application must ensure this function is being called when exiting the
      * current operating mode.
      */
-    virtual void disable() { }
+    void disable() { }
 
     /**
      * Update the internal FSM.
@@ -81,7 +89,7 @@ public:
      * @param newCfg: flag used inform the internal FSM that a new RTX configuration
      * has been applied.
      */
-    virtual void update(rtxStatus_t *const status, const bool newCfg)
+    void update(rtxStatus_t *const status, const bool newCfg)
     {
         (void) status;
         (void) newCfg;
@@ -92,9 +100,9 @@ public:
      *
      * @return the corresponding flag from the opmode enum.
      */
-    virtual opmode getID()
+    opmode getID()
     {
-        return NONE;
+        return ID;
     }
 };
 
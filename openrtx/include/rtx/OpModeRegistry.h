@@ -0,0 +1,252 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef OPMODE_REGISTRY_H
+#define OPMODE_REGISTRY_H
+
+#include <type_traits>
+#include <cstddef>
+#include <new>
+#include "OpMode.h"
+
+#ifdef OPMODE_FM
+#include "OpMode_FM.h"
+#endif
+
+/**
+ * \internal
+ * Compile-time helpers for the computation of size and alignment of the shared
+ * storage block and for the dispatch of function calls to the active mode.
+ */
+namespace opmode_detail
+{
+
+template < typename... Modes >
+struct Traits
+{
+    static constexpr size_t size  = 0;
+    static constexpr size_t align = 1;
+};
+
+template < typename First, typename... Rest >
+struct Traits< First, Rest... >
+{
+    static constexpr size_t size  = (sizeof(First) > Traits< Rest... >::size)
+                                  ? sizeof(First) : Traits< Rest... >::size;
+    static constexpr size_t align = (alignof(First) > Traits< Rest... >::align)
+                                  ? alignof(First) : Traits< Rest... >::align;
+};
+
+template < typename... Modes >
+struct Dispatcher
+{
+    static constexpr bool contains(const opmode id)
+    {
+        (void) id;
+        return false;
+    }
+
+    template < typename F >
+    static void call(const opmode id, void *storage, F& func)
+    {
+        (void) id;
+        (void) storage;
+        (void) func;
+    }
+};
+
+template < typename First, typename... Rest >
+struct Dispatcher< First, Rest... >
+{
+    static constexpr bool contains(const opmode id)
+    {
+        return (id == First::ID) || Dispatcher< Rest... >::contains(id);
+    }
+
+    template < typename F >
+    static void call(const opmode id, void *storage, F& func)
+    {
+        if(id == First::ID)
+            func(*reinterpret_cast< First * >(storage));
+        else
+            Dispatcher< Rest... >::call(id, storage, func);
+    }
+};
+
+}   /* namespace opmode_detail */
+
+/**
+ * Compile-time set of operating mode handlers. Only one handler at a time is
+ * alive and all of them share the same storage block, sized for the biggest
+ * one. Calls are dispatched to the active handler through a chain of
+ * comparisons generated at compile time, without virtual function tables.
+ * The first mode of the set is the default one, selected at construction and
+ * whenever an unsupported mode is requested.
+ */
+template < typename Default, typename... Modes >
+class OpModeSet
+{
+public:
+
+    /**
+     * Constructor, selects the default operating mode.
+     */
+    OpModeSet() : currId(Default::ID)
+    {
+        new (&storage) Default();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~OpModeSet()
+    {
+        destroy();
+    }
+
+    /**
+     * Check if a given operating mode is part of the set.
+     *
+     * @param id: operating mode identifier.
+     * @return true if the operating mode is supported.
+     */
+    static constexpr bool isSupported(const opmode id)
+    {
+        return opmode_detail::Dispatcher< Default, Modes... >::contains(id);
+    }
+
+    /**
+     * Replace the current handler with the one for a given operating mode.
+     * The previous handler is destroyed without being disabled: caller has
+     * to call disable() before, if required. If the requested operating mode
+     * is not supported, the default one is selected.
+     *
+     * @param id: identifier of the new operating mode.
+     */
+    void select(const opmode id)
+    {
+        destroy();
+        currId = isSupported(id) ? id : Default::ID;
+
+        auto construct = [](auto& mode)
+        {
+            using T = typename std::remove_reference< decltype(mode) >::type;
+            new (&mode) T();
+        };
+
+        dispatch(construct);
+    }
+
+    /**
+     * Get the identifier of the currently active operating mode.
+     *
+     * @return the corresponding flag from the opmode enum.
+     */
+    opmode getID()
+    {
+        return currId;
+    }
+
+    /**
+     * Enable the currently active operating mode.
+     */
+    void enable()
+    {
+        auto func = [](auto& mode) { mode.enable(); };
+        dispatch(func);
+    }
+
+    /**
+     * Disable the currently active operating mode.
+     */
+    void disable()
+    {
+        auto func = [](auto& mode) { mode.disable(); };
+        dispatch(func);
+    }
+
+    /**
+     * Update the internal FSM of the currently active operating mode.
+     *
+     * @param status: pointer to the rtxStatus_t structure containing the current
+     * RTX status.
+     * @param newCfg: flag used inform the internal FSM that a new RTX
+     * configuration has been applied.
+     */
+    void update(rtxStatus_t *const status, const bool newCfg)
+    {
+        auto func = [status, newCfg](auto& mode) { mode.update(status, newCfg); };
+        dispatch(func);
+    }
+
+private:
+
+    using Traits     = opmode_detail::Traits< Default, Modes... >;
+    using Dispatcher = opmode_detail::Dispatcher< Default, Modes... >;
+
+    /**
+     * Call a function on the currently active handler.
+     */
+    template < typename F >
+    void dispatch(F& func)
+    {
+        Dispatcher::call(currId, &storage, func);
+    }
+
+    /**
+     * Destroy the currently active handler.
+     */
+    void destroy()
+    {
+        auto func = [](auto& mode)
+        {
+            using T = typename std::remove_reference< decltype(mode) >::type;
+            mode.~T();
+        };
+
+        dispatch(func);
+    }
+
+    typename std::aligned_storage< Traits::size, Traits::align >::type storage;
+    opmode currId;
+};
+
+/**
+ * Set of operating modes available on the current target. Each mode is enabled
+ * by the corresponding OPMODE_* define, set in meson together with the mode
+ * source files.
+ */
+using OpModeRegistry = OpModeSet< OpMode
+#ifdef OPMODE_FM
+                                , OpMode_FM
+#endif
+                                >;
+
+#endif /* OPMODE_REGISTRY_H */
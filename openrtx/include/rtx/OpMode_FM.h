@@ -42,6 +42,8 @@ class OpMode_FM : public OpMode
 {
 public:
 
+    static constexpr opmode ID = FM;    ///< Operating mode identifier.
+
     /**
      * Constructor.
      */
@@ -58,7 +60,7 @@ public:
      * Application must ensure this function is being called when entering the
      * new operating mode and always before the first call of "update".
      */
-    virtual void enable() override;
+    void enable();
 
     /**
      * Disable the operating mode. This function ensures that, after being
@@ -67,7 +69,7 @@ public:
      * Application must ensure this function is being called when exiting the
      * current operating mode.
      */
-    virtual void disable() override;
+    void disable();
 
     /**
      * Update the internal FSM.
@@ -79,23 +81,25 @@ public:
      * @param newCfg: flag used inform the internal FSM that a new RTX configuration
      * has been applied.
      */
-    virtual void update(rtxStatus_t *const status, const bool newCfg) override;
+    void update(rtxStatus_t *const status, const bool newCfg);
 
     /**
      * Get the mode identifier corresponding to the OpMode class.
      *
      * @return the corresponding flag from the opmode enum.
      */
-    virtual opmode getID() override
+    opmode getID()
     {
-        return FM;
+        return ID;
     }
 
 private:
 
-    bool rfSqlOpen; ///< Flag for RF squelch status (analog squelch).
-    bool sqlOpen;   ///< Flag for squelch status.
-    bool enterRx;   ///< Flag for RX management.
+    bool rfSqlOpen;         ///< Flag for RF squelch status (analog squelch).
+    bool sqlOpen;           ///< Flag for squelch status.
+    bool enterRx;           ///< Flag for RX management.
+    uint8_t sqlLevel;       ///< Squelch level of the current threshold.
+    int32_t sqlThreshold;   ///< RF squelch threshold, fixed-point dBm.
 };
 
 #endif /* OPMODE_FM_H */
@@ -0,0 +1,175 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef RSSI_H
+#define RSSI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * RSSI acquisition service.
+ *
+ * RSSI is sampled by the rtx task at a rate chosen by the active operating
+ * mode and filtered by a fixed-point low-pass IIR filter. Raw samples are
+ * kept in a short history ring, used to provide minimum, average and maximum
+ * values over the last RSSI_HISTORY_LEN samples.
+ * Values are expressed in dBm as signed fixed-point numbers with
+ * RSSI_FRAC_BITS fractional bits.
+ *
+ * Sampling and configuration functions must be called only from the rtx task,
+ * while the getter functions can be safely called from any thread without
+ * locking.
+ */
+
+/**
+ * Number of fractional bits of the fixed-point RSSI values.
+ */
+#define RSSI_FRAC_BITS 8
+
+/**
+ * Length of the RSSI history ring, in samples.
+ */
+#define RSSI_HISTORY_LEN 64
+
+/**
+ * Convert an integer dBm value to fixed-point RSSI format.
+ */
+#define RSSI_FROM_DBM(x) ((int32_t)(x) * (1 << RSSI_FRAC_BITS))
+
+/**
+ * \enum rssiRate Enumeration type defining the available RSSI sampling rates.
+ */
+enum rssiRate
+{
+    RSSI_RATE_NORMAL = 0,   /**< 33.3Hz, same rate of the rtx update     */
+    RSSI_RATE_FAST   = 1    /**< 200Hz, for fast squelch response        */
+};
+
+/**
+ * Data structure containing the RSSI statistics computed over the history
+ * ring.
+ */
+typedef struct
+{
+    int32_t  min;           /**< Minimum RSSI value                      */
+    int32_t  avg;           /**< Average RSSI value                      */
+    int32_t  max;           /**< Maximum RSSI value                      */
+    uint8_t  length;        /**< Number of samples in the history        */
+    uint32_t count;         /**< Total number of samples acquired        */
+}
+rssiStats_t;
+
+/**
+ * Initialise the RSSI acquisition service.
+ */
+void rssi_init();
+
+/**
+ * Enable or disable RSSI acquisition. When enabled again after being disabled,
+ * the filter is re-initialised with the first new sample and history is
+ * cleared. RSSI has to be acquired only when the radio is receiving.
+ *
+ * @param enable: true to enable RSSI acquisition.
+ */
+void rssi_enable(const bool enable);
+
+/**
+ * Discard the current RSSI value and history, restarting the acquisition after
+ * a given hold-off time. To be called whenever the RX parameters of the radio
+ * change.
+ *
+ * @param holdoff: time to wait before acquiring the next sample, in ms.
+ */
+void rssi_reset(const uint16_t holdoff);
+
+/**
+ * Set the RSSI sampling rate. The time constant of the low-pass filter does
+ * not depend on the sampling rate.
+ *
+ * @param rate: new sampling rate.
+ */
+void rssi_setRate(const enum rssiRate rate);
+
+/**
+ * Get the current RSSI sampling period.
+ *
+ * @return sampling period, in ms.
+ */
+uint16_t rssi_getPeriod();
+
+/**
+ * Acquire a new RSSI sample and update filter, history and statistics, if
+ * acquisition is enabled. Rtx task has to call this function every
+ * rssi_getPeriod() milliseconds.
+ */
+void rssi_sample();
+
+/**
+ * Get the current filtered RSSI value.
+ *
+ * @return RSSI in dBm, fixed-point.
+ */
+int32_t rssi_getValue();
+
+/**
+ * Get the total number of RSSI samples acquired since initialisation. Allows
+ * to detect when a new value is available.
+ *
+ * @return number of samples acquired.
+ */
+uint32_t rssi_getCount();
+
+/**
+ * Get the minimum, average and maximum RSSI values over the history ring.
+ *
+ * @return RSSI statistics.
+ */
+rssiStats_t rssi_getStats();
+
+/**
+ * Copy the most recent raw RSSI samples, from the oldest to the newest one.
+ *
+ * @param buf: destination buffer.
+ * @param len: maximum number of samples to copy.
+ * @return number of samples copied.
+ */
+size_t rssi_getHistory(int32_t *buf, const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RSSI_H */
@@ -64,6 +64,49 @@ typedef struct
 }
 rtxStatus_t;
 
+/**
+ * Data structure containing the statistics of the dual watch function.
+ */
+typedef struct
+{
+    uint32_t switches;      /**< Number of switches between the two channels */
+    uint32_t activity[2];   /**< Number of squelch openings on each channel  */
+    uint32_t missed;        /**< Activity already in progress at switch-in   */
+    float    switchRate;    /**< Average channel switching rate, in Hz       */
+    uint8_t  activeLeg;     /**< Monitored channel, 0: main, 1: secondary    */
+    bool     locked;        /**< Locked on active channel, switching halted  */
+}
+dualWatchStats_t;
+
+/**
+ * Maximum number of points of a band scope sweep.
+ */
+#define BSCOPE_MAX_POINTS 160
+
+/**
+ * Data structure containing the configuration of a band scope sweep.
+ */
+typedef struct
+{
+    freq_t   startFreq;     /**< Frequency of the first point, in Hz         */
+    freq_t   step;          /**< Frequency step between points, in Hz        */
+    uint16_t points;        /**< Number of points, up to BSCOPE_MAX_POINTS   */
+    uint8_t  dwellTime;     /**< Time spent on each point, in ms             */
+}
+bandScopeCfg_t;
+
+/**
+ * Data structure containing the status of the band scope.
+ */
+typedef struct
+{
+    uint32_t count;         /**< Number of points acquired since start       */
+    uint32_t sweeps;        /**< Number of completed sweeps                  */
+    float    pointsPerSec;  /**< Average acquisition rate, in points/s       */
+    bool     active;        /**< Band scope running                          */
+}
+bandScopeStats_t;
+
 /**
  * \enum bandwidth Enumeration type defining the current rtx bandwidth.
  */
@@ -117,6 +160,64 @@ void rtx_terminate();
  */
 void rtx_configure(const rtxStatus_t *cfg);
 
+/**
+ * Enable or disable the dual watch function. When active, the RTX stage
+ * alternates reception between the main channel, set through rtx_configure(),
+ * and a secondary one, staying on each of them for the given dwell time.
+ * Only the RX frequency, squelch level and RX tone of the secondary channel
+ * are used. When squelch opens on one of the two channels switching is halted
+ * until the channel becomes quiet again. Transmission always takes place on
+ * the main channel.
+ * Data structure \b must be protected by the same mutex whose pointer has been
+ * passed as a parameter to rtx_init().
+ *
+ * @param cfg: pointer to the configuration of the secondary channel, NULL to
+ * disable the dual watch.
+ * @param dwellTime: time spent on each channel when idle, in milliseconds.
+ */
+void rtx_setDualWatch(const rtxStatus_t *cfg, uint16_t dwellTime);
+
+/**
+ * Obtain the statistics of the dual watch function, accumulated since it was
+ * last enabled.
+ * @return copy of the dual watch statistics.
+ */
+dualWatchStats_t rtx_getDualWatchStats();
+
+/**
+ * Start a band scope sweep. Normal operation of the RTX stage is suspended and
+ * the radio repeatedly sweeps the given frequency range, storing the RSSI
+ * level of each point in an internal buffer. Dwell time has to be long enough
+ * to let the RSSI reading of the radio settle after each retune.
+ * Sweep is stopped either by calling rtx_stopBandScope() or by a new RTX
+ * configuration.
+ *
+ * @param cfg: pointer to the sweep configuration, its content is copied.
+ */
+void rtx_startBandScope(const bandScopeCfg_t *cfg);
+
+/**
+ * Stop the band scope sweep and resume normal operation of the RTX stage.
+ */
+void rtx_stopBandScope();
+
+/**
+ * Get a pointer to the band scope buffer, containing the RSSI level in dBm of
+ * each point of the sweep. Point i of the buffer is updated when the count
+ * field of the band scope status reaches a value equal to i + 1 modulo the
+ * number of points. Buffer is preallocated and never moves.
+ *
+ * @return pointer to the band scope buffer.
+ */
+const int8_t *rtx_getBandScopeData();
+
+/**
+ * Get the status of the band scope.
+ *
+ * @return copy of the band scope status.
+ */
+bandScopeStats_t rtx_getBandScopeStats();
+
 /**
  * Obtain a copy of the RTX driver's internal status data structure.
  * @return copy of the RTX driver's internal status data structure.
@@ -129,6 +230,20 @@ rtxStatus_t rtx_getCurrentStatus();
  */
 void rtx_taskFunc();
 
+/**
+ * Acquire a new RSSI sample. High-level code is in charge of calling this
+ * function every rtx_getRssiPeriod() milliseconds, from the same thread
+ * calling rtx_taskFunc().
+ */
+void rtx_sampleRssi();
+
+/**
+ * Get the RSSI sampling period requested by the current operating mode. It
+ * may change after each call of rtx_taskFunc().
+ * @return RSSI sampling period in ms.
+ */
+uint16_t rtx_getRssiPeriod();
+
 /**
  * Get current RSSI in dBm.
  * @return RSSI value in dBm.
@@ -33,6 +33,7 @@
 
 #include <datatypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <interfaces/rtc.h>
 #include <cps.h>
 #include <settings.h>
@@ -108,6 +109,20 @@ typedef struct
 }
 state_t;
 
+/**
+ * Sections of the radio state, each one having its own version counter which
+ * is incremented every time the section is modified. Fields not belonging to
+ * any section (time, RSSI and current screen) are small and always copied.
+ */
+enum StateSection
+{
+    STATE_RADIO = 0,      // Channel, zone, squelch and RTX status
+    STATE_POWER,          // Battery voltage and charge
+    STATE_GPS,            // GPS data
+    STATE_SETTINGS,       // Radio settings
+    STATE_NUM_SECTIONS
+};
+
 enum TunerMode
 {
     VFO = 0,
@@ -137,6 +152,36 @@ void state_init();
  */
 void state_terminate();
 
+/**
+ * Signal that a section of the radio state has been modified, incrementing its
+ * version counter. To be called with the state mutex locked, after having
+ * modified the corresponding fields.
+ *
+ * @param section: modified section, from enum StateSection.
+ */
+void state_publish(uint8_t section);
+
+/**
+ * Update the GPS section of the radio state. The GPS data is published with a
+ * sequence lock, thus this function does not need the state mutex and never
+ * blocks the readers.
+ *
+ * @param gps: new GPS data.
+ */
+void state_publishGps(const gps_t *gps);
+
+/**
+ * Update a copy of the radio state, copying only the sections whose version
+ * changed with respect to the ones saved in the versions array, which is then
+ * updated. To be called with the state mutex locked.
+ *
+ * @param dst: pointer to the state copy to be updated.
+ * @param versions: versions of the sections held by the state copy, must have
+ * STATE_NUM_SECTIONS elements.
+ * @return number of bytes copied.
+ */
+size_t state_snapshot(state_t *dst, uint32_t *versions);
+
 /**
  * The RTC and state.time are set to UTC time
  * Use this function to get local time from UTC time based on timezone setting
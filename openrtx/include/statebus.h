@@ -0,0 +1,143 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef STATEBUS_H
+#define STATEBUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+
+/**
+ * Publish/subscribe bus for radio state changes.
+ *
+ * Producers notify changes of the radio state fields through topics, either
+ * unconditionally or by passing the new field value: in the latter case the
+ * change is published only when the value moved by at least the threshold set
+ * for the topic since the last time it was published.
+ * Subscribers register a bitmask of topics and a queue: the topics changed are
+ * accumulated in a per-subscriber dirty mask, and a coalesced EVENT_STATUS is
+ * posted to the queue only when the dirty mask goes from empty to non-empty.
+ */
+
+#define STATEBUS_MAX_SUBSCRIBERS 4
+
+/**
+ * Topics of the state bus, one for each group of fields drawn together.
+ */
+enum stateTopic
+{
+    TOPIC_TIME = 0,         // Current time, in seconds
+    TOPIC_BATTERY,          // Battery voltage, in mV
+    TOPIC_RSSI,             // RSSI, in tenths of dBm
+    TOPIC_GPS,              // GPS data
+    TOPIC_BANDSCOPE,        // New band scope points
+    TOPIC_NUM
+};
+
+#define TOPIC_MASK(t) (1u << (t))
+
+/**
+ * Data structure holding the state bus counters.
+ */
+typedef struct
+{
+    uint32_t updates;       /**< Number of values passed to statebus_update() */
+    uint32_t filtered;      /**< Updates discarded by the threshold           */
+    uint32_t published;     /**< Number of topic changes published            */
+    uint32_t wakeups;       /**< Number of events posted to subscribers       */
+}
+statebusStats_t;
+
+/**
+ * Initialise the state bus, removing all the subscribers and setting the
+ * default thresholds.
+ */
+void statebus_init();
+
+/**
+ * Register a new subscriber.
+ *
+ * @param topics: bitmask of the topics of interest.
+ * @param queue: queue where to post the change notifications.
+ * @return subscriber ID or -1 if the maximum number of subscribers is reached.
+ */
+int8_t statebus_subscribe(uint32_t topics, queue_t *queue);
+
+/**
+ * Change the topics of interest of a subscriber.
+ *
+ * @param id: subscriber ID.
+ * @param topics: new bitmask of the topics of interest.
+ */
+void statebus_setTopics(int8_t id, uint32_t topics);
+
+/**
+ * Retrieve and clear the topics changed since the last call.
+ *
+ * @param id: subscriber ID.
+ * @return bitmask of the changed topics.
+ */
+uint32_t statebus_collect(int8_t id);
+
+/**
+ * Set the minimum change of a value for it to be published.
+ *
+ * @param topic: topic, from enum stateTopic.
+ * @param threshold: minimum absolute difference from the last published value.
+ */
+void statebus_setThreshold(uint8_t topic, int32_t threshold);
+
+/**
+ * Update the value of a topic, publishing it if it differs from the last
+ * published one by at least the topic threshold. Each topic must be updated by
+ * a single producer.
+ *
+ * @param topic: topic, from enum stateTopic.
+ * @param value: new value.
+ * @return true if the change has been published.
+ */
+bool statebus_update(uint8_t topic, int32_t value);
+
+/**
+ * Unconditionally publish a change of a topic.
+ *
+ * @param topic: topic, from enum stateTopic.
+ */
+void statebus_publish(uint8_t topic);
+
+/**
+ * Get the state bus counters.
+ *
+ * @return counters since the bus initialisation.
+ */
+statebusStats_t statebus_getStats();
+
+#endif /* STATEBUS_H */
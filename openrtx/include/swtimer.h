@@ -0,0 +1,138 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Software timer service.
+ *
+ * Periodic and one-shot callbacks are kept in a hashed timer wheel, each slot
+ * holding a list of timers sorted by deadline, and are run in deadline order
+ * by a single service thread. The service thread sleeps until the nearest
+ * deadline, either through the miosix kernel or through clock_nanosleep() on
+ * linux. Timers started from outside the service thread are picked up within
+ * SWTIMER_MAX_SLEEP milliseconds.
+ *
+ * Callbacks run in the service thread context, thus they must not block.
+ */
+
+#define SWTIMER_WHEEL_SLOTS 32     /**< Number of wheel slots, power of two   */
+#define SWTIMER_SLOT_US     4000   /**< Time span of a wheel slot, in us      */
+#define SWTIMER_MAX_SLEEP   50     /**< Maximum service sleep time, in ms     */
+
+typedef void (*swtimerCallback_t)(void *arg);
+
+/**
+ * Timing statistics of a software timer.
+ */
+typedef struct
+{
+    uint32_t count;                /**< Number of callback executions         */
+    uint32_t missed;               /**< Periods skipped due to overruns       */
+    uint32_t maxJitter;            /**< Maximum lateness, in us               */
+    uint32_t avgJitter;            /**< Average lateness, in us               */
+}
+swtimerStats_t;
+
+/**
+ * Software timer, to be allocated by the caller, zero-initialised before its
+ * first start and kept valid while active.
+ */
+typedef struct swtimer
+{
+    struct swtimer   *next;        /**< Next timer in the wheel slot          */
+    long long         deadline;    /**< Next expiration time, in us           */
+    uint32_t          period;      /**< Period in us, zero for one-shot       */
+    swtimerCallback_t callback;    /**< Function called on expiration         */
+    void             *arg;         /**< Callback argument                     */
+    bool              active;      /**< Timer is in the wheel                 */
+    uint32_t          count;       /**< Number of callback executions         */
+    uint32_t          missed;      /**< Periods skipped due to overruns       */
+    uint32_t          maxJitter;   /**< Maximum lateness, in us               */
+    uint64_t          sumJitter;   /**< Sum of lateness values, in us         */
+}
+swtimer_t;
+
+/**
+ * Initialise the software timer service. Timers can be started before the
+ * service thread is running.
+ */
+void swtimer_init();
+
+/**
+ * Service thread function, never returns. To be run by a dedicated thread.
+ *
+ * @param arg: unused.
+ * @return never returns.
+ */
+void *swtimer_task(void *arg);
+
+/**
+ * Start a software timer. If the timer is already active, it is restarted
+ * with the new parameters and its statistics are reset.
+ *
+ * @param timer: pointer to the timer.
+ * @param delay: delay of first expiration from now, in milliseconds.
+ * @param period: period of the subsequent expirations in milliseconds, zero for
+ * one-shot timers.
+ * @param callback: function called on expiration.
+ * @param arg: argument passed to the callback.
+ */
+void swtimer_start(swtimer_t *timer, uint32_t delay, uint32_t period,
+                   swtimerCallback_t callback, void *arg);
+
+/**
+ * Stop a software timer. Can be called also from the timer callback.
+ *
+ * @param timer: pointer to the timer.
+ */
+void swtimer_stop(swtimer_t *timer);
+
+/**
+ * Get the timing statistics of a software timer.
+ *
+ * @param timer: pointer to the timer.
+ * @return timer statistics.
+ */
+swtimerStats_t swtimer_getStats(const swtimer_t *timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWTIMER_H */
@@ -39,14 +39,15 @@
 void create_threads();
 
 /**
- * Stack size for Keyboard task, in bytes.
+ * Stack size for software timers task, running keyboard scan and state update,
+ * in bytes. When the periodic profiling or trace dumps are enabled the task
+ * also runs their stdio calls, which need a much larger stack.
  */
-#define KBD_TASK_STKSIZE 512
-
-/**
- * Stack size for state update task, in bytes.
- */
-#define DEV_TASK_STKSIZE 512
+#if defined(PROF_DUMP_PERIOD) || defined(ENABLE_TRACE)
+#define TIMER_TASK_STKSIZE 2048
+#else
+#define TIMER_TASK_STKSIZE 768
+#endif
 
 /**
  * Stack size for baseband control task, in bytes.
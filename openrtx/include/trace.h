@@ -0,0 +1,145 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lightweight binary trace recorder.
+ *
+ * Each thread writes timestamped events in its own fixed-size ring, without
+ * locks; events generated from interrupt context go to a dedicated ring. When
+ * rings are full, the oldest events are overwritten. Rings are bound to thread
+ * IDs and never released: a new thread reusing the ID of a terminated one
+ * continues in its ring. Timestamps are CPU cycles
+ * on Cortex-M targets and microseconds on linux.
+ *
+ * On linux the content of the rings is saved, at program exit, as a JSON file
+ * in Chrome trace format, which can be opened with chrome://tracing or with
+ * Perfetto. On the other targets the rings are streamed in raw binary format
+ * over the USB virtual COM port.
+ *
+ * The recorder is enabled by the ENABLE_TRACE define, otherwise all the
+ * macros and functions here compile to nothing.
+ */
+
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE   128      /**< Events per ring, must be a power of 2 */
+#endif
+
+#ifndef TRACE_MAX_RINGS
+#define TRACE_MAX_RINGS   6        /**< Number of rings, including ISR one    */
+#endif
+
+#ifndef TRACE_FILE
+#define TRACE_FILE        "openrtx_trace.json"
+#endif
+
+/**
+ * Trace event types.
+ */
+enum TraceEvent
+{
+    TRACE_EV_BEGIN   = 0,          /**< Beginning of a span                   */
+    TRACE_EV_END     = 1,          /**< End of a span                         */
+    TRACE_EV_COUNTER = 2,          /**< Counter value                         */
+    TRACE_EV_ISR     = 3           /**< Instant mark from interrupt context   */
+};
+
+#ifdef ENABLE_TRACE
+
+/**
+ * Initialise the trace recorder and start recording.
+ */
+void trace_init();
+
+/**
+ * Record an event in the ring of the calling thread. If the thread has no ring
+ * yet, a free one is assigned to it. Events are silently dropped if recording
+ * is disabled or no free ring is available.
+ *
+ * @param type: event type.
+ * @param name: event name, must be a string literal.
+ * @param value: event value, used only by counters.
+ */
+void trace_event(uint8_t type, const char *name, int32_t value);
+
+/**
+ * Record an instant event in the interrupt ring. Safe to be called from any
+ * interrupt priority level.
+ *
+ * @param name: event name, must be a string literal.
+ */
+void trace_isr(const char *name);
+
+/**
+ * Enable or disable the recording of new events.
+ *
+ * @param enable: true to enable recording.
+ */
+void trace_enable(bool enable);
+
+/**
+ * Dump the content of the rings. On linux this writes the Chrome trace JSON
+ * file, on the other targets streams in raw format the events recorded since
+ * the previous call. Recording is paused during the dump.
+ */
+void trace_dump();
+
+#define TRACE_BEGIN(name)          trace_event(TRACE_EV_BEGIN, name, 0)
+#define TRACE_END(name)            trace_event(TRACE_EV_END, name, 0)
+#define TRACE_COUNTER(name, value) trace_event(TRACE_EV_COUNTER, name, value)
+#define TRACE_ISR(name)            trace_isr(name)
+
+#else
+
+static inline void trace_init() { }
+static inline void trace_enable(bool enable) { (void) enable; }
+static inline void trace_dump() { }
+
+#define TRACE_BEGIN(name)          do { } while(0)
+#define TRACE_END(name)            do { } while(0)
+#define TRACE_COUNTER(name, value) do { } while(0)
+#define TRACE_ISR(name)            do { } while(0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
@@ -37,6 +37,7 @@
 #include <stdint.h>
 #include <event.h>
 #include <hwconfig.h>
+#include <ui_layout.h>
 
 // Maximum menu entry length
 #define MAX_ENTRY_LEN 21
@@ -44,6 +45,8 @@
 #define FREQ_DIGITS 8
 // Time & Date digits
 #define TIMEDATE_DIGITS 10
+// Band scope points, bars two pixels wide
+#define SCOPE_POINTS (SCREEN_WIDTH / 2)
 
 enum uiScreen
 {
@@ -58,6 +61,7 @@ enum uiScreen
     MENU_SETTINGS,
     MENU_INFO,
     MENU_ABOUT,
+    MENU_BANDSCOPE,
     SETTINGS_TIMEDATE,
     SETTINGS_TIMEDATE_SET,
     SETTINGS_DISPLAY,
@@ -81,6 +85,7 @@ enum menuItems
 #ifdef HAS_GPS
     M_GPS,
 #endif
+    M_BANDSCOPE,
     M_SETTINGS,
     M_INFO,
     M_ABOUT
@@ -114,38 +119,6 @@ enum settingsGPSItems
 };
 #endif
 
-/**
- * Struct containing a set of positions and sizes that get
- * calculated for the selected display size.
- * Using these parameters make the UI automatically adapt
- * To displays of different sizes
- */
-typedef struct layout_t
-{
-    uint16_t hline_h;
-    uint16_t top_h;
-    uint16_t line1_h;
-    uint16_t line2_h;
-    uint16_t line3_h;
-    uint16_t menu_h;
-    uint16_t bottom_h;
-    uint16_t status_v_pad;
-    uint16_t horizontal_pad;
-    uint16_t text_v_offset;
-    point_t top_pos;
-    point_t line1_pos;
-    point_t line2_pos;
-    point_t line3_pos;
-    point_t bottom_pos;
-    fontSize_t top_font;
-    fontSize_t line1_font;
-    fontSize_t line2_font;
-    fontSize_t line3_font;
-    fontSize_t bottom_font;
-    fontSize_t input_font;
-    fontSize_t menu_font;
-} layout_t;
-
 /**
  * This structs contains state variables internal to the
  * UI that need to be kept between executions of the UI
@@ -154,7 +127,7 @@ typedef struct layout_t
 typedef struct ui_state_t
 {
     // Index of the currently selected menu entry
-    uint8_t menu_selected;
+    uint16_t menu_selected;
     // If true we can change a menu entry value with UP/DOWN
     bool edit_mode;
     // Variables used for VFO input
@@ -173,10 +146,16 @@ typedef struct ui_state_t
 #endif
     // Which state to return to when we exit menu
     uint8_t last_main_state;
+    // Variables used for band scope
+    uint8_t scope_step;
+    uint32_t scope_count;
+    bool scope_redraw;
+    // Variables used for the incremental redraw of the main screens
+    uint8_t drawn_screen;
+    bool main_redraw;
 }
 ui_state_t;
 
-extern layout_t layout;
 // Copy of the radio state
 extern state_t last_state;
 extern const char *menu_items[];
@@ -185,12 +164,14 @@ extern const char *display_items[];
 extern const char *settings_gps_items[];
 extern const char *info_items[];
 extern const char *authors[];
+extern const freq_t scope_steps[];
 extern const uint8_t menu_num;
 extern const uint8_t settings_num;
 extern const uint8_t display_num;
 extern const uint8_t settings_gps_num;
 extern const uint8_t info_num;
 extern const uint8_t author_num;
+extern const uint8_t scope_steps_num;
 extern const color_t color_black;
 extern const color_t color_grey;
 extern const color_t color_white;
@@ -213,9 +194,23 @@ void ui_drawSplashScreen(bool centered);
  * This function updates the local copy of the radio state
  * the local copy is called last_state
  * and is accessible from all the UI code as extern variable.
+ * Only the state sections changed since the last call are copied.
  */
 void ui_saveState();
 
+/**
+ * This function returns the state bus topics shown by the current screen.
+ * @return bitmask of the topics, from enum stateTopic.
+ */
+uint32_t ui_getTopics();
+
+/**
+ * This function returns the refresh period needed by the current screen to
+ * show data not published on the state bus.
+ * @return refresh period in milliseconds, zero if not needed.
+ */
+uint16_t ui_getRefreshPeriod();
+
 /**
  * This function advances the User Interface FSM, basing on the
  * current radio state and the keys pressed.
@@ -230,6 +225,13 @@ void ui_updateFSM(event_t event, bool *sync_rtx);
  */
 void ui_updateGUI();
 
+/**
+ * This function loads the data the next GUI updates are likely to need, such
+ * as the names of the list entries following the visible ones. To be called
+ * after the current frame has been rendered, not to delay it.
+ */
+void ui_prefetch();
+
 /**
  * This function terminates the User Interface.
  */
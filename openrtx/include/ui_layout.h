@@ -0,0 +1,219 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef UI_LAYOUT_H
+#define UI_LAYOUT_H
+
+#include <interfaces/graphics.h>
+#include <hwconfig.h>
+#include <stdint.h>
+
+/**
+ * Struct containing a set of positions and sizes that get
+ * calculated for the selected display size.
+ * Using these parameters make the UI automatically adapt
+ * To displays of different sizes
+ */
+typedef struct layout_t
+{
+    uint16_t hline_h;
+    uint16_t top_h;
+    uint16_t line1_h;
+    uint16_t line2_h;
+    uint16_t line3_h;
+    uint16_t menu_h;
+    uint16_t bottom_h;
+    uint16_t status_v_pad;
+    uint16_t horizontal_pad;
+    uint16_t text_v_offset;
+    point_t top_pos;
+    point_t line1_pos;
+    point_t line2_pos;
+    point_t line3_pos;
+    point_t bottom_pos;
+    fontSize_t top_font;
+    fontSize_t line1_font;
+    fontSize_t line2_font;
+    fontSize_t line3_font;
+    fontSize_t bottom_font;
+    fontSize_t input_font;
+    fontSize_t menu_font;
+} layout_t;
+
+/*
+ * UI layout parameters for each supported display geometry, selected at
+ * compile time depending on vertical resolution. Heights and paddings are
+ * shown in the diagram at the beginning of ui.c.
+ */
+
+// Horizontal line height
+#define LAYOUT_HLINE_H              1
+// Compensate for fonts printing below the start position
+#define LAYOUT_TEXT_V_OFFSET        1
+
+// Tytera MD380, MD-UV380
+#if SCREEN_HEIGHT > 127
+
+#define LAYOUT_TOP_H                16
+#define LAYOUT_TOP_PAD              4
+#define LAYOUT_LINE1_H              20
+#define LAYOUT_LINE2_H              20
+#define LAYOUT_LINE3_H              40
+#define LAYOUT_MENU_H               16
+#define LAYOUT_BOTTOM_H             20
+#define LAYOUT_BOTTOM_PAD           LAYOUT_TOP_PAD
+#define LAYOUT_STATUS_V_PAD         2
+#define LAYOUT_SMALL_LINE_V_PAD     2
+#define LAYOUT_BIG_LINE_V_PAD       6
+#define LAYOUT_HORIZONTAL_PAD       4
+
+// Top bar font: 8 pt
+#define LAYOUT_TOP_FONT             FONT_SIZE_8PT
+// Text line font: 8 pt
+#define LAYOUT_LINE1_FONT           FONT_SIZE_8PT
+#define LAYOUT_LINE2_FONT           FONT_SIZE_8PT
+// Frequency line font: 16 pt
+#define LAYOUT_LINE3_FONT           FONT_SIZE_16PT
+// Bottom bar font: 8 pt
+#define LAYOUT_BOTTOM_FONT          FONT_SIZE_8PT
+// TimeDate/Frequency input font
+#define LAYOUT_INPUT_FONT           FONT_SIZE_12PT
+// Menu font
+#define LAYOUT_MENU_FONT            FONT_SIZE_8PT
+
+// Radioddity GD-77
+#elif SCREEN_HEIGHT > 63
+
+#define LAYOUT_TOP_H                11
+#define LAYOUT_TOP_PAD              1
+#define LAYOUT_LINE1_H              10
+#define LAYOUT_LINE2_H              10
+#define LAYOUT_LINE3_H              16
+#define LAYOUT_MENU_H               10
+#define LAYOUT_BOTTOM_H             8
+#define LAYOUT_BOTTOM_PAD           0
+#define LAYOUT_STATUS_V_PAD         1
+#define LAYOUT_SMALL_LINE_V_PAD     1
+#define LAYOUT_BIG_LINE_V_PAD       0
+#define LAYOUT_HORIZONTAL_PAD       4
+
+// Top bar font: 6 pt
+#define LAYOUT_TOP_FONT             FONT_SIZE_6PT
+// Middle line fonts: 6, 6, 10 pt
+#define LAYOUT_LINE1_FONT           FONT_SIZE_6PT
+#define LAYOUT_LINE2_FONT           FONT_SIZE_6PT
+#define LAYOUT_LINE3_FONT           FONT_SIZE_10PT
+// Bottom bar font: 6 pt
+#define LAYOUT_BOTTOM_FONT          FONT_SIZE_6PT
+// TimeDate/Frequency input font
+#define LAYOUT_INPUT_FONT           FONT_SIZE_8PT
+// Menu font
+#define LAYOUT_MENU_FONT            FONT_SIZE_6PT
+
+// Radioddity RD-5R
+#elif SCREEN_HEIGHT > 47
+
+#define LAYOUT_TOP_H                11
+#define LAYOUT_TOP_PAD              1
+#define LAYOUT_LINE1_H              0
+#define LAYOUT_LINE2_H              10
+#define LAYOUT_LINE3_H              18
+#define LAYOUT_MENU_H               10
+#define LAYOUT_BOTTOM_H             0
+#define LAYOUT_BOTTOM_PAD           0
+#define LAYOUT_STATUS_V_PAD         1
+#define LAYOUT_SMALL_LINE_V_PAD     1
+#define LAYOUT_BIG_LINE_V_PAD       0
+#define LAYOUT_HORIZONTAL_PAD       4
+
+// Top bar font: 6 pt
+#define LAYOUT_TOP_FONT             FONT_SIZE_6PT
+// Middle line fonts: 6, 12 pt
+#define LAYOUT_LINE2_FONT           FONT_SIZE_6PT
+#define LAYOUT_LINE3_FONT           FONT_SIZE_12PT
+// TimeDate/Frequency input font
+#define LAYOUT_INPUT_FONT           FONT_SIZE_8PT
+// Menu font
+#define LAYOUT_MENU_FONT            FONT_SIZE_6PT
+// Not present on this resolution
+#define LAYOUT_LINE1_FONT           0
+#define LAYOUT_BOTTOM_FONT          0
+
+#else
+#error Unsupported vertical resolution!
+#endif
+
+/*
+ * Printing positions, as baselines of the text lines.
+ */
+#define LAYOUT_TOP_POS_Y    (LAYOUT_TOP_H - LAYOUT_STATUS_V_PAD \
+                            - LAYOUT_TEXT_V_OFFSET)
+#define LAYOUT_LINE1_POS_Y  (LAYOUT_TOP_H + LAYOUT_TOP_PAD + LAYOUT_LINE1_H \
+                            - LAYOUT_SMALL_LINE_V_PAD - LAYOUT_TEXT_V_OFFSET)
+#define LAYOUT_LINE2_POS_Y  (LAYOUT_TOP_H + LAYOUT_TOP_PAD + LAYOUT_LINE1_H \
+                            + LAYOUT_LINE2_H - LAYOUT_SMALL_LINE_V_PAD \
+                            - LAYOUT_TEXT_V_OFFSET)
+#define LAYOUT_LINE3_POS_Y  (LAYOUT_TOP_H + LAYOUT_TOP_PAD + LAYOUT_LINE1_H \
+                            + LAYOUT_LINE2_H + LAYOUT_LINE3_H \
+                            - LAYOUT_BIG_LINE_V_PAD - LAYOUT_TEXT_V_OFFSET)
+#define LAYOUT_BOTTOM_POS_Y (SCREEN_HEIGHT - LAYOUT_BOTTOM_PAD \
+                            - LAYOUT_STATUS_V_PAD - LAYOUT_TEXT_V_OFFSET)
+
+/**
+ * UI layout of the target display. Being a constant with a known initialiser,
+ * its fields are folded by the compiler into the drawing calls.
+ */
+static const layout_t layout =
+{
+    .hline_h        = LAYOUT_HLINE_H,
+    .top_h          = LAYOUT_TOP_H,
+    .line1_h        = LAYOUT_LINE1_H,
+    .line2_h        = LAYOUT_LINE2_H,
+    .line3_h        = LAYOUT_LINE3_H,
+    .menu_h         = LAYOUT_MENU_H,
+    .bottom_h       = LAYOUT_BOTTOM_H,
+    .status_v_pad   = LAYOUT_STATUS_V_PAD,
+    .horizontal_pad = LAYOUT_HORIZONTAL_PAD,
+    .text_v_offset  = LAYOUT_TEXT_V_OFFSET,
+    .top_pos        = {LAYOUT_HORIZONTAL_PAD, LAYOUT_TOP_POS_Y},
+    .line1_pos      = {LAYOUT_HORIZONTAL_PAD, LAYOUT_LINE1_POS_Y},
+    .line2_pos      = {LAYOUT_HORIZONTAL_PAD, LAYOUT_LINE2_POS_Y},
+    .line3_pos      = {LAYOUT_HORIZONTAL_PAD, LAYOUT_LINE3_POS_Y},
+    .bottom_pos     = {LAYOUT_HORIZONTAL_PAD, LAYOUT_BOTTOM_POS_Y},
+    .top_font       = LAYOUT_TOP_FONT,
+    .line1_font     = LAYOUT_LINE1_FONT,
+    .line2_font     = LAYOUT_LINE2_FONT,
+    .line3_font     = LAYOUT_LINE3_FONT,
+    .bottom_font    = LAYOUT_BOTTOM_FONT,
+    .input_font     = LAYOUT_INPUT_FONT,
+    .menu_font      = LAYOUT_MENU_FONT
+};
+
+#endif /* UI_LAYOUT_H */
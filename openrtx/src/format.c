@@ -0,0 +1,198 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stdbool.h>
+#include <format.h>
+
+static const uint32_t powers[] =
+{
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/**
+ * \internal Append a character to the output buffer, leaving room for the
+ * terminator.
+ */
+static inline void putChar(char *buf, size_t len, size_t *pos, char c)
+{
+    if((*pos + 1) < len) buf[(*pos)++] = c;
+}
+
+/**
+ * \internal Terminate the output buffer.
+ *
+ * @return number of characters written.
+ */
+static inline size_t terminate(char *buf, size_t len, size_t pos)
+{
+    if(len > 0) buf[pos] = '\0';
+    return pos;
+}
+
+/**
+ * \internal Append an unsigned integer to the output buffer, preceded by an
+ * optional sign character, padded on the left up to the given width. Zero
+ * padding goes between the sign and the digits, like printf does.
+ */
+static void putNumber(char *buf, size_t len, size_t *pos, uint32_t value,
+                      uint8_t width, char pad, char sign)
+{
+    char    digits[10];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = '0' + (value % 10);
+        value /= 10;
+    }
+    while(value > 0);
+
+    uint8_t total = count + ((sign != '\0') ? 1 : 0);
+    uint8_t fill  = (width > total) ? (width - total) : 0;
+
+    if((sign != '\0') && (pad == '0')) putChar(buf, len, pos, sign);
+    for(uint8_t i = 0; i < fill; i++)  putChar(buf, len, pos, pad);
+    if((sign != '\0') && (pad != '0')) putChar(buf, len, pos, sign);
+    while(count > 0) putChar(buf, len, pos, digits[--count]);
+}
+
+/**
+ * \internal Format three two-digit fields separated by the given character,
+ * as used by time and date.
+ *
+ * @return number of characters written.
+ */
+static size_t putFields(char *buf, size_t len, uint8_t a, uint8_t b, uint8_t c,
+                        char sep)
+{
+    size_t pos = 0;
+    putNumber(buf, len, &pos, a, 2, '0', '\0');
+    putChar(buf, len, &pos, sep);
+    putNumber(buf, len, &pos, b, 2, '0', '\0');
+    putChar(buf, len, &pos, sep);
+    putNumber(buf, len, &pos, c, 2, '0', '\0');
+    return terminate(buf, len, pos);
+}
+
+size_t fmt_string(char *buf, size_t len, const char *str, size_t maxLen)
+{
+    size_t pos = 0;
+    for(size_t i = 0; (i < maxLen) && (str[i] != '\0'); i++)
+        putChar(buf, len, &pos, str[i]);
+
+    return terminate(buf, len, pos);
+}
+
+size_t fmt_unsigned(char *buf, size_t len, uint32_t value, uint8_t width,
+                    char pad)
+{
+    size_t pos = 0;
+    putNumber(buf, len, &pos, value, width, pad, '\0');
+    return terminate(buf, len, pos);
+}
+
+size_t fmt_integer(char *buf, size_t len, int32_t value, uint8_t width,
+                   char pad)
+{
+    size_t   pos = 0;
+    uint32_t mag = (value < 0) ? (0U - (uint32_t) value) : (uint32_t) value;
+    putNumber(buf, len, &pos, mag, width, pad, (value < 0) ? '-' : '\0');
+    return terminate(buf, len, pos);
+}
+
+size_t fmt_decimal(char *buf, size_t len, int32_t value, uint8_t scale,
+                   uint8_t decimals)
+{
+    if(scale > 9)        scale    = 9;
+    if(decimals > scale) decimals = scale;
+
+    size_t   pos = 0;
+    uint32_t mag = (value < 0) ? (0U - (uint32_t) value) : (uint32_t) value;
+
+    // Drop the extra digits, rounding half away from zero
+    uint32_t divisor = powers[scale - decimals];
+    if(divisor > 1)
+    {
+        uint32_t rem = mag % divisor;
+        mag /= divisor;
+        if(rem >= (divisor / 2)) mag += 1;
+    }
+
+    if((value < 0) && (mag > 0)) putChar(buf, len, &pos, '-');
+    putNumber(buf, len, &pos, mag / powers[decimals], 0, ' ', '\0');
+    if(decimals > 0)
+    {
+        putChar(buf, len, &pos, '.');
+        putNumber(buf, len, &pos, mag % powers[decimals], decimals, '0', '\0');
+    }
+
+    return terminate(buf, len, pos);
+}
+
+size_t fmt_frequency(char *buf, size_t len, freq_t freq)
+{
+    size_t pos = 0;
+    putNumber(buf, len, &pos, freq / 1000000, 3, '0', '\0');
+    putChar(buf, len, &pos, '.');
+    putNumber(buf, len, &pos, (freq % 1000000) / 10, 5, '0', '\0');
+    return terminate(buf, len, pos);
+}
+
+size_t fmt_time(char *buf, size_t len, curTime_t time)
+{
+    return putFields(buf, len, time.hour, time.minute, time.second, ':');
+}
+
+size_t fmt_date(char *buf, size_t len, curTime_t time)
+{
+    return putFields(buf, len, time.date, time.month, time.year, '/');
+}
+
+size_t fmt_callsign(char *buf, size_t len, const char *callsign)
+{
+    size_t pos = 0;
+
+    while(*callsign == ' ') callsign++;
+
+    for(uint8_t i = 0; (i < FMT_CALLSIGN_LEN) && (callsign[i] != '\0'); i++)
+    {
+        char c = callsign[i];
+        if((c >= 'a') && (c <= 'z')) c -= 'a' - 'A';
+
+        bool valid = ((c >= 'A') && (c <= 'Z')) ||
+                     ((c >= '0') && (c <= '9')) ||
+                     (c == '/') || (c == '-');
+        if(!valid) break;
+
+        putChar(buf, len, &pos, c);
+    }
+
+    return terminate(buf, len, pos);
+}
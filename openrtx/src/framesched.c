@@ -0,0 +1,201 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <framesched.h>
+#include <swtimer.h>
+#include <event.h>
+#include <stdatomic.h>
+
+typedef struct
+{
+    uint16_t  period;       // Refresh period in ms, zero if not active
+    long long next;         // Next refresh time
+}
+periodic_t;
+
+static queue_t          *frameQueue;
+static swtimer_t         frameTimer;
+static atomic_llong      timerDeadline;     // Frame timer expiration, -1 if idle
+static uint32_t          framePeriod;       // Minimum time between frames, ms
+static long long         lastFrame;         // Time of the last frame
+static bool              redrawPending;     // Redraw requested, not yet rendered
+static bool              deferred;          // Pending frame already counted as deferred
+static periodic_t        periodic[FRAMESCHED_MAX_PERIODIC];
+static frameschedStats_t stats;
+
+/**
+ * \internal Timer callback posting the frame event to the UI queue.
+ */
+static void frameTick(void *arg)
+{
+    (void) arg;
+
+    // Timer is idle from now on, also if the system tick has not yet reached
+    // the deadline it was armed for
+    atomic_store(&timerDeadline, -1);
+
+    event_t event;
+    event.type    = EVENT_FRAME;
+    event.payload = 0;
+    (void) queue_postCoalesced(frameQueue, event.value, EVENT_FRAME);
+}
+
+/**
+ * \internal Arm the frame timer, unless it already expires earlier.
+ *
+ * @param wake: expiration time.
+ * @param now: current time.
+ */
+static void armTimer(long long wake, long long now)
+{
+    long long deadline = atomic_load(&timerDeadline);
+    if((deadline > now) && (deadline <= wake)) return;
+
+    atomic_store(&timerDeadline, wake);
+    swtimer_start(&frameTimer, (uint32_t)(wake - now), 0, frameTick, NULL);
+}
+
+void framesched_init(queue_t *queue, uint16_t maxFps)
+{
+    frameQueue    = queue;
+    atomic_store(&timerDeadline, -1);
+    lastFrame     = 0;
+    redrawPending = false;
+    deferred      = false;
+
+    for(uint8_t i = 0; i < FRAMESCHED_MAX_PERIODIC; i++)
+        periodic[i].period = 0;
+
+    stats.events   = 0;
+    stats.redraws  = 0;
+    stats.frames   = 0;
+    stats.deferred = 0;
+    stats.periodic = 0;
+
+    framesched_setMaxFps(maxFps);
+}
+
+void framesched_setMaxFps(uint16_t maxFps)
+{
+    framePeriod = (maxFps == 0) ? 0 : ((1000 + maxFps - 1) / maxFps);
+}
+
+void framesched_setPeriodic(uint8_t id, uint16_t period)
+{
+    if(id >= FRAMESCHED_MAX_PERIODIC) return;
+    if(periodic[id].period == period) return;
+
+    long long now = getTick();
+    periodic[id].period = period;
+    periodic[id].next   = now + period;
+    if(period != 0) armTimer(periodic[id].next, now);
+}
+
+void framesched_event(bool redraw)
+{
+    stats.events += 1;
+    if(redraw)
+    {
+        stats.redraws += 1;
+        redrawPending  = true;
+    }
+}
+
+bool framesched_frameDue()
+{
+    long long now  = getTick();
+    long long wake = -1;
+    bool      due  = redrawPending;
+
+    for(uint8_t i = 0; i < FRAMESCHED_MAX_PERIODIC; i++)
+    {
+        if(periodic[i].period == 0) continue;
+
+        if(now >= periodic[i].next)
+            due = true;
+        else if((wake < 0) || (periodic[i].next < wake))
+            wake = periodic[i].next;
+    }
+
+    if(due)
+    {
+        long long slot = lastFrame + framePeriod;
+        if(now >= slot) return true;
+
+        if(!deferred)
+        {
+            stats.deferred += 1;
+            deferred        = true;
+        }
+
+        wake = slot;
+    }
+
+    if(wake >= 0) armTimer(wake, now);
+
+    return false;
+}
+
+void framesched_frameDone()
+{
+    long long now = getTick();
+
+    if(!redrawPending) stats.periodic += 1;
+    stats.frames += 1;
+
+    lastFrame     = now;
+    redrawPending = false;
+    deferred      = false;
+
+    // Move the expired periodic refreshes to their next period and wait for
+    // the nearest one
+    long long wake = -1;
+    for(uint8_t i = 0; i < FRAMESCHED_MAX_PERIODIC; i++)
+    {
+        if(periodic[i].period == 0) continue;
+
+        if(now >= periodic[i].next)
+        {
+            periodic[i].next += periodic[i].period;
+            if(periodic[i].next <= now)
+                periodic[i].next = now + periodic[i].period;
+        }
+
+        if((wake < 0) || (periodic[i].next < wake)) wake = periodic[i].next;
+    }
+
+    if(wake >= 0) armTimer(wake, now);
+}
+
+frameschedStats_t framesched_getStats()
+{
+    return stats;
+}
@@ -40,13 +40,14 @@
 /**
  * This function parses a GPS NMEA sentence and updates radio state
  */
-void gps_taskFunc(char *line, __attribute__((unused)) int len, state_t *state)
+void gps_taskFunc(char *line, __attribute__((unused)) int len, gps_t *gps_data,
+                  bool set_time)
 {
     char nmea_id[3] = { 0 };
 
     // Little mechanism to ensure that RTC is synced with GPS time only once.
     static bool isRtcSyncronised = false;
-    if(!state->settings.gps_set_time)
+    if(!set_time)
     {
         isRtcSyncronised = false;
     }
@@ -65,27 +66,26 @@ void gps_taskFunc(char *line, __attribute__((unused)) int len, state_t *state)
             struct minmea_sentence_rmc frame;
             if (minmea_parse_rmc(&frame, line))
             {
-                state->gps_data.latitude = minmea_tocoord(&frame.latitude);
-                state->gps_data.longitude = minmea_tocoord(&frame.longitude);
-                state->gps_data.timestamp.hour = frame.time.hours;
-                state->gps_data.timestamp.minute = frame.time.minutes;
-                state->gps_data.timestamp.second = frame.time.seconds;
-                state->gps_data.timestamp.day = 0;
-                state->gps_data.timestamp.date = frame.date.day;
-                state->gps_data.timestamp.month = frame.date.month;
-                state->gps_data.timestamp.year = frame.date.year;
+                gps_data->latitude = minmea_tocoord(&frame.latitude);
+                gps_data->longitude = minmea_tocoord(&frame.longitude);
+                gps_data->timestamp.hour = frame.time.hours;
+                gps_data->timestamp.minute = frame.time.minutes;
+                gps_data->timestamp.second = frame.time.seconds;
+                gps_data->timestamp.day = 0;
+                gps_data->timestamp.date = frame.date.day;
+                gps_data->timestamp.month = frame.date.month;
+                gps_data->timestamp.year = frame.date.year;
             }
 
             // Synchronize RTC with GPS UTC clock, only when fix is done
-            if((state->settings.gps_set_time) &&
-               (state->gps_data.fix_quality > 0) && (!isRtcSyncronised))
+            if(set_time && (gps_data->fix_quality > 0) && (!isRtcSyncronised))
             {
-                rtc_setTime(state->gps_data.timestamp);
+                rtc_setTime(gps_data->timestamp);
                 isRtcSyncronised = true;
             }
 
-            state->gps_data.tmg_true = minmea_tofloat(&frame.course);
-            state->gps_data.speed = minmea_tofloat(&frame.speed) * KNOTS2KMH;
+            gps_data->tmg_true = minmea_tofloat(&frame.course);
+            gps_data->speed = minmea_tofloat(&frame.speed) * KNOTS2KMH;
         } break;
 
         case MINMEA_SENTENCE_GGA:
@@ -93,24 +93,24 @@ void gps_taskFunc(char *line, __attribute__((unused)) int len, state_t *state)
             struct minmea_sentence_gga frame;
             if (minmea_parse_gga(&frame, line))
             {
-                state->gps_data.fix_quality = frame.fix_quality;
-                state->gps_data.satellites_tracked = frame.satellites_tracked;
-                state->gps_data.altitude = minmea_tofloat(&frame.altitude);
+                gps_data->fix_quality = frame.fix_quality;
+                gps_data->satellites_tracked = frame.satellites_tracked;
+                gps_data->altitude = minmea_tofloat(&frame.altitude);
             }
         } break;
 
         case MINMEA_SENTENCE_GSA:
         {
-            state->gps_data.active_sats = 0;
+            gps_data->active_sats = 0;
             struct minmea_sentence_gsa frame;
             if (minmea_parse_gsa(&frame, line))
             {
-                state->gps_data.fix_type = frame.fix_type;
+                gps_data->fix_type = frame.fix_type;
                 for (int i = 0; i < 12; i++)
                 {
                     if (frame.sats[i] != 0)
                     {
-                        state->gps_data.active_sats |= 1 << (frame.sats[i] - 1);
+                        gps_data->active_sats |= 1 << (frame.sats[i] - 1);
                     }
                 }
             }
@@ -125,17 +125,17 @@ void gps_taskFunc(char *line, __attribute__((unused)) int len, state_t *state)
                 // When the first sentence arrives, clear all the old data
                 if (frame.msg_nr == 1)
                 {
-                    bzero(&state->gps_data.satellites[0], 12 * sizeof(sat_t));
+                    bzero(&gps_data->satellites[0], 12 * sizeof(sat_t));
                 }
 
-                state->gps_data.satellites_in_view = frame.total_sats;
+                gps_data->satellites_in_view = frame.total_sats;
                 for (int i = 0; i < 4; i++)
                 {
                     int index = 4 * (frame.msg_nr - 1) + i;
-                    state->gps_data.satellites[index].id = frame.sats[i].nr;
-                    state->gps_data.satellites[index].elevation = frame.sats[i].elevation;
-                    state->gps_data.satellites[index].azimuth = frame.sats[i].azimuth;
-                    state->gps_data.satellites[index].snr = frame.sats[i].snr;
+                    gps_data->satellites[index].id = frame.sats[i].nr;
+                    gps_data->satellites[index].elevation = frame.sats[i].elevation;
+                    gps_data->satellites[index].azimuth = frame.sats[i].azimuth;
+                    gps_data->satellites[index].snr = frame.sats[i].snr;
                 }
             }
         } break;
@@ -145,9 +145,9 @@ void gps_taskFunc(char *line, __attribute__((unused)) int len, state_t *state)
             struct minmea_sentence_vtg frame;
             if (minmea_parse_vtg(&frame, line))
             {
-                state->gps_data.speed = minmea_tofloat(&frame.speed_kph);
-                state->gps_data.tmg_mag = minmea_tofloat(&frame.magnetic_track_degrees);
-                state->gps_data.tmg_true = minmea_tofloat(&frame.true_track_degrees);
+                gps_data->speed = minmea_tofloat(&frame.speed_kph);
+                gps_data->tmg_mag = minmea_tofloat(&frame.magnetic_track_degrees);
+                gps_data->tmg_true = minmea_tofloat(&frame.true_track_degrees);
             }
         } break;
 
@@ -40,6 +40,8 @@
 #include <stdarg.h>
 #include <interfaces/display.h>
 #include <interfaces/graphics.h>
+#include <format.h>
+#include <trace.h>
 
 // Variable swap macro
 #define SWAP(x, y) do { typeof(x) t = x; x = y; y = t; } while(0)
@@ -47,38 +49,54 @@
 #define SIN(x) sinf((x) * DEG_RAD)
 #define COS(x) cosf((x) * DEG_RAD)
 
+// Division by 255 as (x + 1 + (x >> 8)) >> 8, exact for x < 65535
+#define DIV255(x) (((x) + 1 + ((x) >> 8)) >> 8)
+
+/*
+ * Pixel format specializations. Each pixel format provides:
+ * - PIXEL_T: the framebuffer element type;
+ * - ROW_HEIGHT: number of pixel rows stored in a contiguous framebuffer row;
+ * - ROW_BYTES and FB_SIZE: size of a framebuffer row and of the framebuffer;
+ * - TO_PIXEL(color): conversion of a color to the native pixel value.
+ * The per-format set, fill and blend operations are in the span layer below.
+ */
+
 #ifdef PIX_FMT_RGB565
-/* This specialization is meant for an RGB565 little endian pixel format.
- * Thus, to accomodate for the endianness, the fields in struct rgb565_t have to
- * be written in reversed order.
- *
- * For more details about endianness and bitfield structs see the following web
- * page: http://mjfrazer.org/mjfrazer/bitfields/
+/* This specialization is meant for an RGB565 pixel format: each pixel is a 16
+ * bit word holding the red component in the five most significant bits, then
+ * the green one in the next six bits and the blue one in the five least
+ * significant bits.
+ * Pixels are stored in display byte order, that is big endian, so that display
+ * drivers can send the framebuffer content as it is.
  */
 
-typedef struct
-{
-    uint16_t b : 5;
-    uint16_t g : 6;
-    uint16_t r : 5;
-} rgb565_t;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define TO_DISPLAY_ORDER(px) __builtin_bswap16(px)
+#else
+#define TO_DISPLAY_ORDER(px) (px)
+#endif
 
-rgb565_t _true2highColor(color_t true_color)
+static inline uint16_t _true2highColor(color_t true_color)
 {
-    rgb565_t high_color;
-    high_color.r = true_color.r >> 3;
-    high_color.g = true_color.g >> 2;
-    high_color.b = true_color.b >> 3;
+    uint16_t pixel = ((true_color.r >> 3) << 11)
+                   | ((true_color.g >> 2) << 5)
+                   |  (true_color.b >> 3);
 
-    return high_color;
+    return TO_DISPLAY_ORDER(pixel);
 }
 
-#define PIXEL_T rgb565_t
+#define PIXEL_T uint16_t
+#define ROW_HEIGHT 1
+#define ROW_BYTES (SCREEN_WIDTH * sizeof(uint16_t))
+#define FB_SIZE (SCREEN_HEIGHT * ROW_BYTES)
+#define TO_PIXEL(color) _true2highColor(color)
 #elif defined PIX_FMT_BW
 /**
  * This specialization is meant for black and white pixel format.
- * It is suitable for monochromatic displays with 1 bit per pixel,
- * it will have RGB and grayscale counterparts
+ * It is suitable for monochromatic displays with 1 bit per pixel and uses the
+ * native memory layout of the UC1701 and ST7567 controllers: the screen is
+ * divided in pages of eight pixel rows, each page is stored as one byte per
+ * column and the least significant bit of each byte is the topmost pixel.
  */
 
 typedef enum
@@ -98,48 +116,684 @@ bw_t _color2bw(color_t true_color)
 }
 
 #define PIXEL_T uint8_t
+#define ROW_HEIGHT 8
+#define ROW_BYTES (SCREEN_WIDTH)
+#define FB_SIZE ((SCREEN_HEIGHT / 8) * ROW_BYTES)
+#define TO_PIXEL(color) _color2bw(color)
+#elif defined PIX_FMT_GRAYSC
+/**
+ * This specialization is meant for an 8 bit grayscale pixel format, each byte
+ * holding the luminance of one pixel.
+ */
+
+static inline uint8_t _color2gray(color_t true_color)
+{
+    // ITU-R BT.601 luma, weights scaled by 256
+    return ((true_color.r * 77) + (true_color.g * 150) + (true_color.b * 29)) >> 8;
+}
+
+#define PIXEL_T uint8_t
+#define ROW_HEIGHT 1
+#define ROW_BYTES (SCREEN_WIDTH)
+#define FB_SIZE (SCREEN_HEIGHT * ROW_BYTES)
+#define TO_PIXEL(color) _color2gray(color)
 #else
 #error Please define a pixel format type into hwconfig.h or meson.build
 #endif
 
 bool initialized = 0;
-PIXEL_T *buf;
+PIXEL_T *buf;               // Back buffer, written by the drawing functions
+static PIXEL_T *front;      // Display framebuffer, read by the display driver
 uint16_t fbSize;
-char text[32];
 
-void gfx_init()
+/*
+ * Dirty region tracking. Drawing primitives extend the bounding box of the
+ * content drawn since the last clear, which is also the only area a clear can
+ * modify. Areas modified since the last render are kept in a short list of
+ * rectangles, so that distant updates (e.g. a clock on the top bar and a meter
+ * on the bottom one) are sent to the display separately: each primitive
+ * extends the rectangle it touches or lies close to, a new one is started
+ * otherwise. At render time, only the rows of each modified area whose content
+ * actually changed are sent to the display; changes are detected comparing a
+ * hash of each framebuffer row with the one computed at the previous render.
+ */
+typedef struct
 {
-    display_init();
-    buf = (PIXEL_T *)(display_getFrameBuffer());
-    initialized = 1;
+    uint16_t x0;
+    uint16_t y0;
+    uint16_t x1;    // Last column, included
+    uint16_t y1;    // Last row, included
+}
+area_t;
+
+#define AREA_EMPTY  ((area_t) {UINT16_MAX, UINT16_MAX, 0, 0})
+#define AREA_FULL   ((area_t) {0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1})
+
+_Static_assert((ROW_BYTES % sizeof(uint32_t)) == 0,
+               "Framebuffer rows must be a multiple of 32 bits");
+_Static_assert((SCREEN_HEIGHT % ROW_HEIGHT) == 0,
+               "Screen height must be a multiple of the framebuffer row height");
+
+#define NUM_ROWS    (SCREEN_HEIGHT / ROW_HEIGHT)
+#define MAX_DAMAGE  4                   // Maximum number of modified areas
+#define DAMAGE_GAP  8                   // Merge areas closer than this, in px
+
+static area_t   damage[MAX_DAMAGE];     // Areas modified since the last render
+static uint8_t  numDamage;
+static area_t   drawn;                  // Area drawn since the last clear
+static uint32_t rowHash[NUM_ROWS];     // Row hashes at the last render
+static bool     fullRefresh;            // Ignore row hashes at next render
+static uint32_t renderedPixels;
+
+static inline void _extendArea(area_t *area, uint16_t x0, uint16_t y0,
+                               uint16_t x1, uint16_t y1)
+{
+    if(x0 < area->x0) area->x0 = x0;
+    if(y0 < area->y0) area->y0 = y0;
+    if(x1 > area->x1) area->x1 = x1;
+    if(y1 > area->y1) area->y1 = y1;
+}
+
+static inline bool _areasNear(const area_t *a, const area_t *b, uint16_t gap)
+{
+    return (a->x0 <= b->x1 + gap) && (b->x0 <= a->x1 + gap) &&
+           (a->y0 <= b->y1 + gap) && (b->y0 <= a->y1 + gap);
+}
+
+static inline uint32_t _areaSize(const area_t *area)
+{
+    return (area->x1 - area->x0 + 1) * (area->y1 - area->y0 + 1);
+}
+
+/**
+ * \internal
+ * Mark an area as modified since the last render, ends included.
+ */
+static void _addDamage(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    if((x0 > x1) || (y0 > y1)) return;
+
+    area_t   area       = {x0, y0, x1, y1};
+    uint8_t  best       = 0;
+    uint32_t bestGrowth = UINT32_MAX;
+    for(uint8_t i = 0; i < numDamage; i++)
+    {
+        if(_areasNear(&damage[i], &area, DAMAGE_GAP))
+        {
+            _extendArea(&damage[i], x0, y0, x1, y1);
+            return;
+        }
 
-// Calculate framebuffer size
+        area_t merged = damage[i];
+        _extendArea(&merged, x0, y0, x1, y1);
+        uint32_t growth = _areaSize(&merged) - _areaSize(&damage[i]);
+        if(growth < bestGrowth)
+        {
+            best       = i;
+            bestGrowth = growth;
+        }
+    }
+
+    // No room for a new area, extend the one growing less
+    if(numDamage < MAX_DAMAGE)
+        damage[numDamage++] = area;
+    else
+        _extendArea(&damage[best], x0, y0, x1, y1);
+}
+
+static inline void _markDrawn(uint16_t x0, uint16_t y0, uint16_t x1,
+                              uint16_t y1)
+{
+    _extendArea(&drawn, x0, y0, x1, y1);
+    _addDamage(x0, y0, x1, y1);
+}
+
+static inline uint32_t _rowHash(uint16_t row)
+{
+    // 32-bit FNV-1a, one word at a time. Multiplication carries differences
+    // only towards the upper bits, rotate to mix them back into the lower ones
+    const uint8_t *data = ((const uint8_t *) buf) + (row * ROW_BYTES);
+    uint32_t       hash = 2166136261u;
+    for(size_t i = 0; i < ROW_BYTES; i += sizeof(uint32_t))
+    {
+        uint32_t word;
+        memcpy(&word, data + i, sizeof(uint32_t));
+        hash = (hash ^ word) * 16777619u;
+        hash = (hash << 13) | (hash >> 19);
+    }
+
+    return hash;
+}
+
+/*
+ * Span layer: all the drawing primitives are built on horizontal runs of pixels
+ * having the same color. Clipping and dirty region tracking are done once per
+ * shape, while color conversion is done by the callers, once per primitive.
+ * Each pixel format provides, on already clipped coordinates:
+ * - _setPixel(x, y, pixel, alpha): write a single pixel, blending if alpha < 255;
+ * - _fillSpan(x0, x1, y, pixel, alpha): fill pixels from x0 to x1 included;
+ * - _fillBlock(x0, x1, y0, y1, pixel, alpha): fill a rectangle, ends included.
+ */
 #ifdef PIX_FMT_RGB565
-    fbSize = SCREEN_HEIGHT * SCREEN_WIDTH * sizeof(PIXEL_T);
+
+static inline void _setPixel(uint16_t x, uint16_t y, PIXEL_T pixel,
+                             uint8_t alpha)
+{
+    PIXEL_T *px = &buf[x + y * SCREEN_WIDTH];
+
+    // Blend old pixel value and new one
+    if(alpha < 255)
+    {
+        uint16_t bg  = TO_DISPLAY_ORDER(*px);
+        uint16_t fg  = TO_DISPLAY_ORDER(pixel);
+        uint16_t inv = 255 - alpha;
+        uint16_t r   = (inv * (bg >> 11)) + (alpha * (fg >> 11));
+        uint16_t g   = (inv * ((bg >> 5) & 0x3F)) + (alpha * ((fg >> 5) & 0x3F));
+        uint16_t b   = (inv * (bg & 0x1F)) + (alpha * (fg & 0x1F));
+
+        pixel = (DIV255(r) << 11) | (DIV255(g) << 5) | DIV255(b);
+        pixel = TO_DISPLAY_ORDER(pixel);
+    }
+
+    *px = pixel;
+}
+
+static inline void _fillSpan(uint16_t x0, uint16_t x1, uint16_t y,
+                             PIXEL_T pixel, uint8_t alpha)
+{
+    if(alpha < 255)
+    {
+        for(uint16_t x = x0; x <= x1; x++) _setPixel(x, y, pixel, alpha);
+        return;
+    }
+
+    PIXEL_T *px  = &buf[x0 + y * SCREEN_WIDTH];
+    uint16_t len = x1 - x0 + 1;
+
+    // Align to 32 bit, then write two pixels at a time
+    if((((uintptr_t) px) & 0x02) != 0)
+    {
+        *px++ = pixel;
+        len--;
+    }
+
+    uint32_t pair = (((uint32_t) pixel) << 16) | pixel;
+    for(; len >= 2; len -= 2, px += 2) memcpy(px, &pair, sizeof(pair));
+    if(len > 0) *px = pixel;
+}
+
+static inline void _fillBlock(uint16_t x0, uint16_t x1, uint16_t y0,
+                              uint16_t y1, PIXEL_T pixel, uint8_t alpha)
+{
+    for(uint16_t y = y0; y <= y1; y++) _fillSpan(x0, x1, y, pixel, alpha);
+}
+
 #elif defined PIX_FMT_BW
-    fbSize = (SCREEN_HEIGHT * SCREEN_WIDTH) / 8;
-    /* Compensate for eventual truncation error in division */
-    if((fbSize * 8) < (SCREEN_HEIGHT * SCREEN_WIDTH)) fbSize += 1;
-    fbSize *= sizeof(uint8_t);
+
+static inline void _maskedWrite(uint8_t *cell, uint8_t mask, PIXEL_T pixel)
+{
+    if(pixel == BLACK)
+        *cell |= mask;
+    else
+        *cell &= ~mask;
+}
+
+static inline void _setPixel(uint16_t x, uint16_t y, PIXEL_T pixel,
+                             uint8_t alpha)
+{
+    // Ignore more than half transparent pixels
+    if(alpha < 128) return;
+
+    _maskedWrite(&buf[x + (y / 8) * SCREEN_WIDTH], 1 << (y % 8), pixel);
+}
+
+static inline void _fillBlock(uint16_t x0, uint16_t x1, uint16_t y0,
+                              uint16_t y1, PIXEL_T pixel, uint8_t alpha)
+{
+    if(alpha < 128) return;
+
+    for(uint16_t page = y0 / 8; page <= y1 / 8; page++)
+    {
+        // Rows of the current page covered by the block
+        uint8_t mask = 0xFF;
+        if(page == (y0 / 8)) mask &= 0xFF << (y0 % 8);
+        if(page == (y1 / 8)) mask &= 0xFF >> (7 - (y1 % 8));
+
+        uint8_t *cell = &buf[x0 + page * SCREEN_WIDTH];
+        if(mask == 0xFF)
+        {
+            memset(cell, (pixel == BLACK) ? 0xFF : 0x00, x1 - x0 + 1);
+            continue;
+        }
+
+        for(uint16_t x = x0; x <= x1; x++) _maskedWrite(cell++, mask, pixel);
+    }
+}
+
+static inline void _fillSpan(uint16_t x0, uint16_t x1, uint16_t y,
+                             PIXEL_T pixel, uint8_t alpha)
+{
+    _fillBlock(x0, x1, y, y, pixel, alpha);
+}
+
+#elif defined PIX_FMT_GRAYSC
+
+static inline void _setPixel(uint16_t x, uint16_t y, PIXEL_T pixel,
+                             uint8_t alpha)
+{
+    PIXEL_T *px = &buf[x + y * SCREEN_WIDTH];
+
+    // Blend old pixel value and new one
+    if(alpha < 255)
+    {
+        uint16_t value = ((255 - alpha) * (*px)) + (alpha * pixel);
+        pixel = DIV255(value);
+    }
+
+    *px = pixel;
+}
+
+static inline void _fillSpan(uint16_t x0, uint16_t x1, uint16_t y,
+                             PIXEL_T pixel, uint8_t alpha)
+{
+    if(alpha < 255)
+    {
+        for(uint16_t x = x0; x <= x1; x++) _setPixel(x, y, pixel, alpha);
+        return;
+    }
+
+    memset(&buf[x0 + y * SCREEN_WIDTH], pixel, x1 - x0 + 1);
+}
+
+static inline void _fillBlock(uint16_t x0, uint16_t x1, uint16_t y0,
+                              uint16_t y1, PIXEL_T pixel, uint8_t alpha)
+{
+    for(uint16_t y = y0; y <= y1; y++) _fillSpan(x0, x1, y, pixel, alpha);
+}
+
+#endif
+
+/*
+ * Glyph cache: the packed bitmap of each glyph is decoded once into a list of
+ * horizontal runs of set pixels, which are then drawn as spans. The runs are
+ * kept in a shared pool, indexed by a direct mapped table keyed by the glyph
+ * descriptor. When the pool is full the whole cache is flushed.
+ */
+#ifndef GLYPH_CACHE_SLOTS
+#define GLYPH_CACHE_SLOTS 128
+#endif
+
+#ifndef GLYPH_CACHE_RUNS
+#define GLYPH_CACHE_RUNS  1024
 #endif
-    // Clear text buffer
-    memset(text, 0x00, 32);
+
+typedef struct
+{
+    uint8_t y;      /**< Row of the run, relative to the glyph top          */
+    uint8_t x;      /**< First pixel of the run, relative to the glyph left */
+    uint8_t len;    /**< Length of the run in pixels                        */
+}
+glyphRun_t;
+
+typedef struct
+{
+    const GFXglyph *glyph;  /**< Glyph descriptor, NULL if slot is empty */
+    uint16_t first;         /**< Index of the first run in the pool      */
+    uint16_t count;         /**< Number of runs                          */
+}
+glyphSlot_t;
+
+static glyphSlot_t glyphSlots[GLYPH_CACHE_SLOTS];
+static glyphRun_t  glyphRuns[GLYPH_CACHE_RUNS];
+static uint16_t    glyphPoolHead = 0;
+
+/**
+ * \internal
+ * Read 32 bits from a packed bitmap, starting from an arbitrary bit position.
+ * Bytes past the end of the bitmap are read as zero.
+ */
+static inline uint32_t _readBits(const uint8_t *bitmap, uint32_t pos,
+                                 uint32_t end)
+{
+    uint32_t byte = pos / 8;
+    uint32_t word = 0;
+
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        word <<= 8;
+        if((byte + i) < end) word |= bitmap[byte + i];
+    }
+
+    return word << (pos % 8);
+}
+
+/**
+ * \internal
+ * Decode the bitmap of a glyph into a list of runs. Runs are found by counting
+ * leading zeros and ones of the bitmap, so the cost grows with the number of
+ * runs and not with the number of pixels.
+ *
+ * @param bitmap: font bitmap.
+ * @param glyph: glyph descriptor.
+ * @param runs: destination buffer.
+ * @param maxRuns: capacity of the destination buffer.
+ * @return number of runs or -1 if the destination buffer is too small.
+ */
+static int _decodeGlyph(const uint8_t *bitmap, const GFXglyph *glyph,
+                        glyphRun_t *runs, uint16_t maxRuns)
+{
+    uint32_t pos   = glyph->bitmapOffset * 8;
+    uint32_t end   = glyph->bitmapOffset
+                   + ((glyph->width * glyph->height) + 7) / 8;
+    int      count = 0;
+
+    for(uint8_t y = 0; y < glyph->height; y++, pos += glyph->width)
+    {
+        uint8_t x = 0;
+        while(x < glyph->width)
+        {
+            // At least 25 valid bits are available in each window
+            uint8_t  avail = glyph->width - x;
+            uint32_t word  = _readBits(bitmap, pos + x, end);
+            if(avail > 25) avail = 25;
+
+            // Skip clear pixels
+            uint8_t zeros = (word == 0) ? 32 : __builtin_clz(word);
+            if(zeros >= avail)
+            {
+                x += avail;
+                continue;
+            }
+
+            x += zeros;
+
+            // Collect set pixels, a run may span more than one window
+            uint8_t start = x;
+            while(x < glyph->width)
+            {
+                avail = glyph->width - x;
+                word  = ~_readBits(bitmap, pos + x, end);
+                if(avail > 25) avail = 25;
+
+                uint8_t ones = (word == 0) ? 32 : __builtin_clz(word);
+                if(ones >= avail)
+                {
+                    x += avail;
+                    continue;
+                }
+
+                x += ones;
+                break;
+            }
+
+            if(count >= maxRuns) return -1;
+            runs[count].y   = y;
+            runs[count].x   = start;
+            runs[count].len = x - start;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * \internal
+ * Get the list of runs of a glyph, decoding it if not already cached.
+ *
+ * @param bitmap: font bitmap.
+ * @param glyph: glyph descriptor.
+ * @param runs: pointer to the first run of the list.
+ * @return number of runs.
+ */
+static uint16_t _getGlyphRuns(const uint8_t *bitmap, const GFXglyph *glyph,
+                              const glyphRun_t **runs)
+{
+    glyphSlot_t *slot = &glyphSlots[((uintptr_t) glyph / sizeof(GFXglyph))
+                                    % GLYPH_CACHE_SLOTS];
+
+    if(slot->glyph != glyph)
+    {
+        int count = _decodeGlyph(bitmap, glyph, &glyphRuns[glyphPoolHead],
+                                 GLYPH_CACHE_RUNS - glyphPoolHead);
+        if(count < 0)
+        {
+            // Pool exhausted, flush the whole cache and retry
+            memset(glyphSlots, 0x00, sizeof(glyphSlots));
+            glyphPoolHead = 0;
+            count = _decodeGlyph(bitmap, glyph, glyphRuns, GLYPH_CACHE_RUNS);
+            if(count < 0) count = 0;
+        }
+
+        slot->glyph    = glyph;
+        slot->first    = glyphPoolHead;
+        slot->count    = count;
+        glyphPoolHead += count;
+    }
+
+    *runs = &glyphRuns[slot->first];
+    return slot->count;
+}
+
+/**
+ * \internal
+ * Fill a rectangle, ends included, clipping it to the screen boundaries.
+ * Coordinates are signed to allow shapes partially out of the screen.
+ */
+static void _fillRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                      PIXEL_T pixel, uint8_t alpha)
+{
+    if(x0 < 0) x0 = 0;
+    if(y0 < 0) y0 = 0;
+    if(x1 >= SCREEN_WIDTH)  x1 = SCREEN_WIDTH - 1;
+    if(y1 >= SCREEN_HEIGHT) y1 = SCREEN_HEIGHT - 1;
+    if((x0 > x1) || (y0 > y1)) return;
+
+    _markDrawn(x0, y0, x1, y1);
+    _fillBlock(x0, x1, y0, y1, pixel, alpha);
+}
+
+/**
+ * \internal
+ * Draw a glyph from its list of runs. The glyph box is clipped once and runs
+ * are clipped one by one only when the glyph is partially out of the screen.
+ */
+static void _blitGlyph(int16_t gx, int16_t gy, uint8_t w, uint8_t h,
+                       const glyphRun_t *runs, uint16_t numRuns,
+                       PIXEL_T pixel, uint8_t alpha)
+{
+    if(numRuns == 0) return;
+
+    int16_t minX = (gx < 0) ? 0 : gx;
+    int16_t minY = (gy < 0) ? 0 : gy;
+    int16_t maxX = gx + w - 1;
+    int16_t maxY = gy + h - 1;
+    bool    clip = (gx < 0) || (gy < 0) || (maxX >= SCREEN_WIDTH)
+                                        || (maxY >= SCREEN_HEIGHT);
+    if(maxX >= SCREEN_WIDTH)  maxX = SCREEN_WIDTH - 1;
+    if(maxY >= SCREEN_HEIGHT) maxY = SCREEN_HEIGHT - 1;
+    if((minX > maxX) || (minY > maxY)) return;
+
+    _markDrawn(minX, minY, maxX, maxY);
+
+    for(uint16_t i = 0; i < numRuns; i++)
+    {
+        int16_t y  = gy + runs[i].y;
+        int16_t x0 = gx + runs[i].x;
+        int16_t x1 = x0 + runs[i].len - 1;
+
+        if(clip)
+        {
+            if((y < minY) || (y > maxY)) continue;
+            if(x0 < minX) x0 = minX;
+            if(x1 > maxX) x1 = maxX;
+            if(x0 > x1) continue;
+        }
+
+        _fillSpan(x0, x1, y, pixel, alpha);
+    }
+}
+
+/**
+ * \internal
+ * Copy a rectangular area from the back buffer to the display framebuffer.
+ *
+ * @param x0: first column.
+ * @param x1: last column, included.
+ * @param row0: first framebuffer row.
+ * @param row1: framebuffer row after the last one to be copied.
+ */
+static void _copyToFront(uint16_t x0, uint16_t x1, uint16_t row0, uint16_t row1)
+{
+    if(buf == front) return;
+
+    const size_t colBytes = ROW_BYTES / SCREEN_WIDTH;
+    const size_t len      = (x1 - x0 + 1) * colBytes;
+    for(uint16_t row = row0; row < row1; row++)
+    {
+        size_t offset = (row * ROW_BYTES) + (x0 * colBytes);
+        memcpy(((uint8_t *) front) + offset, ((uint8_t *) buf) + offset, len);
+    }
+}
+
+void gfx_init()
+{
+    display_init();
+    front = (PIXEL_T *)(display_getFrameBuffer());
+    initialized = 1;
+    fbSize = FB_SIZE;
+
+    /*
+     * Draw on a separate back buffer, so that a new frame can be composed while
+     * the previous one is still being sent to the display. If there is not
+     * enough memory, draw directly on the display framebuffer and wait for the
+     * end of each transfer.
+     */
+    buf = (PIXEL_T *) malloc(fbSize);
+    if(buf == NULL)
+        buf = front;
+    else
+        memcpy(buf, front, fbSize);
+
+    // Display content is unknown, the first render updates the whole screen
+    damage[0]      = AREA_FULL;
+    numDamage      = 1;
+    drawn          = AREA_EMPTY;
+    fullRefresh    = true;
+    renderedPixels = 0;
 }
 
 void gfx_terminate()
 {
+    display_waitRender();
+    if(buf != front) free(buf);
     display_terminate();
     initialized = 0;
 }
 
 void gfx_renderRows(uint8_t startRow, uint8_t endRow)
 {
+    TRACE_BEGIN("gfx_renderRows");
+    display_waitRender();
+    _copyToFront(0, SCREEN_WIDTH - 1, startRow,
+                 (endRow < NUM_ROWS) ? endRow : NUM_ROWS);
     display_renderRows(startRow, endRow);
+    display_frameDone();
+    if(buf == front) display_waitRender();
+    TRACE_END("gfx_renderRows");
 }
 
 void gfx_render()
 {
-    display_render();
+    TRACE_BEGIN("gfx_render");
+
+    // Areas may have grown into each other since they were added, merge them
+    // not to send the same pixels twice
+    bool merged = true;
+    while(merged)
+    {
+        merged = false;
+        for(uint8_t i = 0; i < numDamage; i++)
+        {
+            for(uint8_t j = i + 1; j < numDamage; j++)
+            {
+                if(!_areasNear(&damage[i], &damage[j], 0)) continue;
+
+                _extendArea(&damage[i], damage[j].x0, damage[j].y0,
+                            damage[j].x1, damage[j].y1);
+                damage[j] = damage[--numDamage];
+                merged    = true;
+            }
+        }
+    }
+
+    // Hash each row of the modified areas once: 0 not hashed, 1 unchanged,
+    // 2 changed
+    uint8_t rowState[NUM_ROWS];
+    memset(rowState, 0x00, sizeof(rowState));
+
+    // Send the runs of changed rows of each area, restricted to its columns.
+    // The display framebuffer is updated only once the previous transfer is over
+    bool synced = false;
+    for(uint8_t i = 0; i < numDamage; i++)
+    {
+        const area_t *area     = &damage[i];
+        uint16_t      runStart = 0;
+        bool          inRun    = false;
+        for(uint16_t row = area->y0 / ROW_HEIGHT; row <= (area->y1 / ROW_HEIGHT) + 1; row++)
+        {
+            bool changed = false;
+            if(row <= (area->y1 / ROW_HEIGHT))
+            {
+                if(rowState[row] == 0)
+                {
+                    uint32_t hash = _rowHash(row);
+                    rowState[row] = (fullRefresh || (hash != rowHash[row])) ? 2 : 1;
+                    rowHash[row]  = hash;
+                }
+
+                changed = (rowState[row] == 2);
+            }
+
+            if(changed && !inRun)
+            {
+                runStart = row * ROW_HEIGHT;
+                inRun    = true;
+            }
+            else if(!changed && inRun)
+            {
+                if(!synced)
+                {
+                    display_waitRender();
+                    synced = true;
+                }
+
+                uint16_t y = row * ROW_HEIGHT;
+                _copyToFront(area->x0, area->x1, runStart / ROW_HEIGHT, row);
+                display_renderRect(area->x0, runStart, area->x1 + 1, y);
+                renderedPixels += (area->x1 - area->x0 + 1) * (y - runStart);
+                inRun = false;
+            }
+        }
+    }
+
+    numDamage = 0;
+
+    if(synced)
+    {
+        display_frameDone();
+
+        // Drawing directly on the display framebuffer, wait for the transfer end
+        if(buf == front) display_waitRender();
+    }
+
+    fullRefresh = false;
+    TRACE_END("gfx_render");
+}
+
+uint32_t gfx_getRenderedPixels()
+{
+    return renderedPixels;
 }
 
 bool gfx_renderingInProgress()
@@ -147,14 +801,20 @@ bool gfx_renderingInProgress()
     return display_renderingInProgress();
 }
 
+void gfx_waitRender()
+{
+    display_waitRender();
+}
+
 void gfx_clearRows(uint8_t startRow, uint8_t endRow)
 {
     if(!initialized) return;
     if(endRow < startRow) return;
-    uint16_t start = startRow * SCREEN_WIDTH * sizeof(PIXEL_T);
-    uint16_t height = endRow - startRow * SCREEN_WIDTH * sizeof(PIXEL_T);
+    if(endRow >= SCREEN_HEIGHT) endRow = SCREEN_HEIGHT - 1;
     // Set the specified rows to 0x00 = make the screen black
-    memset(buf + start, 0x00, height);
+    color_t black = {0, 0, 0, 255};
+    _fillBlock(0, SCREEN_WIDTH - 1, startRow, endRow, TO_PIXEL(black), 255);
+    _addDamage(0, startRow, SCREEN_WIDTH - 1, endRow);
 }
 
 void gfx_clearScreen()
@@ -162,19 +822,16 @@ void gfx_clearScreen()
     if(!initialized) return;
     // Set the whole framebuffer to 0x00 = make the screen black
     memset(buf, 0x00, fbSize);
+    // Only the area drawn since the previous clear actually changed
+    _addDamage(drawn.x0, drawn.y0, drawn.x1, drawn.y1);
+    drawn = AREA_EMPTY;
 }
 
 void gfx_fillScreen(color_t color)
 {
     if(!initialized) return;
-    for(int y = 0; y < SCREEN_HEIGHT; y++)
-    {
-        for(int x = 0; x < SCREEN_WIDTH; x++)
-        {
-            point_t pos = {x, y};
-            gfx_setPixel(pos, color);
-        }
-    }
+    _fillRect(0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1, TO_PIXEL(color),
+              color.alpha);
 }
 
 inline void gfx_setPixel(point_t pos, color_t color)
@@ -182,32 +839,8 @@ inline void gfx_setPixel(point_t pos, color_t color)
     if (pos.x >= SCREEN_WIDTH || pos.y >= SCREEN_HEIGHT)
         return; // off the screen
 
-#ifdef PIX_FMT_RGB565
-    // Blend old pixel value and new one
-    if (color.alpha < 255)
-    {
-        uint8_t alpha = color.alpha;
-        rgb565_t new_pixel = _true2highColor(color);
-        rgb565_t old_pixel = buf[pos.x + pos.y*SCREEN_WIDTH];
-        rgb565_t pixel = {((255-alpha)*old_pixel.b+alpha*new_pixel.b)/255,
-                          ((255-alpha)*old_pixel.g+alpha*new_pixel.g)/255,
-                          ((255-alpha)*old_pixel.r+alpha*new_pixel.r)/255};
-        buf[pos.x + pos.y*SCREEN_WIDTH] = pixel;
-    }
-    else
-    {
-        buf[pos.x + pos.y*SCREEN_WIDTH] = _true2highColor(color);
-    }
-#elif defined PIX_FMT_BW
-    // Ignore more than half transparent pixels
-    if (color.alpha >= 128)
-    {
-        uint16_t cell = (pos.x + pos.y*SCREEN_WIDTH) / 8;
-        uint16_t elem = (pos.x + pos.y*SCREEN_WIDTH) % 8;
-        buf[cell] &= ~(1 << elem);
-        buf[cell] |= (_color2bw(color) << elem);
-    }
-#endif
+    _markDrawn(pos.x, pos.y, pos.x, pos.y);
+    _setPixel(pos.x, pos.y, TO_PIXEL(color), color.alpha);
 }
 
 void gfx_drawLine(point_t start, point_t end, color_t color)
@@ -261,25 +894,27 @@ void gfx_drawRect(point_t start, uint16_t width, uint16_t height, color_t color,
     if(!initialized) return;
     if(width == 0) return;
     if(height == 0) return;
-    uint16_t x_max = start.x + width - 1;
-    uint16_t y_max = start.y + height - 1;
-    bool perimeter = 0;
+    if(start.x >= SCREEN_WIDTH) return;
+    if(start.y >= SCREEN_HEIGHT) return;
+    int16_t x_max = start.x + width - 1;
+    int16_t y_max = start.y + height - 1;
     if(x_max > (SCREEN_WIDTH - 1)) x_max = SCREEN_WIDTH - 1;
     if(y_max > (SCREEN_HEIGHT - 1)) y_max = SCREEN_HEIGHT - 1;
-    for(int y = start.y; y <= y_max; y++)
+
+    PIXEL_T pixel = TO_PIXEL(color);
+    if(fill)
     {
-        for(int x = start.x; x <= x_max; x++)
-        {
-            if(y == start.y || y == y_max || x == start.x || x == x_max) perimeter = 1;
-            else perimeter = 0;
-            // If fill is false, draw only rectangle perimeter
-            if(fill || perimeter)
-            {
-                point_t pos = {x, y};
-                gfx_setPixel(pos, color);
-            }
-        }
+        _fillRect(start.x, start.y, x_max, y_max, pixel, color.alpha);
+        return;
     }
+
+    // If fill is false, draw only rectangle perimeter
+    _fillRect(start.x, start.y, x_max, start.y, pixel, color.alpha);
+    if(y_max > start.y)
+        _fillRect(start.x, y_max, x_max, y_max, pixel, color.alpha);
+    _fillRect(start.x, start.y + 1, start.x, y_max - 1, pixel, color.alpha);
+    if(x_max > start.x)
+        _fillRect(x_max, start.y + 1, x_max, y_max - 1, pixel, color.alpha);
 }
 
 void gfx_drawCircle(point_t start, uint16_t r, color_t color)
@@ -410,27 +1045,23 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
     size_t len = strlen(buf);
 
     // Compute size of the first row in pixels
+    uint16_t origin_x  = start.x;
     uint16_t line_size = get_line_size(f, buf, len);
-    uint16_t reset_x = get_reset_x(alignment, line_size, start.x);
+    uint16_t text_w    = line_size;
+    uint16_t reset_x   = get_reset_x(alignment, line_size, origin_x);
     start.x = reset_x;
 
     // Save initial start.y value to calculate vertical size
     uint16_t saved_start_y = start.y;
     uint16_t line_h = 0;
+    PIXEL_T pixel = TO_PIXEL(color);
 
     /* For each char in the string */
     for(unsigned i = 0; i < len; i++)
     {
         char c = buf[i];
-        GFXglyph glyph = f.glyph[c - f.first];
-        uint8_t *bitmap = f.bitmap;
-
-        uint16_t bo = glyph.bitmapOffset;
-        uint8_t w = glyph.width, h = glyph.height;
-        int8_t xo = glyph.xOffset,
-               yo = glyph.yOffset;
-        uint8_t xx, yy, bits = 0, bit = 0;
-        line_h = h;
+        const GFXglyph *glyph = &f.glyph[c - f.first];
+        line_h = glyph->height;
 
         // Handle newline and carriage return
         if (c == '\n')
@@ -445,55 +1076,77 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
           continue;
         }
 
-        // Handle wrap around
-        if (start.x + glyph.xAdvance > SCREEN_WIDTH)
+        // Handle wrap around, measuring the new row from the current char
+        if (start.x + glyph->xAdvance > SCREEN_WIDTH)
         {
-            // Compute size of the first row in pixels
-            line_size = get_line_size(f, buf, len);
-            start.x = reset_x = get_reset_x(alignment, line_size, start.x);
+            line_size = get_line_size(f, &buf[i], len - i);
+            start.x = reset_x = get_reset_x(alignment, line_size, origin_x);
             start.y += f.yAdvance;
         }
 
-        // Draw bitmap
-        for (yy = 0; yy < h; yy++)
-        {
-            for (xx = 0; xx < w; xx++)
-            {
-                if (!(bit++ & 7))
-                {
-                    bits = bitmap[bo++];
-                }
+        const glyphRun_t *runs;
+        uint16_t numRuns = _getGlyphRuns(f.bitmap, glyph, &runs);
+        _blitGlyph(start.x + glyph->xOffset, start.y + glyph->yOffset,
+                   glyph->width, glyph->height, runs, numRuns, pixel,
+                   color.alpha);
 
-                if (bits & 0x80)
-                {
-                    if (start.y + yo + yy < SCREEN_HEIGHT &&
-                        start.x + xo + xx < SCREEN_WIDTH &&
-                        start.y + yo + yy > 0 &&
-                        start.x + xo + xx > 0)
-                    {
-                        point_t pos = {start.x + xo + xx, start.y + yo + yy};
-                        gfx_setPixel(pos, color);
-
-                    }
-                }
-
-                bits <<= 1;
-            }
-        }
-
-        start.x += glyph.xAdvance;
+        start.x += glyph->xAdvance;
     }
     // Calculate text size
     point_t text_size = {0, 0};
-    text_size.x = line_size;
+    text_size.x = text_w;
     text_size.y = (saved_start_y - start.y) + line_h;
     return text_size;
 }
 
+point_t gfx_getTextBox(point_t start, fontSize_t size, textAlign_t alignment,
+                       const char *buf, point_t *boxStart)
+{
+    GFXfont f = fonts[size];
+
+    size_t   len  = strlen(buf);
+    int16_t  x    = get_reset_x(alignment, get_line_size(f, buf, len), start.x);
+    int16_t  x0   = SCREEN_WIDTH;
+    int16_t  y0   = SCREEN_HEIGHT;
+    int16_t  x1   = 0;
+    int16_t  y1   = 0;
+    for(unsigned i = 0; i < len; i++)
+    {
+        const GFXglyph *glyph = &f.glyph[buf[i] - f.first];
+        if(x + glyph->xAdvance > SCREEN_WIDTH) break;
+
+        if((glyph->width != 0) && (glyph->height != 0))
+        {
+            int16_t gx = x + glyph->xOffset;
+            int16_t gy = start.y + glyph->yOffset;
+            if(gx < x0) x0 = gx;
+            if(gy < y0) y0 = gy;
+            if(gx + glyph->width > x1)  x1 = gx + glyph->width;
+            if(gy + glyph->height > y1) y1 = gy + glyph->height;
+        }
+
+        x += glyph->xAdvance;
+    }
+
+    if(x0 < 0) x0 = 0;
+    if(y0 < 0) y0 = 0;
+    if(x1 > SCREEN_WIDTH)  x1 = SCREEN_WIDTH;
+    if(y1 > SCREEN_HEIGHT) y1 = SCREEN_HEIGHT;
+
+    point_t box_size = {0, 0};
+    boxStart->x = x0;
+    boxStart->y = y0;
+    if(x1 > x0) box_size.x = x1 - x0;
+    if(y1 > y0) box_size.y = y1 - y0;
+    if((box_size.x == 0) || (box_size.y == 0)) box_size = (point_t) {0, 0};
+    return box_size;
+}
+
 point_t gfx_print(point_t start, fontSize_t size, textAlign_t alignment,
                   color_t color, const char *fmt, ... )
 {
     // Get format string and arguments from var char
+    char text[32];
     va_list ap;
     va_start(ap, fmt);
     vsnprintf(text, sizeof(text)-1, fmt, ap);
@@ -502,16 +1155,11 @@ point_t gfx_print(point_t start, fontSize_t size, textAlign_t alignment,
     return gfx_printBuffer(start, size, alignment, color, text);
 }
 
-point_t gfx_printLine(uint8_t cur, uint8_t tot, uint16_t startY, uint16_t endY,
-                      uint16_t startX, fontSize_t size, textAlign_t alignment,
-                      color_t color, const char* fmt, ... )
+point_t gfx_printLineBuffer(uint8_t cur, uint8_t tot, uint16_t startY,
+                            uint16_t endY, uint16_t startX, fontSize_t size,
+                            textAlign_t alignment, color_t color,
+                            const char *buf)
 {
-    // Get format string and arguments from var char
-    va_list ap;
-    va_start(ap, fmt);
-    vsnprintf(text, sizeof(text)-1, fmt, ap);
-    va_end(ap);
-
     // Estimate font height by reading the gliph | height
     uint8_t fontH = gfx_getFontHeight(size);
 
@@ -526,7 +1174,22 @@ point_t gfx_printLine(uint8_t cur, uint8_t tot, uint16_t startY, uint16_t endY,
     uint16_t printY = startY + (cur * (gap + fontH));
 
     point_t start = {startX, printY};
-    return gfx_printBuffer(start, size, alignment, color, text);
+    return gfx_printBuffer(start, size, alignment, color, buf);
+}
+
+point_t gfx_printLine(uint8_t cur, uint8_t tot, uint16_t startY, uint16_t endY,
+                      uint16_t startX, fontSize_t size, textAlign_t alignment,
+                      color_t color, const char* fmt, ... )
+{
+    // Get format string and arguments from var char
+    char text[32];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(text, sizeof(text)-1, fmt, ap);
+    va_end(ap);
+
+    return gfx_printLineBuffer(cur, tot, startY, endY, startX, size, alignment,
+                               color, text);
 }
 
 // Print an error message to the center of the screen, surronded by a red (when possible) box
@@ -539,7 +1202,7 @@ void gfx_printError(const char *text, fontSize_t size)
     point_t start = {0, SCREEN_HEIGHT/2 + 5};
 
     // Print the error message
-    point_t text_size = gfx_print(start, size, TEXT_ALIGN_CENTER, white, text);
+    point_t text_size = gfx_printBuffer(start, size, TEXT_ALIGN_CENTER, white, text);
     text_size.x += box_padding;
     text_size.y += box_padding;
     point_t box_start = {0, 0};
@@ -590,7 +1253,7 @@ void gfx_drawBattery(point_t start, uint16_t width, uint16_t height,
         bat_color = red;
     else if (percentage > 60)
         bat_color = green;
-#elif defined PIX_FMT_BW
+#else
     color_t bat_color = white;
 #endif
 
@@ -651,12 +1314,14 @@ void gfx_drawSmeter(point_t start, uint16_t width, uint16_t height, float rssi,
         color_t color = (i % 3 == 0) ? yellow : white;
         color = (i > 9) ? red : color;
         point_t pixel_pos = {start.x + i * (width - 1) / 11, start.y};
+        char label[4] = "+";
         if (i == 10) {
             pixel_pos.x -= 8;
-            gfx_print(pixel_pos, FONT_SIZE_5PT, TEXT_ALIGN_LEFT, color, "+%d", i);
+            fmt_unsigned(label + 1, sizeof(label) - 1, i, 0, ' ');
         }
         else
-            gfx_print(pixel_pos, FONT_SIZE_5PT, TEXT_ALIGN_LEFT, color, "%d", i);
+            fmt_unsigned(label, sizeof(label), i, 0, ' ');
+        gfx_printBuffer(pixel_pos, FONT_SIZE_5PT, TEXT_ALIGN_LEFT, color, label);
         if (i == 10) {
             pixel_pos.x += 8;
         }
@@ -665,7 +1330,7 @@ void gfx_drawSmeter(point_t start, uint16_t width, uint16_t height, float rssi,
     }
 
     point_t pixel_pos = {start.x + width - 11, start.y};
-    gfx_print(pixel_pos, FONT_SIZE_5PT, TEXT_ALIGN_LEFT, red, "+20");
+    gfx_printBuffer(pixel_pos, FONT_SIZE_5PT, TEXT_ALIGN_LEFT, red, "+20");
     pixel_pos.x += 10;
     pixel_pos.y += height;
     gfx_setPixel(pixel_pos, red);
@@ -685,6 +1350,50 @@ void gfx_drawSmeter(point_t start, uint16_t width, uint16_t height, float rssi,
     gfx_drawRect(squelch_pos, squelch_width, squelch_height, color, true);
 }
 
+/*
+ * Function to draw band scope bar graph of arbitrary size
+ * starting coordinates are relative to the top left point.
+ * Levels from -127dBm (S0) to -43dBm (S9+20dB) are mapped on the graph height.
+ *
+ *        **               |
+ *        **     **        |
+ *        **     **        |  <-- Height (px)
+ *   **   **   ****   **   |
+ * ************************|
+ * ________________________
+ *
+ * ^
+ * |
+ *
+ * Width (px)
+ *
+ */
+void gfx_drawBandScope(point_t start, uint16_t width, uint16_t height,
+                       const int8_t *data, uint16_t points, uint16_t first,
+                       uint16_t count, color_t color)
+{
+    color_t black = {0, 0, 0, 255};
+
+    if((points == 0) || (width < points)) return;
+    if(count > points) count = points;
+
+    uint16_t bar_width = width / points;
+    for(uint16_t i = 0; i < count; i++)
+    {
+        uint16_t point = (first + i) % points;
+        int16_t  level = data[point] + 127;
+        if(level < 0)  level = 0;
+        if(level > 84) level = 84;
+
+        // Clear the old bar and draw the new one, at least one pixel high
+        uint16_t bar_height = 1 + (level * (height - 1)) / 84;
+        point_t  bar_pos    = {start.x + point * bar_width, start.y};
+        gfx_drawRect(bar_pos, bar_width, height - bar_height, black, true);
+        bar_pos.y += height - bar_height;
+        gfx_drawRect(bar_pos, bar_width, bar_height, color, true);
+    }
+}
+
 /*
  * Function to draw GPS satellites snr bar graph of arbitrary size
  * starting coordinates are relative to the top left point.
@@ -725,8 +1434,11 @@ void gfx_drawGPSgraph(point_t start,
         color_t bar_color = (active_sats & 1 << (sats[i].id - 1)) ? yellow : white;
         gfx_drawRect(bar_pos, bar_width, bar_height, bar_color, true);
         point_t id_pos = {bar_pos.x, start.y + height};
-        gfx_print(id_pos, FONT_SIZE_5PT, TEXT_ALIGN_LEFT,
-                  bar_color, "%2d ", sats[i].id);
+        char id_buf[5];
+        size_t len = fmt_unsigned(id_buf, sizeof(id_buf), sats[i].id, 2, ' ');
+        fmt_string(id_buf + len, sizeof(id_buf) - len, " ", 1);
+        gfx_printBuffer(id_pos, FONT_SIZE_5PT, TEXT_ALIGN_LEFT,
+                        bar_color, id_buf);
     }
     uint8_t bars_width = 9 + 11 * (bar_width + 2);
     point_t left_line_end = {start.x, start.y + height - 9};
@@ -770,5 +1482,5 @@ void gfx_drawGPScompass(point_t start,
     }
     // North indicator
     point_t n_pos = {start.x + radius - 3, start.y + 7};
-    gfx_print(n_pos, FONT_SIZE_6PT, TEXT_ALIGN_LEFT, white, "N");
+    gfx_printBuffer(n_pos, FONT_SIZE_6PT, TEXT_ALIGN_LEFT, white, "N");
 }
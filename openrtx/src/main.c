@@ -37,6 +37,8 @@
 #include <interfaces/graphics.h>
 #include <interfaces/delays.h>
 #include <hwconfig.h>
+#include <cycles.h>
+#include <trace.h>
 
 extern void *ui_task(void *arg);
 
@@ -58,6 +60,12 @@ int main(void)
     // Initialize platform drivers
     platform_init();
 
+    // Start the cycle counter shared by profiler, trace and probes
+    cycles_init();
+
+    // Start recording trace events, if enabled
+    trace_init();
+
     // Initialize display and graphics driver
     gfx_init();
 
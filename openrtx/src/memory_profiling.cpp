@@ -70,39 +70,118 @@ unsigned int getCurrentFreeHeap()
 
 #else
 
+#include <pthread.h>
+#include <malloc.h>
+#include <unistd.h>
+#include <stdint.h>
+
 /*
- * No memory profiling is possible on x86/64 machines, thus all the functions
- * return 0.
+ * On linux, stack usage is estimated exploiting the fact that the thread
+ * stacks are mapped on demand: pages never touched by the thread read as
+ * zero. Heap statistics come from the C library allocator.
+ */
+
+/**
+ * \internal
+ * Get the boundaries of the caller thread stack.
+ */
+static bool _stackBounds(uintptr_t *low, size_t *size)
+{
+    pthread_attr_t attr;
+    void *addr;
+
+    if(pthread_getattr_np(pthread_self(), &attr) != 0) return false;
+    pthread_attr_getstack(&attr, &addr, size);
+    pthread_attr_destroy(&attr);
+
+    *low = reinterpret_cast< uintptr_t >(addr);
+    return true;
+}
+
+// Minimum free heap, tracked only across the calls to the profiling functions
+static size_t minFreeHeap = SIZE_MAX;
+
+/**
+ * \internal
+ * Get the current heap usage.
  */
+static void _heapInfo(size_t *size, size_t *free)
+{
+    #if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+    #else
+    struct mallinfo mi = mallinfo();
+    #endif
+
+    *size = mi.arena + mi.hblkhd;
+    *free = mi.fordblks;
+    if(*free < minFreeHeap) minFreeHeap = *free;
+}
 
 unsigned int getStackSize()
 {
-    return 0;
+    uintptr_t low;
+    size_t    size;
+    if(_stackBounds(&low, &size) == false) return 0;
+
+    return size;
 }
 
 unsigned int getAbsoluteFreeStack()
 {
+    uintptr_t low;
+    size_t    size;
+    if(_stackBounds(&low, &size) == false) return 0;
+
+    // Walk down from the page of the current stack pointer until a page never
+    // touched is found.
+    const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t sp   = reinterpret_cast< uintptr_t >(__builtin_frame_address(0));
+    uintptr_t page = sp & ~(pageSize - 1);
+
+    while(page > low)
+    {
+        page -= pageSize;
+
+        const uintptr_t *walk = reinterpret_cast< const uintptr_t * >(page);
+        const uintptr_t *end  = walk + (pageSize / sizeof(uintptr_t));
+        while((walk < end) && (*walk == 0)) walk++;
+
+        if(walk == end) return (page + pageSize) - low;
+    }
+
     return 0;
 }
 
 unsigned int getCurrentFreeStack()
 {
-    return 0;
+    uintptr_t low;
+    size_t    size;
+    if(_stackBounds(&low, &size) == false) return 0;
+
+    uintptr_t sp = reinterpret_cast< uintptr_t >(__builtin_frame_address(0));
+    return sp - low;
 }
 
 unsigned int getHeapSize()
 {
-    return 0;
+    size_t size, free;
+    _heapInfo(&size, &free);
+    return size;
 }
 
 unsigned int getAbsoluteFreeHeap()
 {
-    return 0;
+    size_t size, free;
+    _heapInfo(&size, &free);
+    return minFreeHeap;
 }
 
 unsigned int getCurrentFreeHeap()
 {
-    return 0;
+    size_t size, free;
+    _heapInfo(&size, &free);
+    return free;
 }
 
 #endif
@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <probe.h>
+#include <atomic>
+#include <cstdio>
+
+#ifdef _MIOSIX
+#include <cycles.h>
+#else
+#include <time.h>
+#endif
+
+static std::atomic< probe_t * > registry(nullptr);
+
+/*
+ * Time backend: DWT cycle counter on Cortex-M, monotonic clock on linux.
+ */
+#ifdef _MIOSIX
+
+static inline uint32_t _ticks()
+{
+    return cycles_get();
+}
+
+uint64_t probe_toNs(uint64_t ticks)
+{
+    return (ticks * 1000) / cycles_perUs();
+}
+
+#else
+
+static inline uint32_t _ticks()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+uint64_t probe_toNs(uint64_t ticks)
+{
+    return ticks;
+}
+
+#endif
+
+void probe_begin(probe_t *probe)
+{
+    probe->start   = _ticks();
+    probe->running = true;
+}
+
+void probe_end(probe_t *probe)
+{
+    uint32_t now = _ticks();
+    if(probe->running == false) return;
+
+    uint32_t delta = now - probe->start;
+    probe->running = false;
+
+    if((probe->count == 0) || (delta < probe->min)) probe->min = delta;
+    if(delta > probe->max) probe->max = delta;
+    probe->sum   += delta;
+    probe->count += 1;
+
+    uint8_t bin = (delta == 0) ? 0 : (31 - __builtin_clz(delta));
+    probe->hist[bin] += 1;
+
+    // First completed measurement, add the probe to the registry
+    if(__atomic_exchange_n(&probe->registered, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        probe_t *head = registry.load();
+        do
+        {
+            probe->next = head;
+        }
+        while(registry.compare_exchange_weak(head, probe) == false);
+    }
+}
+
+void probe_reset(probe_t *probe)
+{
+    probe->running = false;
+    probe->count   = 0;
+    probe->min     = 0;
+    probe->max     = 0;
+    probe->sum     = 0;
+
+    for(uint8_t i = 0; i < PROBE_HIST_BINS; i++) probe->hist[i] = 0;
+}
+
+const probe_t *probe_getFirst()
+{
+    return registry.load();
+}
+
+void probe_dump()
+{
+    printf("Probe                  count    min us   mean us    max us\n");
+
+    for(const probe_t *p = registry.load(); p != nullptr; p = p->next)
+    {
+        if(p->count == 0) continue;
+
+        uint64_t mean = p->sum / p->count;
+        printf("%-20s %7lu %9.1f %9.1f %9.1f\n", p->name,
+               static_cast< unsigned long >(p->count),
+               probe_toNs(p->min) / 1000.0f,
+               probe_toNs(mean)   / 1000.0f,
+               probe_toNs(p->max) / 1000.0f);
+
+        // Histogram, only non-empty bins with their lower bound
+        for(uint8_t i = 0; i < PROBE_HIST_BINS; i++)
+        {
+            if(p->hist[i] == 0) continue;
+            printf("    >= %10llu ns: %lu\n",
+                   static_cast< unsigned long long >(probe_toNs(1ULL << i)),
+                   static_cast< unsigned long >(p->hist[i]));
+        }
+    }
+}
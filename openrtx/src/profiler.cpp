@@ -0,0 +1,228 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <memory_profiling.h>
+#include <cycles.h>
+#include <profiler.h>
+#include <pthread.h>
+#include <atomic>
+#include <cstdio>
+
+#ifndef _MIOSIX
+#include <time.h>
+#endif
+
+struct profRecord
+{
+    const char             *name;
+    std::atomic< uint32_t > stackSize;
+    std::atomic< uint32_t > stackUsed;
+    std::atomic< uint32_t > cpuTime;   // Run time, in us
+    uint32_t                lastCpu;   // Run time at last update
+    uint8_t                 cpuLoad;
+    long long               lastStack; // Time of last stack sample
+    #ifdef _MIOSIX
+    uint32_t                start;     // Cycle counter at work unit start
+    uint32_t                cycles;    // Cycles not yet converted to us
+    #endif
+};
+
+static profRecord             records[PROF_MAX_THREADS];
+static std::atomic< uint8_t > numThreads(0);
+static pthread_mutex_t        regMutex   = PTHREAD_MUTEX_INITIALIZER;
+static long long              lastUpdate = 0;
+
+/*
+ * Run time backend: on Cortex-M the DWT cycle counter measures the duration
+ * of each work unit, on linux the thread CPU clock is read at the end of it.
+ */
+#ifdef _MIOSIX
+
+static inline void _cpuBegin(profRecord& rec)
+{
+    rec.start = cycles_get();
+}
+
+static inline void _cpuEnd(profRecord& rec)
+{
+    rec.cycles += cycles_get() - rec.start;
+
+    // Convert to microseconds only the whole part, keep the remainder
+    uint32_t cyclesPerUs = cycles_perUs();
+    uint32_t us = rec.cycles / cyclesPerUs;
+    rec.cycles -= us * cyclesPerUs;
+    rec.cpuTime.fetch_add(us, std::memory_order_relaxed);
+}
+
+#else
+
+static inline void _cpuBegin(profRecord& rec)
+{
+    (void) rec;
+}
+
+static inline void _cpuEnd(profRecord& rec)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    uint32_t us = (ts.tv_sec * 1000000LL) + (ts.tv_nsec / 1000);
+    rec.cpuTime.store(us, std::memory_order_relaxed);
+}
+
+#endif
+
+/**
+ * \internal
+ * Update the stack usage of the calling thread.
+ */
+static void _sampleStack(profRecord& rec)
+{
+    uint32_t size = getStackSize();
+    rec.stackSize.store(size, std::memory_order_relaxed);
+    rec.stackUsed.store(size - getAbsoluteFreeStack(), std::memory_order_relaxed);
+    rec.lastStack = getTick();
+}
+
+int8_t prof_registerThread(const char *name)
+{
+    // Registrations are serialised, so that each record is completely filled
+    // in before the thread count including it is published to the readers.
+    pthread_mutex_lock(&regMutex);
+
+    uint8_t id = numThreads.load(std::memory_order_relaxed);
+    if(id >= PROF_MAX_THREADS)
+    {
+        pthread_mutex_unlock(&regMutex);
+        return -1;
+    }
+
+    if(id == 0) lastUpdate = getTick();
+
+    profRecord& rec = records[id];
+    rec.name    = name;
+    rec.lastCpu = 0;
+    rec.cpuLoad = 0;
+    rec.cpuTime.store(0);
+    _cpuBegin(rec);
+    _cpuEnd(rec);
+    _sampleStack(rec);
+
+    numThreads.store(id + 1, std::memory_order_release);
+    pthread_mutex_unlock(&regMutex);
+
+    return id;
+}
+
+void prof_begin(int8_t id)
+{
+    if((id < 0) || (id >= numThreads.load(std::memory_order_acquire))) return;
+    _cpuBegin(records[id]);
+}
+
+void prof_end(int8_t id)
+{
+    if((id < 0) || (id >= numThreads.load(std::memory_order_acquire))) return;
+
+    profRecord& rec = records[id];
+    _cpuEnd(rec);
+
+    if((getTick() - rec.lastStack) >= PROF_STACK_PERIOD) _sampleStack(rec);
+}
+
+void prof_update()
+{
+    long long now     = getTick();
+    uint32_t  elapsed = (now - lastUpdate) * 1000;
+    lastUpdate        = now;
+
+    uint8_t count = numThreads.load(std::memory_order_acquire);
+    for(uint8_t i = 0; i < count; i++)
+    {
+        profRecord& rec = records[i];
+        uint32_t cpu    = rec.cpuTime.load(std::memory_order_relaxed);
+        uint32_t delta  = cpu - rec.lastCpu;
+        rec.lastCpu     = cpu;
+
+        uint32_t load = 0;
+        if(elapsed > 0) load = (static_cast< uint64_t >(delta) * 100) / elapsed;
+        rec.cpuLoad = (load > 100) ? 100 : load;
+    }
+}
+
+uint8_t prof_getThreadCount()
+{
+    return numThreads.load(std::memory_order_acquire);
+}
+
+bool prof_getThreadInfo(int8_t id, profThread_t *info)
+{
+    uint8_t count = numThreads.load(std::memory_order_acquire);
+    if((id < 0) || (id >= count) || (info == NULL)) return false;
+
+    const profRecord& rec = records[id];
+    info->name      = rec.name;
+    info->stackSize = rec.stackSize.load(std::memory_order_relaxed);
+    info->stackUsed = rec.stackUsed.load(std::memory_order_relaxed);
+    info->cpuTime   = rec.cpuTime.load(std::memory_order_relaxed);
+    info->cpuLoad   = rec.cpuLoad;
+
+    return true;
+}
+
+profHeap_t prof_getHeapInfo()
+{
+    profHeap_t heap;
+    heap.size    = getHeapSize();
+    heap.used    = heap.size - getCurrentFreeHeap();
+    heap.maxUsed = heap.size - getAbsoluteFreeHeap();
+
+    return heap;
+}
+
+void prof_dump()
+{
+    printf("Thread      CPU  Stack used/size\n");
+
+    uint8_t count = numThreads.load(std::memory_order_acquire);
+    for(uint8_t i = 0; i < count; i++)
+    {
+        profThread_t info;
+        prof_getThreadInfo(i, &info);
+        printf("%-10s %3u%% %6lu/%lu\n", info.name, info.cpuLoad,
+               static_cast< unsigned long >(info.stackUsed),
+               static_cast< unsigned long >(info.stackSize));
+    }
+
+    profHeap_t heap = prof_getHeapInfo();
+    printf("Heap %lu/%lu, max %lu\n", static_cast< unsigned long >(heap.used),
+           static_cast< unsigned long >(heap.size),
+           static_cast< unsigned long >(heap.maxUsed));
+}
@@ -1,83 +1,260 @@
 #include <stdio.h>
 #include "queue.h"
 
-void queue_init(queue_t *q)
-{
-    if(q == NULL) return;
-    pthread_mutex_init(&q->mutex, NULL);
-    pthread_cond_init(&q->not_empty, NULL);
-    q->read_pos  = 0;
-    q->write_pos = 0;
-    q->msg_num   = 0;
-}
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
-void queue_terminate(queue_t *q)
+/**
+ * \internal
+ * Initialise the slots of a lane, each one being ready for being written in the
+ * first lap of the ring.
+ */
+static void _lane_init(queueLane_t *lane)
 {
-    if(q == NULL) return;
-    pthread_mutex_destroy(&q->mutex);
-    pthread_cond_destroy(&q->not_empty);
+    for(uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        atomic_init(&lane->cells[i].seq, i);
+        lane->cells[i].msg = 0;
+    }
+
+    atomic_init(&lane->head, 0);
+    lane->tail = 0;
 }
 
-bool queue_pend(queue_t *q, uint32_t *msg, bool blocking)
+/**
+ * \internal
+ * Push a message in a lane, can be called concurrently by multiple producers.
+ */
+static bool _lane_push(queueLane_t *lane, uint32_t msg)
 {
-    if((q == NULL) || (msg == NULL)) return false;
-
-    pthread_mutex_lock(&q->mutex);
+    unsigned int pos = atomic_load_explicit(&lane->head, memory_order_relaxed);
 
-    // The queue is empty
-    if(q->msg_num == 0)
+    while(1)
     {
-        if(blocking)
+        queueCell_t *cell = &lane->cells[pos & (QUEUE_SIZE - 1)];
+        unsigned int seq  = atomic_load_explicit(&cell->seq,
+                                                 memory_order_acquire);
+        int diff = (int) (seq - pos);
+
+        if(diff == 0)
         {
-            while(q->msg_num == 0)
+            // Slot is free, try to claim it
+            if(atomic_compare_exchange_weak_explicit(&lane->head, &pos, pos + 1,
+                                                     memory_order_relaxed,
+                                                     memory_order_relaxed))
             {
-                pthread_cond_wait(&q->not_empty, &q->mutex);
+                cell->msg = msg;
+                atomic_store_explicit(&cell->seq, pos + 1,
+                                      memory_order_release);
+                return true;
             }
         }
-        else
+        else if(diff < 0)
         {
-            pthread_mutex_unlock(&q->mutex);
+            // Slot still holds a message of the previous lap: lane is full
             return false;
         }
+        else
+        {
+            // Another producer claimed the slot, retry with the new head
+            pos = atomic_load_explicit(&lane->head, memory_order_relaxed);
+        }
     }
+}
 
-    *msg = q->buffer[q->read_pos];
+/**
+ * \internal
+ * Pop a message from a lane, must be called only by the consumer.
+ */
+static bool _lane_pop(queueLane_t *lane, uint32_t *msg)
+{
+    queueCell_t *cell = &lane->cells[lane->tail & (QUEUE_SIZE - 1)];
+    unsigned int seq  = atomic_load_explicit(&cell->seq, memory_order_acquire);
 
-    // Wrap around pointer to make a circular buffer
-    q->read_pos = (q->read_pos + 1) % MSG_QTY;
-    q->msg_num -= 1;
-    pthread_mutex_unlock(&q->mutex);
+    if(((int) (seq - (lane->tail + 1))) < 0) return false;
+
+    *msg = cell->msg;
+    atomic_store_explicit(&cell->seq, lane->tail + QUEUE_SIZE,
+                          memory_order_release);
+    lane->tail += 1;
 
     return true;
 }
 
-bool queue_post(queue_t *q, uint32_t msg)
+/**
+ * \internal
+ * Retrieve a message from the queue without blocking.
+ */
+static bool _queue_pop(queue_t *q, uint32_t *msg)
 {
-    if(q == NULL) return false;
-
-    pthread_mutex_lock(&q->mutex);
+    if(_lane_pop(&q->high, msg))   return true;
+    if(_lane_pop(&q->normal, msg)) return true;
 
-    if(q->msg_num < MSG_QTY)
+    while(1)
     {
-        q->buffer[q->write_pos] = msg;
+        unsigned int pending = atomic_load(&q->pending);
+        if(pending == 0) return false;
 
-        // Wrap around pointer to make a circular buffer
-        q->write_pos = (q->write_pos + 1) % MSG_QTY;
+        // Serve the lowest pending key first
+        uint8_t key = __builtin_ctz(pending);
+        atomic_fetch_and(&q->pending, ~(1u << key));
 
-        // Signal that the queue is not empty
-        if(q->msg_num == 0)
+        /*
+         * A message posted between the clear above and the exchange is taken
+         * now, and its key is flagged again: on the next round the slot is
+         * found empty and the key is skipped.
+         */
+        uint32_t slot = atomic_exchange(&q->slots[key], QUEUE_NO_MSG);
+        if(slot != QUEUE_NO_MSG)
         {
-            pthread_cond_signal(&q->not_empty);
+            *msg = slot;
+            return true;
         }
+    }
+}
 
-        q->msg_num += 1;
+/**
+ * \internal
+ * Wake up the consumer, if sleeping, after a message has been posted.
+ */
+static void _queue_wake(queue_t *q)
+{
+    atomic_fetch_add(&q->seq, 1);
+    if(atomic_load(&q->waiters) == 0) return;
+
+    #ifdef __linux__
+    syscall(SYS_futex, (uint32_t *) &q->seq, FUTEX_WAKE_PRIVATE, 1,
+            NULL, NULL, 0);
+    #else
+    pthread_mutex_lock(&q->mutex);
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->mutex);
+    #endif
+}
+
+/**
+ * \internal
+ * Put the consumer to sleep until the sequence counter changes from the value
+ * observed before last check for pending messages.
+ */
+static void _queue_wait(queue_t *q, unsigned int seq)
+{
+    atomic_fetch_add(&q->waiters, 1);
+
+    #ifdef __linux__
+    syscall(SYS_futex, (uint32_t *) &q->seq, FUTEX_WAIT_PRIVATE, seq,
+            NULL, NULL, 0);
+    #else
+    pthread_mutex_lock(&q->mutex);
+    while(atomic_load(&q->seq) == seq)
+    {
+        pthread_cond_wait(&q->not_empty, &q->mutex);
     }
-    else
+    pthread_mutex_unlock(&q->mutex);
+    #endif
+
+    atomic_fetch_sub(&q->waiters, 1);
+}
+
+void queue_init(queue_t *q)
+{
+    if(q == NULL) return;
+
+    _lane_init(&q->high);
+    _lane_init(&q->normal);
+
+    for(uint8_t i = 0; i < QUEUE_MAX_KEYS; i++)
     {
-        pthread_mutex_unlock(&q->mutex);
+        atomic_init(&q->slots[i], QUEUE_NO_MSG);
+    }
+
+    atomic_init(&q->pending, 0);
+    atomic_init(&q->overflows, 0);
+    atomic_init(&q->seq, 0);
+    atomic_init(&q->waiters, 0);
+
+    #ifndef __linux__
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    #endif
+}
+
+void queue_terminate(queue_t *q)
+{
+    if(q == NULL) return;
+
+    #ifndef __linux__
+    pthread_mutex_destroy(&q->mutex);
+    pthread_cond_destroy(&q->not_empty);
+    #endif
+}
+
+bool queue_pend(queue_t *q, uint32_t *msg, bool blocking)
+{
+    if((q == NULL) || (msg == NULL)) return false;
+
+    while(1)
+    {
+        if(_queue_pop(q, msg)) return true;
+        if(blocking == false)  return false;
+
+        /*
+         * Sample the sequence counter and check again: a message posted after
+         * this point changes the counter, making the wait return immediately.
+         */
+        unsigned int seq = atomic_load(&q->seq);
+        if(_queue_pop(q, msg)) return true;
+        _queue_wait(q, seq);
+    }
+}
+
+bool queue_post(queue_t *q, uint32_t msg)
+{
+    if(q == NULL) return false;
+
+    if(_lane_push(&q->normal, msg) == false)
+    {
+        atomic_fetch_add(&q->overflows, 1);
         return false;
     }
 
-    pthread_mutex_unlock(&q->mutex);
+    _queue_wake(q);
     return true;
 }
+
+bool queue_postPriority(queue_t *q, uint32_t msg)
+{
+    if(q == NULL) return false;
+
+    if(_lane_push(&q->high, msg) == false)
+    {
+        atomic_fetch_add(&q->overflows, 1);
+        return false;
+    }
+
+    _queue_wake(q);
+    return true;
+}
+
+bool queue_postCoalesced(queue_t *q, uint32_t msg, uint8_t key)
+{
+    if((q == NULL) || (key >= QUEUE_MAX_KEYS)) return false;
+    if(msg == QUEUE_NO_MSG) return false;
+
+    // Store the message before flagging it as pending
+    uint32_t prev = atomic_exchange(&q->slots[key], msg);
+    atomic_fetch_or(&q->pending, 1u << key);
+
+    // A replaced message has not been taken yet, its producer wakes the consumer
+    if(prev == QUEUE_NO_MSG) _queue_wake(q);
+
+    return true;
+}
+
+uint32_t queue_getOverflows(queue_t *q)
+{
+    if(q == NULL) return 0;
+    return atomic_load(&q->overflows);
+}
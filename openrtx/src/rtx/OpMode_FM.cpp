@@ -33,6 +33,8 @@
 #include <interfaces/radio.h>
 #include <interfaces/audio.h>
 #include <OpMode_FM.h>
+#include <rssi.h>
+#include <probe.h>
 #include <rtx.h>
 
 #ifdef PLATFORM_MDUV3x0
@@ -76,7 +78,19 @@ void _setVolume()
 }
 #endif
 
-OpMode_FM::OpMode_FM() : rfSqlOpen(false), sqlOpen(false), enterRx(true)
+// Time taken to switch the radio to TX once PTT is detected
+static PROBE_DEFINE(pttToTx);
+
+/**
+ * \internal
+ * RF squelch hysteresis and width of the region around the squelch threshold
+ * in which RSSI is sampled at fast rate, in fixed-point dBm.
+ */
+static const int32_t SQL_HYSTERESIS = RSSI_FROM_DBM(1) / 10;
+static const int32_t SQL_FAST_WINDOW = RSSI_FROM_DBM(6);
+
+OpMode_FM::OpMode_FM() : rfSqlOpen(false), sqlOpen(false), enterRx(true),
+                         sqlLevel(0xFF), sqlThreshold(0)
 {
 }
 
@@ -90,6 +104,7 @@ void OpMode_FM::enable()
     rfSqlOpen = false;
     sqlOpen   = false;
     enterRx   = true;
+    sqlLevel  = 0xFF;
 }
 
 void OpMode_FM::disable()
@@ -98,6 +113,7 @@ void OpMode_FM::disable()
     audio_disableAmp();
     audio_disableMic();
     radio_disableRtx();
+    rssi_setRate(RSSI_RATE_NORMAL);
     rfSqlOpen = false;
     sqlOpen   = false;
     enterRx   = false;
@@ -110,11 +126,26 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
     // RX logic
     if(status->opStatus == RX)
     {
+        // RF squelch threshold, recomputed only when squelch level changes
+        if(status->sqlLevel != sqlLevel)
+        {
+            sqlLevel     = status->sqlLevel;
+            sqlThreshold = RSSI_FROM_DBM(-127)
+                         + (RSSI_FROM_DBM(66) * sqlLevel) / 15;
+        }
+
         // RF squelch mechanism
-        float squelch = -127.0f + status->sqlLevel * 66.0f / 15.0f;
-        float rssi    = rtx_getRssi();
-        if((rfSqlOpen == false) && (rssi > (squelch + 0.1f))) rfSqlOpen = true;
-        if((rfSqlOpen == true)  && (rssi < (squelch - 0.1f))) rfSqlOpen = false;
+        int32_t rssi = rssi_getValue();
+        if((rfSqlOpen == false) && (rssi > (sqlThreshold + SQL_HYSTERESIS))) rfSqlOpen = true;
+        if((rfSqlOpen == true)  && (rssi < (sqlThreshold - SQL_HYSTERESIS))) rfSqlOpen = false;
+
+        // Sample RSSI faster when close to the threshold, for a more accurate
+        // squelch decision
+        int32_t delta = rssi - sqlThreshold;
+        if((delta > -SQL_FAST_WINDOW) && (delta < SQL_FAST_WINDOW))
+            rssi_setRate(RSSI_RATE_FAST);
+        else
+            rssi_setRate(RSSI_RATE_NORMAL);
 
         // Local flags for current RF and tone squelch status
         bool rfSql   = ((status->rxToneEn == 0) && (rfSqlOpen == true));
@@ -152,13 +183,16 @@ void OpMode_FM::update(rtxStatus_t *const status, const bool newCfg)
     if(platform_getPttStatus() && (status->opStatus != TX) &&
                                   (status->txDisable == 0))
     {
+        PROBE_BEGIN(pttToTx);
         audio_disableAmp();
         radio_disableRtx();
 
         audio_enableMic();
         radio_enableTx();
+        rssi_setRate(RSSI_RATE_NORMAL);
 
         status->opStatus = TX;
+        PROBE_END(pttToTx);
     }
 
     if(!platform_getPttStatus() && (status->opStatus == TX))
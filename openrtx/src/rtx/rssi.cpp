@@ -0,0 +1,279 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/delays.h>
+#include <interfaces/radio.h>
+#include <atomic>
+#include <rssi.h>
+
+/*
+ * Sampling period and filter coefficient for each sampling rate. Coefficients
+ * are in Q8 format and give the same time constant of 22ms to the low pass
+ * filter, equal to the one of the previous floating point implementation
+ * (y = 0.74*x + 0.26*y at 33.3Hz).
+ */
+struct rateCfg
+{
+    uint16_t period;    // Sampling period, in ms
+    int32_t  alpha;     // Filter coefficient, Q8
+};
+
+static const rateCfg rates[] =
+{
+    {30, 189},          // RSSI_RATE_NORMAL: alpha = 0.74
+    {5,  51 }           // RSSI_RATE_FAST:   alpha = 0.20
+};
+
+static const uint8_t ALPHA_BITS = 8;
+
+/*
+ * Acquisition status, accessed only by the rtx task.
+ */
+static const rateCfg *rate;         // Current sampling rate
+static bool      enabled;           // Acquisition enabled
+static bool      reinit;            // Re-initialise the filter at next sample
+static long long holdoffEnd;        // End of the acquisition hold-off time
+static int32_t   filtered;          // Current filter output
+static int32_t   sum;               // Sum of the samples in history
+static uint8_t   head;              // Next history slot to be written
+static uint8_t   length;            // Number of samples in history
+
+/*
+ * Shared data. The current value and the sample counter are updated
+ * atomically, while history and statistics are protected by a sequence
+ * counter: readers retry if it changed during the read or it was odd, meaning
+ * that an update was in progress.
+ */
+static std::atomic< int32_t >  value;
+static std::atomic< uint32_t > count;
+static std::atomic< uint32_t > seq;
+static std::atomic< int32_t >  history[RSSI_HISTORY_LEN];
+static std::atomic< int32_t >  statMin;
+static std::atomic< int32_t >  statAvg;
+static std::atomic< int32_t >  statMax;
+static std::atomic< uint8_t >  statHead;
+static std::atomic< uint8_t >  statLength;
+
+/**
+ * \internal
+ * Begin an update of the data protected by the sequence counter.
+ */
+static inline void _beginUpdate()
+{
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+/**
+ * \internal
+ * End an update of the data protected by the sequence counter.
+ */
+static inline void _endUpdate()
+{
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ * \internal
+ * Clear history and statistics.
+ */
+static void _clearHistory()
+{
+    head   = 0;
+    length = 0;
+    sum    = 0;
+
+    _beginUpdate();
+    statHead.store(0, std::memory_order_relaxed);
+    statLength.store(0, std::memory_order_relaxed);
+    _endUpdate();
+}
+
+void rssi_init()
+{
+    rate       = &rates[RSSI_RATE_NORMAL];
+    enabled    = false;
+    reinit     = true;
+    holdoffEnd = 0;
+    filtered   = static_cast< int32_t >(radio_getRssi() * (1 << RSSI_FRAC_BITS));
+
+    value.store(filtered, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    seq.store(0, std::memory_order_relaxed);
+    _clearHistory();
+}
+
+void rssi_enable(const bool enable)
+{
+    if(enable && (!enabled))
+    {
+        reinit = true;
+        _clearHistory();
+    }
+
+    enabled = enable;
+}
+
+void rssi_reset(const uint16_t holdoff)
+{
+    reinit     = true;
+    holdoffEnd = getTick() + holdoff;
+    _clearHistory();
+}
+
+void rssi_setRate(const enum rssiRate newRate)
+{
+    rate = &rates[newRate];
+}
+
+uint16_t rssi_getPeriod()
+{
+    return rate->period;
+}
+
+void rssi_sample()
+{
+    if(!enabled) return;
+    if(getTick() < holdoffEnd) return;
+
+    int32_t sample = static_cast< int32_t >(radio_getRssi() * (1 << RSSI_FRAC_BITS));
+
+    if(reinit)
+    {
+        filtered = sample;
+        reinit   = false;
+    }
+    else
+    {
+        filtered += ((sample - filtered) * rate->alpha) >> ALPHA_BITS;
+    }
+
+    // Update history and statistics
+    if(length < RSSI_HISTORY_LEN)
+        length += 1;
+    else
+        sum -= history[head].load(std::memory_order_relaxed);
+
+    sum += sample;
+
+    _beginUpdate();
+
+    history[head].store(sample, std::memory_order_relaxed);
+    head = (head + 1) % RSSI_HISTORY_LEN;
+
+    int32_t min = sample;
+    int32_t max = sample;
+    for(uint8_t i = 0; i < length; i++)
+    {
+        int32_t s = history[i].load(std::memory_order_relaxed);
+        if(s < min) min = s;
+        if(s > max) max = s;
+    }
+
+    statMin.store(min, std::memory_order_relaxed);
+    statMax.store(max, std::memory_order_relaxed);
+    statAvg.store(sum / length, std::memory_order_relaxed);
+    statHead.store(head, std::memory_order_relaxed);
+    statLength.store(length, std::memory_order_relaxed);
+
+    _endUpdate();
+
+    value.store(filtered, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+int32_t rssi_getValue()
+{
+    return value.load(std::memory_order_relaxed);
+}
+
+uint32_t rssi_getCount()
+{
+    return count.load(std::memory_order_acquire);
+}
+
+rssiStats_t rssi_getStats()
+{
+    rssiStats_t stats;
+    uint32_t    s1, s2;
+
+    do
+    {
+        s1 = seq.load(std::memory_order_acquire);
+        stats.min    = statMin.load(std::memory_order_relaxed);
+        stats.avg    = statAvg.load(std::memory_order_relaxed);
+        stats.max    = statMax.load(std::memory_order_relaxed);
+        stats.length = statLength.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s2 = seq.load(std::memory_order_relaxed);
+    }
+    while((s1 != s2) || ((s1 & 1) != 0));
+
+    stats.count = count.load(std::memory_order_relaxed);
+
+    // Empty history: report the current value
+    if(stats.length == 0)
+    {
+        stats.min = rssi_getValue();
+        stats.avg = stats.min;
+        stats.max = stats.min;
+    }
+
+    return stats;
+}
+
+size_t rssi_getHistory(int32_t *buf, const size_t len)
+{
+    size_t   n;
+    uint32_t s1, s2;
+
+    do
+    {
+        s1 = seq.load(std::memory_order_acquire);
+
+        uint8_t last = statHead.load(std::memory_order_relaxed);
+        n = statLength.load(std::memory_order_relaxed);
+        if(n > len) n = len;
+
+        // Oldest of the n most recent samples
+        size_t pos = (last + RSSI_HISTORY_LEN - n) % RSSI_HISTORY_LEN;
+        for(size_t i = 0; i < n; i++)
+        {
+            buf[i] = history[pos].load(std::memory_order_relaxed);
+            pos    = (pos + 1) % RSSI_HISTORY_LEN;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s2 = seq.load(std::memory_order_relaxed);
+    }
+    while((s1 != s2) || ((s1 & 1) != 0));
+
+    return n;
+}
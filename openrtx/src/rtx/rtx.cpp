@@ -28,22 +28,308 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
+#include <interfaces/delays.h>
 #include <interfaces/radio.h>
 #include <string.h>
 #include <rtx.h>
-#include <OpMode_FM.h>
+#include <rssi.h>
+#include <trace.h>
+#include <probe.h>
+#include <OpModeRegistry.h>
 
 pthread_mutex_t *cfgMutex;  // Mutex for incoming config messages
 
 const rtxStatus_t *newCnf;  // Pointer for incoming config messages
 rtxStatus_t rtxStatus;      // RTX driver status
 
-float rssi;                 // Current RSSI in dBm
-bool  reinitFilter;         // Flag for RSSI filter re-initialisation
+OpModeRegistry currMode;    // Currently active opMode handler
 
-OpMode *currMode;           // Pointer to currently active opMode handler
-OpMode    noMode;           // Empty opMode handler for opmode::NONE
-OpMode_FM fmMode;           // FM mode handler
+/*
+ * Dual watch: only the RX parameters of the two channels are stored, everything
+ * else stays the one of the main channel.
+ */
+typedef struct
+{
+    freq_t   rxFrequency;
+    uint8_t  sqlLevel;
+    uint16_t rxToneEn : 1,
+             rxTone   : 15;
+}
+dwLeg_t;
+
+/*
+ * RSSI acquisition hold-off after a change of the RX parameters. This is a
+ * workaround for the AT1846S returning a full-scale RSSI value immediately
+ * after one of its parameters changed, thus causing the squelch to open
+ * briefly.
+ */
+static const uint16_t RSSI_HOLDOFF = 30;
+
+static const uint32_t DW_HANG_TIME = 1000;  // Hang time after activity, in ms
+
+// Latency from a new configuration request to its application
+static PROBE_DEFINE(retune);
+
+const rtxStatus_t *dwCnf;   // Pointer for incoming dual watch configuration
+bool     dwPending;         // New dual watch configuration pending
+bool     dwEnabled;         // Dual watch active
+uint16_t dwDwell;           // Dwell time on each channel, in ms
+dwLeg_t  dwLegs[2];         // RX parameters of main and secondary channel
+uint8_t  dwCurrLeg;         // Channel currently monitored
+bool     dwFirstSample;     // First RSSI sample after switching channel
+uint32_t dwSampleCount;     // RSSI sample count when channel was entered
+bool     dwLocked;          // Squelch open, channel switching halted
+uint32_t dwLegStart;        // Time at which current channel has been entered
+uint32_t dwLastActivity;    // Time of last detected activity
+uint32_t dwStartTime;       // Time at which dual watch has been enabled
+dualWatchStats_t dwStats;   // Dual watch statistics
+
+/*
+ * Copy of the dual watch statistics for rtx_getDualWatchStats(), published by
+ * the rtx task under its own mutex.
+ */
+pthread_mutex_t  dwStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+dualWatchStats_t dwStatsPub;
+bool             dwEnabledPub;
+uint32_t         dwStartTimePub;
+
+/*
+ * Band scope: while active, normal RTX operation is suspended and the RSSI
+ * sampling slots of the rtx task are used to step through the sweep.
+ */
+bandScopeCfg_t   bsNewCfg;                      // Incoming sweep configuration
+bool             bsPending;                     // Start/stop request pending
+bool             bsStart;                       // Pending request is a start
+bandScopeCfg_t   bsCfg;                         // Current sweep configuration
+bool             bsActive;                      // Sweep running
+uint16_t         bsPoint;                       // Point currently tuned
+freq_t           bsRestoreFreq;                 // RX frequency before sweep
+uint32_t         bsStartTime;                   // Time at which sweep started
+bandScopeStats_t bsStats;                       // Band scope status
+int8_t           bsData[BSCOPE_MAX_POINTS];     // RSSI of each point, in dBm
+
+/*
+ * Copy of the band scope statistics for rtx_getBandScopeStats(), published by
+ * the rtx task under its own mutex.
+ */
+pthread_mutex_t  bsStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+bandScopeStats_t bsStatsPub;
+uint32_t         bsStartTimePub;
+
+/**
+ * \internal
+ * Load the RX parameters of a dual watch channel in the RTX status and retune
+ * the radio to its frequency. The RSSI filter is reinitialised, to avoid
+ * carrying the signal level of the previous channel over to the new one.
+ */
+void _dwApplyLeg(const uint8_t leg)
+{
+    if(leg == dwCurrLeg) return;
+
+    bool toneChanged = (rtxStatus.rxToneEn != dwLegs[leg].rxToneEn) ||
+                       (rtxStatus.rxTone   != dwLegs[leg].rxTone);
+
+    // Save current parameters, main channel can be reconfigured at any time
+    dwLegs[dwCurrLeg].rxFrequency = rtxStatus.rxFrequency;
+    dwLegs[dwCurrLeg].sqlLevel    = rtxStatus.sqlLevel;
+    dwLegs[dwCurrLeg].rxToneEn    = rtxStatus.rxToneEn;
+    dwLegs[dwCurrLeg].rxTone      = rtxStatus.rxTone;
+
+    rtxStatus.rxFrequency = dwLegs[leg].rxFrequency;
+    rtxStatus.sqlLevel    = dwLegs[leg].sqlLevel;
+    rtxStatus.rxToneEn    = dwLegs[leg].rxToneEn;
+    rtxStatus.rxTone      = dwLegs[leg].rxTone;
+    dwCurrLeg = leg;
+
+    radio_updateRxFrequency();
+
+    // The RX tone decoder is programmed only when entering RX
+    if(toneChanged && (rtxStatus.opStatus == RX))
+    {
+        radio_disableRtx();
+        radio_enableRx();
+    }
+
+    rssi_reset(RSSI_HOLDOFF);
+
+    dwFirstSample = true;
+    dwSampleCount = rssi_getCount();
+    dwLegStart    = getTick();
+}
+
+/**
+ * \internal
+ * Tune the radio to a given point of the band scope sweep.
+ */
+void _bsTune(const uint16_t point)
+{
+    bsPoint = point;
+    rtxStatus.rxFrequency = bsCfg.startFreq + point * bsCfg.step;
+    radio_updateRxFrequency();
+}
+
+/**
+ * \internal
+ * Start a new band scope sweep, suspending normal operation if required.
+ */
+void _bsStart()
+{
+    if(!bsActive)
+    {
+        // Sweep always starts from main channel, radio is kept in RX
+        _dwApplyLeg(0);
+        bsRestoreFreq = rtxStatus.rxFrequency;
+        currMode.disable();
+        rtxStatus.opStatus = OFF;
+        radio_disableRtx();
+        radio_enableRx();
+    }
+
+    bsCfg = bsNewCfg;
+    if(bsCfg.points > BSCOPE_MAX_POINTS) bsCfg.points    = BSCOPE_MAX_POINTS;
+    if(bsCfg.points == 0)                bsCfg.points    = 1;
+    if(bsCfg.dwellTime == 0)             bsCfg.dwellTime = 1;
+
+    memset(bsData, -127, sizeof(bsData));
+    memset(&bsStats, 0x00, sizeof(bandScopeStats_t));
+    bsStats.active = true;
+    bsStartTime    = getTick();
+    bsActive       = true;
+
+    _bsTune(0);
+}
+
+/**
+ * \internal
+ * Stop the band scope sweep and resume normal operation. The current mode
+ * handler is enabled again, which takes care of bringing the radio back in RX.
+ *
+ * @param restore: if true, restore the RX frequency in use before the sweep.
+ */
+void _bsStop(const bool restore)
+{
+    if(restore)
+    {
+        rtxStatus.rxFrequency = bsRestoreFreq;
+        radio_updateRxFrequency();
+    }
+
+    radio_disableRtx();
+    rtxStatus.opStatus = OFF;
+    currMode.enable();
+
+    bsActive       = false;
+    bsStats.active = false;
+}
+
+/**
+ * \internal
+ * Publish the band scope statistics. As for the dual watch ones, the rtx task
+ * never waits for the mutex and the copy is refreshed at the next call.
+ */
+void _bsPublishStats()
+{
+    if(pthread_mutex_trylock(&bsStatsMutex) != 0) return;
+
+    bsStatsPub     = bsStats;
+    bsStartTimePub = bsStartTime;
+
+    pthread_mutex_unlock(&bsStatsMutex);
+}
+
+/**
+ * \internal
+ * Band scope step: store the RSSI of the point tuned at the previous step and
+ * tune to the next one.
+ */
+void _bsStep()
+{
+    float rssi = radio_getRssi();
+    if(rssi < -127.0f) rssi = -127.0f;
+    if(rssi >  127.0f) rssi =  127.0f;
+    bsData[bsPoint] = static_cast< int8_t >(rssi);
+    bsStats.count  += 1;
+
+    uint16_t next = bsPoint + 1;
+    if(next >= bsCfg.points)
+    {
+        next = 0;
+        bsStats.sweeps += 1;
+    }
+
+    _bsTune(next);
+    _bsPublishStats();
+}
+
+/**
+ * \internal
+ * Dual watch periodic update, called while in RX.
+ */
+void _dwUpdate()
+{
+    // Wait for a valid RSSI value of the current channel
+    if(rssi_getCount() == dwSampleCount) return;
+
+    uint32_t now = getTick();
+
+    // Same opening condition of the FM squelch, without hysteresis
+    bool active = false;
+    if(rtxStatus.rxToneEn == 1)
+    {
+        active = radio_checkRxDigitalSquelch();
+    }
+    else
+    {
+        int32_t squelch = RSSI_FROM_DBM(-127)
+                        + (RSSI_FROM_DBM(66) * rtxStatus.sqlLevel) / 15;
+        active = (rssi_getValue() > squelch);
+    }
+
+    if(active)
+    {
+        if(!dwLocked)
+        {
+            dwStats.activity[dwCurrLeg] += 1;
+
+            // Transmission started while monitoring the other channel
+            if(dwFirstSample) dwStats.missed += 1;
+        }
+
+        dwLocked       = true;
+        dwLastActivity = now;
+    }
+    else if(dwLocked && ((now - dwLastActivity) >= DW_HANG_TIME))
+    {
+        dwLocked   = false;
+        dwLegStart = now;
+    }
+
+    dwFirstSample = false;
+
+    if((!dwLocked) && ((now - dwLegStart) >= dwDwell))
+    {
+        _dwApplyLeg(dwCurrLeg ^ 1);
+        dwStats.switches += 1;
+    }
+}
+
+/**
+ * \internal
+ * Publish the dual watch statistics. The rtx task never waits for the mutex:
+ * if a reader is holding it, the copy is refreshed at the next call.
+ */
+void _dwPublishStats()
+{
+    if(pthread_mutex_trylock(&dwStatsMutex) != 0) return;
+
+    dwStatsPub           = dwStats;
+    dwStatsPub.activeLeg = dwCurrLeg;
+    dwStatsPub.locked    = dwLocked;
+    dwEnabledPub         = dwEnabled;
+    dwStartTimePub       = dwStartTime;
+
+    pthread_mutex_unlock(&dwStatsMutex);
+}
 
 void rtx_init(pthread_mutex_t *m)
 {
@@ -66,7 +352,7 @@ void rtx_init(pthread_mutex_t *m)
     rtxStatus.rxTone      = 0;
     rtxStatus.txToneEn    = 0;
     rtxStatus.txTone      = 0;
-    currMode = &noMode;
+    currMode.select(NONE);
 
     /*
      * Initialise low-level platform-specific driver
@@ -75,17 +361,35 @@ void rtx_init(pthread_mutex_t *m)
     radio_updateConfiguration();
 
     /*
-     * Initial value for RSSI filter
+     * Initialise RSSI acquisition, started when radio enters in RX mode
      */
-    rssi         = radio_getRssi();
-    reinitFilter = false;
+    rssi_init();
+
+    /*
+     * Dual watch disabled by default
+     */
+    dwCnf     = NULL;
+    dwPending = false;
+    dwEnabled = false;
+    dwCurrLeg = 0;
+    dwLocked  = false;
+    memset(&dwStats, 0x00, sizeof(dualWatchStats_t));
+    _dwPublishStats();
+
+    /*
+     * Band scope stopped
+     */
+    bsPending = false;
+    bsActive  = false;
+    memset(&bsStats, 0x00, sizeof(bandScopeStats_t));
+    _bsPublishStats();
 }
 
 void rtx_terminate()
 {
     rtxStatus.opStatus = OFF;
     rtxStatus.opMode   = NONE;
-    currMode->disable();
+    currMode.disable();
     radio_terminate();
 }
 
@@ -99,9 +403,76 @@ void rtx_configure(const rtxStatus_t *cfg)
 
     pthread_mutex_lock(cfgMutex);
     newCnf = cfg;
+    PROBE_BEGIN(retune);
+    pthread_mutex_unlock(cfgMutex);
+}
+
+void rtx_setDualWatch(const rtxStatus_t *cfg, uint16_t dwellTime)
+{
+    pthread_mutex_lock(cfgMutex);
+    dwCnf     = cfg;
+    dwDwell   = dwellTime;
+    dwPending = true;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+dualWatchStats_t rtx_getDualWatchStats()
+{
+    pthread_mutex_lock(&dwStatsMutex);
+    dualWatchStats_t stats     = dwStatsPub;
+    bool             enabled   = dwEnabledPub;
+    uint32_t         startTime = dwStartTimePub;
+    pthread_mutex_unlock(&dwStatsMutex);
+
+    uint32_t elapsed = getTick() - startTime;
+    if(enabled && (elapsed > 0))
+    {
+        stats.switchRate = (static_cast< float >(stats.switches) * 1000.0f)
+                         / static_cast< float >(elapsed);
+    }
+
+    return stats;
+}
+
+void rtx_startBandScope(const bandScopeCfg_t *cfg)
+{
+    pthread_mutex_lock(cfgMutex);
+    bsNewCfg  = *cfg;
+    bsStart   = true;
+    bsPending = true;
+    pthread_mutex_unlock(cfgMutex);
+}
+
+void rtx_stopBandScope()
+{
+    pthread_mutex_lock(cfgMutex);
+    bsStart   = false;
+    bsPending = true;
     pthread_mutex_unlock(cfgMutex);
 }
 
+const int8_t *rtx_getBandScopeData()
+{
+    return bsData;
+}
+
+bandScopeStats_t rtx_getBandScopeStats()
+{
+    pthread_mutex_lock(&bsStatsMutex);
+    bandScopeStats_t stats     = bsStatsPub;
+    uint32_t         startTime = bsStartTimePub;
+    pthread_mutex_unlock(&bsStatsMutex);
+
+    uint32_t elapsed = getTick() - startTime;
+    if(stats.active && (elapsed > 0))
+    {
+        stats.pointsPerSec = (static_cast< float >(stats.count) * 1000.0f)
+                           / static_cast< float >(elapsed);
+    }
+
+    return stats;
+}
+
 rtxStatus_t rtx_getCurrentStatus()
 {
     return rtxStatus;
@@ -109,6 +480,8 @@ rtxStatus_t rtx_getCurrentStatus()
 
 void rtx_taskFunc()
 {
+    TRACE_BEGIN("rtx_taskFunc");
+
     // Check if there is a pending new configuration and, in case, read it.
     bool reconfigure = false;
     if(pthread_mutex_trylock(cfgMutex) == 0)
@@ -122,6 +495,45 @@ void rtx_taskFunc()
 
             reconfigure = true;
             newCnf = NULL;
+
+            // New configuration is for the main channel
+            dwCurrLeg = 0;
+            dwLocked  = false;
+
+            // and stops the band scope
+            if(bsActive) _bsStop(false);
+        }
+
+        if(dwPending)
+        {
+            // Go back to main channel before changing dual watch settings
+            _dwApplyLeg(0);
+
+            dwEnabled = (dwCnf != NULL);
+            if(dwEnabled)
+            {
+                dwLegs[1].rxFrequency = dwCnf->rxFrequency;
+                dwLegs[1].sqlLevel    = dwCnf->sqlLevel;
+                dwLegs[1].rxToneEn    = dwCnf->rxToneEn;
+                dwLegs[1].rxTone      = dwCnf->rxTone;
+            }
+
+            memset(&dwStats, 0x00, sizeof(dualWatchStats_t));
+            dwLocked    = false;
+            dwStartTime = getTick();
+            dwLegStart  = dwStartTime;
+            dwCnf       = NULL;
+            dwPending   = false;
+        }
+
+        if(bsPending)
+        {
+            if(bsStart)
+                _bsStart();
+            else if(bsActive)
+                _bsStop(true);
+
+            bsPending = false;
         }
 
         pthread_mutex_unlock(cfgMutex);
@@ -132,78 +544,95 @@ void rtx_taskFunc()
         /*
          * Handle change of opMode:
          * - deactivate current opMode and switch operating status to "OFF";
-         * - update pointer to current mode handler to the OpMode object for the
-         *   selected mode;
+         * - replace the current mode handler with the one for the selected mode,
+         *   falling back to the empty one if the mode is not enabled for the
+         *   target;
          * - enable the new mode handler
          */
-        if(currMode->getID() != rtxStatus.opMode)
+        if(currMode.getID() != rtxStatus.opMode)
         {
             // Forward opMode change also to radio driver
             radio_setOpmode(static_cast< enum opmode >(rtxStatus.opMode));
 
-            currMode->disable();
+            currMode.disable();
             rtxStatus.opStatus = OFF;
 
-            switch(rtxStatus.opMode)
-            {
-                case NONE: currMode = &noMode;  break;
-                case FM:   currMode = &fmMode;  break;
-                default:   currMode = &noMode;
-            }
-
-            currMode->enable();
+            currMode.select(static_cast< enum opmode >(rtxStatus.opMode));
+            currMode.enable();
         }
 
         // Tell radio driver that there was a change in its configuration.
         radio_updateConfiguration();
+
+        // Discard the RSSI value of the previous configuration
+        rssi_reset(RSSI_HOLDOFF);
     }
 
+    _bsPublishStats();
+
     /*
-     * RSSI update block, run only when radio is in RX mode.
-     *
-     * RSSI value is passed through a filter with a time constant of 60ms
-     * (cut-off frequency of 15Hz) at an update rate of 33.3Hz.
-     *
-     * The low pass filter skips an update step if a new configuration has
-     * just been applied. This is a workaround for the AT1846S returning a
-     * full-scale RSSI value immediately after one of its parameters changed,
-     * thus causing the squelch to open briefly.
-     *
-     * Also, the RSSI filter is re-initialised every time radio stage is
-     * switched back from TX/OFF to RX. This provides a workaround for some
-     * radios reporting a full-scale RSSI value when transmitting.
+     * While band scope is running, the opMode handler is suspended and RSSI
+     * acquisition is stopped.
      */
-    if(rtxStatus.opStatus == RX)
+    if(bsActive)
     {
+        rssi_enable(false);
+        TRACE_END("rtx_taskFunc");
+        return;
+    }
 
-        if(!reconfigure)
-        {
-            if(!reinitFilter)
-            {
-                rssi = 0.74*radio_getRssi() + 0.26*rssi;
-            }
-            else
-            {
-                rssi = radio_getRssi();
-                reinitFilter = false;
-            }
-        }
+    // Always go back to main channel when not receiving
+    if(dwEnabled && (rtxStatus.opStatus != RX))
+    {
+        _dwApplyLeg(0);
+        dwLocked = false;
     }
-    else
+
+    /*
+     * Dual watch update, run only when radio is in RX mode. Channel switch is
+     * done before handing control to the opMode handler, so that it always
+     * operates on the current RX parameters.
+     */
+    if(dwEnabled && (rtxStatus.opStatus == RX) && (!reconfigure))
     {
-        // Reinit required if current operating status is TX or OFF
-        reinitFilter = true;
+        _dwUpdate();
     }
 
+    _dwPublishStats();
+
     /*
      * Forward the periodic update step to the currently active opMode handler.
-     * Call is placed after RSSI update to allow handler's code have a fresh
-     * version of the RSSI level.
      */
-    currMode->update(&rtxStatus, reconfigure);
+    currMode.update(&rtxStatus, reconfigure);
+    if(reconfigure) PROBE_END(retune);
+
+    /*
+     * RSSI is acquired only when radio is in RX mode. The filter is also
+     * re-initialised every time radio stage is switched back from TX/OFF to
+     * RX. This provides a workaround for some radios reporting a full-scale
+     * RSSI value when transmitting.
+     */
+    rssi_enable(rtxStatus.opStatus == RX);
+
+    TRACE_END("rtx_taskFunc");
+}
+
+void rtx_sampleRssi()
+{
+    // Band scope sweep steps take the place of RSSI samples
+    if(bsActive)
+        _bsStep();
+    else
+        rssi_sample();
+}
+
+uint16_t rtx_getRssiPeriod()
+{
+    if(bsActive) return bsCfg.dwellTime;
+    return rssi_getPeriod();
 }
 
 float rtx_getRssi()
 {
-    return rssi;
+    return static_cast< float >(rssi_getValue()) / (1 << RSSI_FRAC_BITS);
 }
@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 #include <state.h>
 #include <battery.h>
 #include <hwconfig.h>
@@ -38,6 +39,12 @@
 
 state_t state;
 
+/*
+ * Section versions. The GPS one is also used as a sequence lock, being odd
+ * while the GPS data is being written.
+ */
+static atomic_uint versions[STATE_NUM_SECTIONS];
+
 void state_init()
 {
     /*
@@ -103,6 +110,11 @@ void state_init()
         // NOTE: Settings writing disabled until DFU is implemented
         //nvm_writeSettings(&state.settings);
     }
+
+    for(uint8_t i = 0; i < STATE_NUM_SECTIONS; i++)
+    {
+        state_publish(i);
+    }
 }
 
 void state_terminate()
@@ -112,6 +124,96 @@ void state_terminate()
     //nvm_writeSettings(&state.settings);
 }
 
+void state_publish(uint8_t section)
+{
+    if(section >= STATE_NUM_SECTIONS) return;
+
+    // Keep versions even, odd values are used by the GPS sequence lock
+    atomic_fetch_add(&versions[section], 2);
+}
+
+void state_publishGps(const gps_t *gps)
+{
+    atomic_fetch_add_explicit(&versions[STATE_GPS], 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&state.gps_data, gps, sizeof(gps_t));
+    atomic_fetch_add_explicit(&versions[STATE_GPS], 1, memory_order_release);
+}
+
+size_t state_snapshot(state_t *dst, uint32_t *ver)
+{
+    // Fields not belonging to any section
+    dst->radioStateUpdated = state.radioStateUpdated;
+    dst->time              = state.time;
+    dst->rssi              = state.rssi;
+    dst->ui_screen         = state.ui_screen;
+    size_t copied = sizeof(dst->radioStateUpdated) + sizeof(dst->time)
+                  + sizeof(dst->rssi)              + sizeof(dst->ui_screen);
+
+    uint32_t v = atomic_load(&versions[STATE_RADIO]);
+    if(v != ver[STATE_RADIO])
+    {
+        dst->tuner_mode    = state.tuner_mode;
+        dst->channel_index = state.channel_index;
+        dst->channel       = state.channel;
+        dst->vfo_channel   = state.vfo_channel;
+        dst->zone_enabled  = state.zone_enabled;
+        dst->zone          = state.zone;
+        dst->rtxStatus     = state.rtxStatus;
+        dst->sqlLevel      = state.sqlLevel;
+        dst->voxLevel      = state.voxLevel;
+        dst->emergency     = state.emergency;
+        copied += sizeof(dst->tuner_mode)   + sizeof(dst->channel_index)
+                + sizeof(dst->channel)      + sizeof(dst->vfo_channel)
+                + sizeof(dst->zone_enabled) + sizeof(dst->zone)
+                + sizeof(dst->rtxStatus)    + sizeof(dst->sqlLevel)
+                + sizeof(dst->voxLevel)     + sizeof(dst->emergency);
+        ver[STATE_RADIO] = v;
+    }
+
+    v = atomic_load(&versions[STATE_POWER]);
+    if(v != ver[STATE_POWER])
+    {
+        dst->v_bat  = state.v_bat;
+        dst->charge = state.charge;
+        copied += sizeof(dst->v_bat) + sizeof(dst->charge);
+        ver[STATE_POWER] = v;
+    }
+
+    v = atomic_load(&versions[STATE_SETTINGS]);
+    if(v != ver[STATE_SETTINGS])
+    {
+        dst->settings = state.settings;
+        copied += sizeof(dst->settings);
+        ver[STATE_SETTINGS] = v;
+    }
+
+    // GPS data is written without holding the state mutex, retry the copy if
+    // it changed in the meantime.
+    v = atomic_load_explicit(&versions[STATE_GPS], memory_order_acquire);
+    while(v != ver[STATE_GPS])
+    {
+        if((v & 1) == 0)
+        {
+            memcpy(&dst->gps_data, &state.gps_data, sizeof(dst->gps_data));
+            copied += sizeof(dst->gps_data);
+            atomic_thread_fence(memory_order_acquire);
+
+            uint32_t check = atomic_load_explicit(&versions[STATE_GPS],
+                                                  memory_order_relaxed);
+            if(check == v)
+            {
+                ver[STATE_GPS] = v;
+                break;
+            }
+        }
+
+        v = atomic_load_explicit(&versions[STATE_GPS], memory_order_acquire);
+    }
+
+    return copied;
+}
+
 curTime_t state_getLocalTime(curTime_t utc_time)
 {
     curTime_t local_time = utc_time;
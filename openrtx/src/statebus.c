@@ -0,0 +1,170 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stdatomic.h>
+#include <statebus.h>
+#include <event.h>
+
+typedef struct
+{
+    atomic_uint topics;     // Topics of interest
+    atomic_uint dirty;      // Topics changed and not yet collected
+    queue_t    *queue;      // Notification queue, NULL if slot is free
+}
+subscriber_t;
+
+static subscriber_t subscribers[STATEBUS_MAX_SUBSCRIBERS];
+static int32_t      thresholds[TOPIC_NUM];
+static int32_t      lastValue[TOPIC_NUM];
+static bool         valid[TOPIC_NUM];
+
+static atomic_uint  updates;
+static atomic_uint  filtered;
+static atomic_uint  published;
+static atomic_uint  wakeups;
+
+void statebus_init()
+{
+    for(uint8_t i = 0; i < STATEBUS_MAX_SUBSCRIBERS; i++)
+    {
+        atomic_init(&subscribers[i].topics, 0);
+        atomic_init(&subscribers[i].dirty, 0);
+        subscribers[i].queue = NULL;
+    }
+
+    for(uint8_t i = 0; i < TOPIC_NUM; i++)
+    {
+        thresholds[i] = 1;
+        valid[i]      = false;
+    }
+
+    // Default thresholds: 50mV of battery voltage and 1dB of RSSI
+    thresholds[TOPIC_BATTERY] = 50;
+    thresholds[TOPIC_RSSI]    = 10;
+
+    atomic_init(&updates, 0);
+    atomic_init(&filtered, 0);
+    atomic_init(&published, 0);
+    atomic_init(&wakeups, 0);
+}
+
+int8_t statebus_subscribe(uint32_t topics, queue_t *queue)
+{
+    if(queue == NULL) return -1;
+
+    for(uint8_t i = 0; i < STATEBUS_MAX_SUBSCRIBERS; i++)
+    {
+        if(subscribers[i].queue != NULL) continue;
+
+        atomic_store(&subscribers[i].topics, topics);
+        atomic_store(&subscribers[i].dirty, 0);
+        subscribers[i].queue = queue;
+        return i;
+    }
+
+    return -1;
+}
+
+void statebus_setTopics(int8_t id, uint32_t topics)
+{
+    if((id < 0) || (id >= STATEBUS_MAX_SUBSCRIBERS)) return;
+    atomic_store(&subscribers[id].topics, topics);
+}
+
+uint32_t statebus_collect(int8_t id)
+{
+    if((id < 0) || (id >= STATEBUS_MAX_SUBSCRIBERS)) return 0;
+    return atomic_exchange(&subscribers[id].dirty, 0);
+}
+
+void statebus_setThreshold(uint8_t topic, int32_t threshold)
+{
+    if(topic >= TOPIC_NUM) return;
+    thresholds[topic] = threshold;
+}
+
+bool statebus_update(uint8_t topic, int32_t value)
+{
+    if(topic >= TOPIC_NUM) return false;
+
+    atomic_fetch_add(&updates, 1);
+
+    int32_t delta = value - lastValue[topic];
+    if(delta < 0) delta = -delta;
+
+    if(valid[topic] && (delta < thresholds[topic]))
+    {
+        atomic_fetch_add(&filtered, 1);
+        return false;
+    }
+
+    lastValue[topic] = value;
+    valid[topic]     = true;
+    statebus_publish(topic);
+
+    return true;
+}
+
+void statebus_publish(uint8_t topic)
+{
+    if(topic >= TOPIC_NUM) return;
+
+    atomic_fetch_add(&published, 1);
+
+    uint32_t mask = TOPIC_MASK(topic);
+    for(uint8_t i = 0; i < STATEBUS_MAX_SUBSCRIBERS; i++)
+    {
+        subscriber_t *sub = &subscribers[i];
+        if(sub->queue == NULL) continue;
+        if((atomic_load(&sub->topics) & mask) == 0) continue;
+
+        // Wake up the subscriber only if it has no pending notification
+        uint32_t prev = atomic_fetch_or(&sub->dirty, mask);
+        if(prev == 0)
+        {
+            event_t event;
+            event.type    = EVENT_STATUS;
+            event.payload = 0;
+            (void) queue_postCoalesced(sub->queue, event.value, EVENT_STATUS);
+            atomic_fetch_add(&wakeups, 1);
+        }
+    }
+}
+
+statebusStats_t statebus_getStats()
+{
+    statebusStats_t stats;
+    stats.updates   = atomic_load(&updates);
+    stats.filtered  = atomic_load(&filtered);
+    stats.published = atomic_load(&published);
+    stats.wakeups   = atomic_load(&wakeups);
+
+    return stats;
+}
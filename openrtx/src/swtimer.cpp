@@ -0,0 +1,276 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <swtimer.h>
+
+#ifdef _MIOSIX
+#include <miosix.h>
+#else
+#include <time.h>
+#endif
+
+static pthread_mutex_t mutex;
+static swtimer_t      *wheel[SWTIMER_WHEEL_SLOTS];
+static long long       cursor;      // Index of the last processed slot
+
+/*
+ * Time backend: the service keeps time in microseconds. On miosix the kernel
+ * tick has a resolution of 1ms, on linux the monotonic clock is used.
+ */
+#ifdef _MIOSIX
+
+static inline long long _now()
+{
+    return miosix::getTick() * 1000;
+}
+
+static inline void _sleepUntil(long long time)
+{
+    miosix::Thread::sleepUntil(time / 1000);
+}
+
+#else
+
+static inline long long _now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000LL) + (ts.tv_nsec / 1000);
+}
+
+static inline void _sleepUntil(long long time)
+{
+    struct timespec ts;
+    ts.tv_sec  = time / 1000000;
+    ts.tv_nsec = (time % 1000000) * 1000;
+
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) ;
+}
+
+#endif
+
+/**
+ * \internal
+ * Insert a timer in the wheel slot corresponding to its deadline, keeping the
+ * slot list sorted by deadline. To be called with the mutex locked.
+ */
+static void _insert(swtimer_t *timer)
+{
+    uint32_t slot = (timer->deadline / SWTIMER_SLOT_US)
+                  & (SWTIMER_WHEEL_SLOTS - 1);
+
+    swtimer_t **pos = &wheel[slot];
+    while((*pos != NULL) && ((*pos)->deadline <= timer->deadline))
+    {
+        pos = &(*pos)->next;
+    }
+
+    timer->next   = *pos;
+    timer->active = true;
+    *pos          = timer;
+}
+
+/**
+ * \internal
+ * Remove a timer from the wheel. To be called with the mutex locked.
+ */
+static void _remove(swtimer_t *timer)
+{
+    if(timer->active == false) return;
+
+    uint32_t slot = (timer->deadline / SWTIMER_SLOT_US)
+                  & (SWTIMER_WHEEL_SLOTS - 1);
+
+    swtimer_t **pos = &wheel[slot];
+    while((*pos != NULL) && (*pos != timer))
+    {
+        pos = &(*pos)->next;
+    }
+
+    if(*pos != NULL) *pos = timer->next;
+    timer->next   = NULL;
+    timer->active = false;
+}
+
+/**
+ * \internal
+ * Get the earliest deadline among all the active timers. Since slot lists are
+ * sorted, only their heads have to be checked. To be called with the mutex
+ * locked.
+ */
+static long long _nextDeadline(long long limit)
+{
+    long long next = limit;
+
+    for(uint32_t i = 0; i < SWTIMER_WHEEL_SLOTS; i++)
+    {
+        if((wheel[i] != NULL) && (wheel[i]->deadline < next))
+        {
+            next = wheel[i]->deadline;
+        }
+    }
+
+    return next;
+}
+
+void swtimer_init()
+{
+    pthread_mutex_init(&mutex, NULL);
+
+    for(uint32_t i = 0; i < SWTIMER_WHEEL_SLOTS; i++)
+    {
+        wheel[i] = NULL;
+    }
+
+    cursor = _now() / SWTIMER_SLOT_US;
+}
+
+void *swtimer_task(void *arg)
+{
+    (void) arg;
+
+    while(1)
+    {
+        long long now = _now();
+        long long last = now / SWTIMER_SLOT_US;
+
+        // Walk the slots elapsed since last run, at most a whole revolution
+        long long first = cursor;
+        if((last - first) >= SWTIMER_WHEEL_SLOTS)
+        {
+            first = last - SWTIMER_WHEEL_SLOTS + 1;
+        }
+
+        pthread_mutex_lock(&mutex);
+
+        for(long long idx = first; idx <= last; idx++)
+        {
+            swtimer_t **head = &wheel[idx & (SWTIMER_WHEEL_SLOTS - 1)];
+
+            while((*head != NULL) && ((*head)->deadline <= now))
+            {
+                swtimer_t *timer = *head;
+                *head         = timer->next;
+                timer->next   = NULL;
+                timer->active = false;
+
+                long long late = _now() - timer->deadline;
+                timer->count     += 1;
+                timer->sumJitter += late;
+                if(late > timer->maxJitter) timer->maxJitter = late;
+
+                // Re-arm periodic timers before running the callback, skipping
+                // the periods already expired.
+                if(timer->period != 0)
+                {
+                    timer->deadline += timer->period;
+                    if(timer->deadline <= now)
+                    {
+                        uint32_t skip = ((now - timer->deadline)
+                                      / timer->period) + 1;
+                        timer->missed   += skip;
+                        timer->deadline += (long long) skip * timer->period;
+                    }
+
+                    _insert(timer);
+                }
+
+                // Run the callback with the mutex unlocked, so that it can
+                // start and stop timers.
+                swtimerCallback_t callback = timer->callback;
+                void *cbArg = timer->arg;
+                pthread_mutex_unlock(&mutex);
+                callback(cbArg);
+                pthread_mutex_lock(&mutex);
+            }
+        }
+
+        cursor = last;
+        long long next = _nextDeadline(now + (SWTIMER_MAX_SLEEP * 1000));
+
+        pthread_mutex_unlock(&mutex);
+
+        _sleepUntil(next);
+    }
+
+    return NULL;
+}
+
+void swtimer_start(swtimer_t *timer, uint32_t delay, uint32_t period,
+                   swtimerCallback_t callback, void *arg)
+{
+    if((timer == NULL) || (callback == NULL)) return;
+
+    pthread_mutex_lock(&mutex);
+
+    _remove(timer);
+
+    timer->deadline  = _now() + (delay * 1000LL);
+    timer->period    = period * 1000;
+    timer->callback  = callback;
+    timer->arg       = arg;
+    timer->count     = 0;
+    timer->missed    = 0;
+    timer->maxJitter = 0;
+    timer->sumJitter = 0;
+    _insert(timer);
+
+    pthread_mutex_unlock(&mutex);
+}
+
+void swtimer_stop(swtimer_t *timer)
+{
+    if(timer == NULL) return;
+
+    pthread_mutex_lock(&mutex);
+    _remove(timer);
+    pthread_mutex_unlock(&mutex);
+}
+
+swtimerStats_t swtimer_getStats(const swtimer_t *timer)
+{
+    swtimerStats_t stats = {0, 0, 0, 0};
+    if(timer == NULL) return stats;
+
+    pthread_mutex_lock(&mutex);
+
+    stats.count     = timer->count;
+    stats.missed    = timer->missed;
+    stats.maxJitter = timer->maxJitter;
+    if(timer->count > 0)
+    {
+        stats.avgJitter = timer->sumJitter / timer->count;
+    }
+
+    pthread_mutex_unlock(&mutex);
+
+    return stats;
+}
@@ -31,6 +31,8 @@
 #include <hwconfig.h>
 #include <pthread.h>
 #include <sched.h>
+#include <string.h>
+#include <stdatomic.h>
 #include <ui.h>
 #include <state.h>
 #include <threads.h>
@@ -42,6 +44,12 @@
 #include <event.h>
 #include <rtx.h>
 #include <queue.h>
+#include <statebus.h>
+#include <framesched.h>
+#include <swtimer.h>
+#include <profiler.h>
+#include <trace.h>
+#include <probe.h>
 #include <minmea.h>
 #ifdef HAS_GPS
 #include <interfaces/gps.h>
@@ -60,6 +68,27 @@ pthread_mutex_t display_mutex;
 /* Queue for sending and receiving ui update requests */
 queue_t ui_queue;
 
+/* Software timers for keyboard scan and radio state update */
+static swtimer_t kbd_timer;
+static swtimer_t kbd_retry_timer;
+static swtimer_t dev_timer;
+static swtimer_t prof_timer;
+#if defined(ENABLE_TRACE) && defined(_MIOSIX)
+static swtimer_t trace_timer;
+#endif
+
+/* Profiler ID of the software timers thread */
+static int8_t timer_prof = -1;
+
+// Latency from keypress to the start of the corresponding frame transfer
+static PROBE_DEFINE(keyToFrame);
+#ifdef ENABLE_PHOTON_PROBE
+// Latency from keypress to the end of the corresponding frame transfer
+static PROBE_DEFINE(keyToPhoton);
+#endif
+// Set from the first keypress of a burst until its frame is measured
+static atomic_bool keyProbeOpen;
+
 /**
  * \internal Task function in charge of updating the UI.
  */
@@ -71,31 +100,56 @@ void *ui_task(void *arg)
     bool sync_rtx = true;
     rtxStatus_t rtx_cfg;
 
+    int8_t prof_id = prof_registerThread("UI");
+
     // Get initial state local copy
     pthread_mutex_lock(&state_mutex);
     ui_saveState();
     pthread_mutex_unlock(&state_mutex);
 
+    // Subscribe to the state changes shown by the current screen
+    int8_t bus_id = statebus_subscribe(ui_getTopics(), &ui_queue);
+
     // Initial GUI draw
     ui_updateGUI();
     gfx_render();
 
+    // Input events waiting for the next frame
+    bool input = false;
+
     while(1)
     {
-        // Read from the keyboard queue (returns 0 if no message is present)
-        // Copy keyboard_t keys from received void * pointer msg
+        // Wait for an event, then drain all the pending ones before drawing
         event_t event;
         event.value = 0;
         (void) queue_pend(&ui_queue, &event.value, true);
+        prof_begin(prof_id);
+
+        do
+        {
+            // Frame events only wake up the thread for a scheduled frame
+            if(event.type == EVENT_FRAME) continue;
 
-        // Lock mutex, read and write state
-        pthread_mutex_lock(&state_mutex);
-        // React to keypresses and update FSM inside state
-        ui_updateFSM(event, &sync_rtx);
-        // Update state local copy
-        ui_saveState();
-        // Unlock mutex
-        pthread_mutex_unlock(&state_mutex);
+            uint32_t dirty = statebus_collect(bus_id);
+
+            // Lock mutex, read and write state
+            pthread_mutex_lock(&state_mutex);
+            // React to keypresses and update FSM inside state
+            ui_updateFSM(event, &sync_rtx);
+            // Update state local copy
+            ui_saveState();
+            // Unlock mutex
+            pthread_mutex_unlock(&state_mutex);
+
+            // Status changes not shown on the current screen need no redraw
+            uint32_t topics = ui_getTopics();
+            statebus_setTopics(bus_id, topics);
+            bool redraw = (event.type == EVENT_KBD) || ((dirty & topics) != 0);
+            framesched_event(redraw);
+
+            if(event.type == EVENT_KBD) input = true;
+        }
+        while(queue_pend(&ui_queue, &event.value, false));
 
         // If synchronization needed take mutex and update RTX configuration
         if(sync_rtx)
@@ -117,147 +171,224 @@ void *ui_task(void *arg)
             sync_rtx = false;
         }
 
-        // Redraw GUI based on last state copy
-        ui_updateGUI();
-        // Lock display mutex and render display
-        pthread_mutex_lock(&display_mutex);
-        gfx_render();
-        pthread_mutex_unlock(&display_mutex);
+        // Render at most one frame per frame period, also when only a
+        // continuous refresh of the current screen is due
+        framesched_setPeriodic(0, ui_getRefreshPeriod());
+        if(framesched_frameDue())
+        {
+            // Redraw GUI based on last state copy
+            ui_updateGUI();
+            // Lock display mutex and render display. The transfer proceeds
+            // in background while the next frame is drawn
+            pthread_mutex_lock(&display_mutex);
+            gfx_render();
+            pthread_mutex_unlock(&display_mutex);
+            framesched_frameDone();
+            // Frame is on its way to the display, look ahead for the next ones
+            ui_prefetch();
+
+            if(input)
+            {
+                PROBE_END(keyToFrame);
+                #ifdef ENABLE_PHOTON_PROBE
+                // Wait for the end of the transfer to measure the whole input
+                // to screen latency. This stalls the UI until the frame is on
+                // screen, thus it is done only when explicitly requested.
+                gfx_waitRender();
+                PROBE_END(keyToPhoton);
+                #endif
+                atomic_store(&keyProbeOpen, false);
+                input = false;
+            }
+        }
 
-        // We don't need a delay because we lock on incoming events
-        // TODO: Enable self refresh when a continuous visualization is enabled
-        // Update UI at ~33 FPS
-        //OSTimeDlyHMSM(0u, 0u, 0u, 30u, OS_OPT_TIME_HMSM_STRICT, &os_err);
+        prof_end(prof_id);
     }
 }
 
+/*
+ * Keyboard status, kept between two keyboard scans. Arrays are sized for all
+ * the bits of keyboard_t, since kbd_num_keys is not a constant expression.
+ */
+#define KBD_MAX_KEYS (8 * sizeof(keyboard_t))
+
+static long long  key_ts[KBD_MAX_KEYS];          // Key press timestamps
+static bool       long_press_sent[KBD_MAX_KEYS]; // Long-press event sent
+static keyboard_t prev_keys = 0;                 // Previous keyboard status
+
 /**
- * \internal Task function for reading and sending keyboard status.
+ * \internal Timer callback for reading and sending keyboard status.
  */
-void *kbd_task(void *arg)
+static void kbd_scan(void *arg)
 {
     (void) arg;
 
-    // Initialize keyboard driver
-    kbd_init();
-
-    // Allocate timestamp array
-    long long key_ts[kbd_num_keys];
-    long long now;
-
-    // Allocate bool array to send only one long-press event
-    bool long_press_sent[kbd_num_keys];
+    prof_begin(timer_prof);
 
-    // Variable for saving previous and current keyboard status
-    keyboard_t prev_keys = 0;
-    keyboard_t keys = 0;
+    // Reset flags and get current time
     bool long_press = false;
     bool send_event = false;
-
-    while(1)
+    // Lock display mutex and read keyboard status. Keyboard lines are shared
+    // with the display ones on some devices: if a frame transfer is running,
+    // retry the scan shortly, in the gap before the next one
+    pthread_mutex_lock(&display_mutex);
+    if(gfx_renderingInProgress())
     {
-        // Reset flags and get current time
-        long_press = false;
-        send_event = false;
-        // Lock display mutex and read keyboard status
-        pthread_mutex_lock(&display_mutex);
-        keys = kbd_getKeys();
         pthread_mutex_unlock(&display_mutex);
-        now = getTick();
-        // The key status has changed
-        if(keys != prev_keys)
+        swtimer_start(&kbd_retry_timer, 1, 0, kbd_scan, NULL);
+        prof_end(timer_prof);
+        return;
+    }
+    keyboard_t keys = kbd_getKeys();
+    pthread_mutex_unlock(&display_mutex);
+    long long now = getTick();
+    // The key status has changed
+    if(keys != prev_keys)
+    {
+        for(uint8_t k=0; k < kbd_num_keys; k++)
         {
-            for(uint8_t k=0; k < kbd_num_keys; k++)
+            // Key has been pressed
+            if(!(prev_keys & (1 << k)) && (keys & (1 << k)))
+            {
+                // Save timestamp
+                key_ts[k] = now;
+                send_event = true;
+                long_press_sent[k] = false;
+            }
+            // Key has been released
+            else if((prev_keys & (1 << k)) && !(keys & (1 << k)))
             {
-                // Key has been pressed
-                if(!(prev_keys & (1 << k)) && (keys & (1 << k)))
-                {
-                    // Save timestamp
-                    key_ts[k] = now;
-                    send_event = true;
-                    long_press_sent[k] = false;
-                }
-                // Key has been released
-                else if((prev_keys & (1 << k)) && !(keys & (1 << k)))
-                {
-                    send_event = true;
-                }
+                send_event = true;
             }
         }
-        // Some key is kept pressed
-        else if(keys != 0)
+    }
+    // Some key is kept pressed
+    else if(keys != 0)
+    {
+        // Check for saved timestamp to trigger long-presses
+        for(uint8_t k=0; k < kbd_num_keys; k++)
         {
-            // Check for saved timestamp to trigger long-presses
-            for(uint8_t k=0; k < kbd_num_keys; k++)
+            // The key is pressed and its long-press timer is over
+            if(keys & (1 << k) && !long_press_sent[k] && (now - key_ts[k]) >= kbd_long_interval)
             {
-                // The key is pressed and its long-press timer is over
-                if(keys & (1 << k) && !long_press_sent[k] && (now - key_ts[k]) >= kbd_long_interval)
-                {
-                    long_press = true;
-                    send_event = true;
-                    long_press_sent[k] = true;
-                }
+                long_press = true;
+                send_event = true;
+                long_press_sent[k] = true;
             }
         }
-        if(send_event)
+    }
+    if(send_event)
+    {
+        kbd_msg_t msg;
+        msg.long_press = long_press;
+        msg.keys = keys;
+        // Send event_t as void * message to use with OSQPost
+        event_t event;
+        event.type = EVENT_KBD;
+        event.payload = msg.value;
+        // Send keyboard status in queue. Keypresses coalesced in the same
+        // frame are measured from the first one of the burst.
+        if(!atomic_exchange(&keyProbeOpen, true))
         {
-            kbd_msg_t msg;
-            msg.long_press = long_press;
-            msg.keys = keys;
-            // Send event_t as void * message to use with OSQPost
-            event_t event;
-            event.type = EVENT_KBD;
-            event.payload = msg.value;
-            // Send keyboard status in queue
-            (void) queue_post(&ui_queue, event.value);
+            PROBE_BEGIN(keyToFrame);
+            #ifdef ENABLE_PHOTON_PROBE
+            PROBE_BEGIN(keyToPhoton);
+            #endif
         }
-        // Save current keyboard state as previous
-        prev_keys = keys;
-
-        // Read keyboard state at 40Hz
-        sleepFor(0u, 25u);
+        (void) queue_postPriority(&ui_queue, event.value);
     }
+    // Save current keyboard state as previous
+    prev_keys = keys;
+
+    prof_end(timer_prof);
 }
 
 /**
- * \internal Task function in charge of updating the radio state.
+ * \internal Timer callback in charge of updating the radio state.
  */
-void *dev_task(void *arg)
+static void dev_update(void *arg)
 {
     (void) arg;
 
-    while(1)
-    {
-        // Lock mutex and update internal state
-        pthread_mutex_lock(&state_mutex);
+    prof_begin(timer_prof);
+
+    // Lock mutex and update internal state
+    pthread_mutex_lock(&state_mutex);
 
 #ifdef HAS_RTC
-        state.time = rtc_getTime();
+    state.time = rtc_getTime();
+    curTime_t time = state.time;
 #endif
 
-        /*
-         * Low-pass filtering with a time constant of 10s when updated at 1Hz
-         * Original computation: state.v_bat = 0.02*vbat + 0.98*state.v_bat
-         * Peak error is 18mV when input voltage is 49mV.
-         */
-        uint16_t vbat = platform_getVbat();
-        state.v_bat  -= (state.v_bat * 2) / 100;
-        state.v_bat  += (vbat * 2) / 100;
+    /*
+     * Low-pass filtering with a time constant of 10s when updated at 1Hz
+     * Original computation: state.v_bat = 0.02*vbat + 0.98*state.v_bat
+     * Peak error is 18mV when input voltage is 49mV.
+     */
+    uint16_t vbat = platform_getVbat();
+    state.v_bat  -= (state.v_bat * 2) / 100;
+    state.v_bat  += (vbat * 2) / 100;
+
+    state.charge = battery_getCharge(state.v_bat);
+    state.rssi = rtx_getRssi();
+    state_publish(STATE_POWER);
+
+    uint16_t v_bat = state.v_bat;
+    float    rssi  = state.rssi;
 
-        state.charge = battery_getCharge(state.v_bat);
-        state.rssi = rtx_getRssi();
+    pthread_mutex_unlock(&state_mutex);
 
-        pthread_mutex_unlock(&state_mutex);
+    // Signal to subscribers only the fields changed beyond threshold
+#ifdef HAS_RTC
+    statebus_update(TOPIC_TIME, (time.hour * 3600) + (time.minute * 60)
+                                + time.second);
+#endif
+    statebus_update(TOPIC_BATTERY, v_bat);
+    statebus_update(TOPIC_RSSI, (int32_t) (rssi * 10.0f));
 
-        // Signal state update to UI thread
-        event_t dev_msg;
-        dev_msg.type = EVENT_STATUS;
-        dev_msg.payload = 0;
-        (void) queue_post(&ui_queue, dev_msg.value);
+    prof_end(timer_prof);
+}
 
-        // Execute state update thread every 1s
-        sleepFor(1u, 0u);
+/**
+ * \internal Timer callback updating the CPU load of all the threads and, if
+ * enabled, periodically printing the profiling data.
+ */
+static void prof_tick(void *arg)
+{
+    (void) arg;
+
+    prof_update();
+
+    #ifdef PROF_DUMP_PERIOD
+    static uint32_t seconds = 0;
+    seconds += 1;
+    if(seconds >= PROF_DUMP_PERIOD)
+    {
+        prof_dump();
+        seconds = 0;
     }
+    #endif
+}
+
+#if defined(ENABLE_TRACE) && defined(_MIOSIX)
+/**
+ * \internal Timer callback streaming the new trace events over the USB virtual
+ * COM port.
+ */
+static void trace_tick(void *arg)
+{
+    (void) arg;
+    trace_dump();
+}
+#endif
+
+/**
+ * \internal Task function running the software timers.
+ */
+static void *timer_task(void *arg)
+{
+    timer_prof = prof_registerThread("Timers");
+    return swtimer_task(arg);
 }
 
 /**
@@ -269,10 +400,36 @@ void *rtx_task(void *arg)
 
     rtx_init(&rtx_mutex);
 
+    long long lastUpdate = 0;
+    uint32_t scopeCount = 0;
+    int8_t prof_id = prof_registerThread("RTX");
+
     while(1)
     {
-        rtx_taskFunc();
-        sleepFor(0u, 30u);
+        prof_begin(prof_id);
+        /*
+         * RSSI is sampled at the rate requested by the current operating mode,
+         * which can be higher than the 33.3Hz rate of the rtx update.
+         */
+        rtx_sampleRssi();
+
+        long long now = getTick();
+        if((now - lastUpdate) >= 30)
+        {
+            rtx_taskFunc();
+            lastUpdate = now;
+
+            // Notify when new band scope points are available
+            bandScopeStats_t scope = rtx_getBandScopeStats();
+            if(scope.active && (scope.count != scopeCount))
+            {
+                statebus_publish(TOPIC_BANDSCOPE);
+                scopeCount = scope.count;
+            }
+        }
+
+        prof_end(prof_id);
+        sleepFor(0u, rtx_getRssiPeriod());
     }
 }
 
@@ -289,9 +446,12 @@ void *gps_task(void *arg)
     if (!gps_detect(5000)) return NULL;
 
     gps_init(9600);
+    int8_t prof_id = prof_registerThread("GPS");
     // Lock mutex to read internal state
     pthread_mutex_lock(&state_mutex);
     bool enabled = state.settings.gps_enabled;
+    gps_t gps_data = state.gps_data;
+    gps_t gps_prev = gps_data;
     pthread_mutex_unlock(&state_mutex);
     if(enabled)
         gps_enable();
@@ -303,14 +463,26 @@ void *gps_task(void *arg)
         int len = gps_getNmeaSentence(line, MINMEA_MAX_LENGTH*10);
         if(len != -1)
         {
-            // Lock mutex and update internal state
+            prof_begin(prof_id);
+
+            // Lock mutex only to read settings
             pthread_mutex_lock(&state_mutex);
+            bool set_time = state.settings.gps_set_time;
+            pthread_mutex_unlock(&state_mutex);
 
+            // Parse on a local copy and publish it without locking the state.
             // GPS readout is blocking, no need to delay here
-            gps_taskFunc(line, len, &state);
+            gps_taskFunc(line, len, &gps_data, set_time);
 
-            // Unlock state mutex
-            pthread_mutex_unlock(&state_mutex);
+            // Publish only sentences actually changing the GPS data
+            if(memcmp(&gps_data, &gps_prev, sizeof(gps_t)) != 0)
+            {
+                state_publishGps(&gps_data);
+                statebus_publish(TOPIC_GPS);
+                gps_prev = gps_data;
+            }
+
+            prof_end(prof_id);
         }
     }
 }
@@ -333,6 +505,12 @@ void create_threads()
     // Create UI event queue
     queue_init(&ui_queue);
 
+    // Create state change bus
+    statebus_init();
+
+    // Create UI frame scheduler
+    framesched_init(&ui_queue, FRAMESCHED_DEFAULT_FPS);
+
     // State initialization, execute before starting all tasks
     state_init();
 
@@ -352,13 +530,25 @@ void create_threads()
 
     pthread_create(&rtx_thread, &rtx_attr, rtx_task, NULL);
 
-    // Create Keyboard thread
-    pthread_t      kbd_thread;
-    pthread_attr_t kbd_attr;
+    // Initialize keyboard driver
+    kbd_init();
+
+    // Keyboard is read at 40Hz, radio state and CPU loads are updated every 1s
+    swtimer_init();
+    swtimer_start(&kbd_timer, 0, 25, kbd_scan, NULL);
+    swtimer_start(&dev_timer, 0, 1000, dev_update, NULL);
+    swtimer_start(&prof_timer, 1000, 1000, prof_tick, NULL);
+    #if defined(ENABLE_TRACE) && defined(_MIOSIX)
+    swtimer_start(&trace_timer, 1000, 1000, trace_tick, NULL);
+    #endif
+
+    // Create software timers thread
+    pthread_t      timer_thread;
+    pthread_attr_t timer_attr;
 
-    pthread_attr_init(&kbd_attr);
-    pthread_attr_setstacksize(&kbd_attr, KBD_TASK_STKSIZE);
-    pthread_create(&kbd_thread, &kbd_attr, kbd_task, NULL);
+    pthread_attr_init(&timer_attr);
+    pthread_attr_setstacksize(&timer_attr, TIMER_TASK_STKSIZE);
+    pthread_create(&timer_thread, &timer_attr, timer_task, NULL);
 
 #if defined(HAS_GPS) && !defined(MD3x0_ENABLE_DBG)
     // Create GPS thread
@@ -369,12 +559,4 @@ void create_threads()
     pthread_attr_setstacksize(&gps_attr, GPS_TASK_STKSIZE);
     pthread_create(&gps_thread, &gps_attr, gps_task, NULL);
 #endif
-
-    // Create state thread
-    pthread_t      state_thread;
-    pthread_attr_t state_attr;
-
-    pthread_attr_init(&state_attr);
-    pthread_attr_setstacksize(&state_attr, DEV_TASK_STKSIZE);
-    pthread_create(&state_thread, &state_attr, dev_task, NULL);
 }
@@ -0,0 +1,307 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <trace.h>
+
+#ifdef ENABLE_TRACE
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _MIOSIX
+#include <miosix.h>
+#include <cycles.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0,
+              "TRACE_RING_SIZE must be a power of two");
+
+struct traceRecord
+{
+    uint32_t    timestamp;
+    int32_t     value;
+    const char *name;
+    uint8_t     type;
+};
+
+struct traceRing
+{
+    std::atomic< uintptr_t > owner;    // Owner thread, zero if ring is free
+    std::atomic< uint32_t >  head;     // Index of the next record to write
+    uint32_t                 sent;     // Index of the next record to stream
+    traceRecord              records[TRACE_RING_SIZE];
+};
+
+// Ring 0 is reserved for the events coming from interrupt context
+static traceRing           rings[TRACE_MAX_RINGS];
+static std::atomic< bool > enabled(false);
+
+/*
+ * Time and thread identification backends: on Cortex-M timestamps come from
+ * the DWT cycle counter, on linux from the monotonic clock.
+ */
+#ifdef _MIOSIX
+
+static inline void _timeInit() { }
+
+static inline uint32_t _timestamp()
+{
+    return cycles_get();
+}
+
+static inline uintptr_t _threadId()
+{
+    return reinterpret_cast< uintptr_t >(miosix::Thread::getCurrentThread());
+}
+
+#else
+
+static long long timeBase = 0;
+
+static inline long long _monotonicUs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000LL) + (ts.tv_nsec / 1000);
+}
+
+static inline void _timeInit()
+{
+    timeBase = _monotonicUs();
+}
+
+static inline uint32_t _timestamp()
+{
+    return _monotonicUs() - timeBase;
+}
+
+static inline uintptr_t _threadId()
+{
+    return static_cast< uintptr_t >(pthread_self());
+}
+
+#endif
+
+/**
+ * \internal
+ * Find the ring owned by the calling thread, claiming a free one if needed.
+ *
+ * @return pointer to the ring or nullptr if no ring is available.
+ */
+static traceRing *_getRing()
+{
+    uintptr_t self = _threadId();
+
+    for(uint8_t i = 1; i < TRACE_MAX_RINGS; i++)
+    {
+        uintptr_t owner = rings[i].owner.load(std::memory_order_relaxed);
+        if(owner == self) return &rings[i];
+
+        if(owner == 0)
+        {
+            if(rings[i].owner.compare_exchange_strong(owner, self))
+                return &rings[i];
+
+            // Someone else took the ring in the meantime, maybe ourselves
+            if(owner == self) return &rings[i];
+        }
+    }
+
+    return nullptr;
+}
+
+static inline void _write(traceRecord& rec, uint8_t type, const char *name,
+                          int32_t value)
+{
+    rec.timestamp = _timestamp();
+    rec.value     = value;
+    rec.name      = name;
+    rec.type      = type;
+}
+
+void trace_init()
+{
+    _timeInit();
+    rings[0].owner.store(UINTPTR_MAX);
+
+    #ifndef _MIOSIX
+    atexit(trace_dump);
+    #endif
+
+    enabled.store(true);
+}
+
+void trace_event(uint8_t type, const char *name, int32_t value)
+{
+    if(enabled.load(std::memory_order_relaxed) == false) return;
+
+    traceRing *ring = _getRing();
+    if(ring == nullptr) return;
+
+    // Single producer: only the owner thread writes in its ring
+    uint32_t idx = ring->head.load(std::memory_order_relaxed);
+    _write(ring->records[idx & (TRACE_RING_SIZE - 1)], type, name, value);
+    ring->head.store(idx + 1, std::memory_order_release);
+}
+
+void trace_isr(const char *name)
+{
+    if(enabled.load(std::memory_order_relaxed) == false) return;
+
+    // Nested interrupts may write concurrently, claim the slot atomically
+    uint32_t idx = rings[0].head.fetch_add(1, std::memory_order_acq_rel);
+    _write(rings[0].records[idx & (TRACE_RING_SIZE - 1)], TRACE_EV_ISR, name, 0);
+}
+
+void trace_enable(bool enable)
+{
+    enabled.store(enable);
+}
+
+#ifndef _MIOSIX
+
+/*
+ * On linux the whole content of the rings is exported in Chrome trace format,
+ * having one track for each ring.
+ */
+void trace_dump()
+{
+    bool wasEnabled = enabled.exchange(false);
+
+    FILE *fp = fopen(TRACE_FILE, "w");
+    if(fp == NULL)
+    {
+        enabled.store(wasEnabled);
+        return;
+    }
+
+    static const char phase[] = {'B', 'E', 'C', 'i'};
+    bool first = true;
+
+    fprintf(fp, "{\"traceEvents\":[");
+    for(uint8_t i = 0; i < TRACE_MAX_RINGS; i++)
+    {
+        traceRing& ring = rings[i];
+        uint32_t   head = ring.head.load(std::memory_order_acquire);
+        if(head == 0) continue;
+
+        fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+                    "\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+                first ? "" : ",", i, (i == 0) ? "ISR" : "Thread", i);
+        first = false;
+
+        uint32_t start = (head > TRACE_RING_SIZE) ? (head - TRACE_RING_SIZE) : 0;
+        for(uint32_t idx = start; idx != head; idx++)
+        {
+            const traceRecord& rec = ring.records[idx & (TRACE_RING_SIZE - 1)];
+            fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lu,"
+                        "\"pid\":0,\"tid\":%d", rec.name, phase[rec.type & 0x03],
+                        static_cast< unsigned long >(rec.timestamp), i);
+
+            if(rec.type == TRACE_EV_COUNTER)
+                fprintf(fp, ",\"args\":{\"value\":%ld}",
+                        static_cast< long >(rec.value));
+            else if(rec.type == TRACE_EV_ISR)
+                fprintf(fp, ",\"s\":\"t\"");
+
+            fprintf(fp, "}");
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    enabled.store(wasEnabled);
+}
+
+#else
+
+/*
+ * On the other targets new events are streamed over the USB virtual COM port,
+ * which backs the standard output. Each dump starts with the "ORTX" magic word,
+ * followed by the format version, the number of rings and the timestamp clock
+ * frequency in Hz. Then follows a record for each event: timestamp, value,
+ * type, ring index, name length and name characters, little endian.
+ */
+void trace_dump()
+{
+    bool wasEnabled = enabled.exchange(false);
+
+    struct __attribute__((packed))
+    {
+        char     magic[4];
+        uint8_t  version;
+        uint8_t  numRings;
+        uint32_t clock;
+    }
+    header = {{'O', 'R', 'T', 'X'}, 1, TRACE_MAX_RINGS, SystemCoreClock};
+
+    fwrite(&header, sizeof(header), 1, stdout);
+
+    for(uint8_t i = 0; i < TRACE_MAX_RINGS; i++)
+    {
+        traceRing& ring = rings[i];
+        uint32_t   head = ring.head.load(std::memory_order_acquire);
+
+        // Skip the events overwritten since the previous dump
+        if((head - ring.sent) > TRACE_RING_SIZE)
+            ring.sent = head - TRACE_RING_SIZE;
+
+        for(; ring.sent != head; ring.sent++)
+        {
+            const traceRecord& rec = ring.records[ring.sent & (TRACE_RING_SIZE - 1)];
+
+            struct __attribute__((packed))
+            {
+                uint32_t timestamp;
+                int32_t  value;
+                uint8_t  type;
+                uint8_t  ring;
+                uint8_t  nameLen;
+            }
+            event = {rec.timestamp, rec.value, rec.type, i,
+                     static_cast< uint8_t >(strnlen(rec.name, 255))};
+
+            fwrite(&event, sizeof(event), 1, stdout);
+            fwrite(rec.name, 1, event.nameLen, stdout);
+        }
+    }
+
+    fflush(stdout);
+    enabled.store(wasEnabled);
+}
+
+#endif
+
+#endif
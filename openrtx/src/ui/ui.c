@@ -82,6 +82,8 @@
 #endif
 #include <string.h>
 #include <battery.h>
+#include <statebus.h>
+#include <profiler.h>
 #include <input.h>
 #include <hwconfig.h>
 
@@ -92,9 +94,9 @@ extern void _ui_drawVFOMiddle();
 extern void _ui_drawMEMMiddle();
 extern void _ui_drawVFOBottom();
 extern void _ui_drawMEMBottom();
-extern void _ui_drawMainVFO();
+extern void _ui_drawMainVFO(ui_state_t* ui_state);
 extern void _ui_drawMainVFOInput(ui_state_t* ui_state);
-extern void _ui_drawMainMEM();
+extern void _ui_drawMainMEM(ui_state_t* ui_state);
 /* UI menu functions, their implementation is in "ui_menu.c" */
 extern void _ui_drawMenuTop(ui_state_t* ui_state);
 extern void _ui_drawMenuZone(ui_state_t* ui_state);
@@ -107,6 +109,7 @@ extern void _ui_drawSettingsGPS(ui_state_t* ui_state);
 extern void _ui_drawMenuSettings(ui_state_t* ui_state);
 extern void _ui_drawMenuInfo(ui_state_t* ui_state);
 extern void _ui_drawMenuAbout();
+extern void _ui_drawMenuBandScope(ui_state_t* ui_state);
 #ifdef HAS_RTC
 extern void _ui_drawSettingsTimeDate();
 extern void _ui_drawSettingsTimeDateSet(ui_state_t* ui_state);
@@ -114,6 +117,12 @@ extern void _ui_drawSettingsTimeDateSet(ui_state_t* ui_state);
 extern void _ui_drawSettingsDisplay(ui_state_t* ui_state);
 extern bool _ui_drawMacroMenu();
 
+extern int _ui_getZoneName(char *buf, uint8_t max_len, uint16_t index);
+extern int _ui_getChannelName(char *buf, uint8_t max_len, uint16_t index);
+extern int _ui_getContactName(char *buf, uint8_t max_len, uint16_t index);
+extern void _ui_listCacheInvalidate();
+extern void _ui_prefetchMenuList(uint8_t screen, uint16_t selected);
+
 const char *menu_items[] =
 {
     "Zone",
@@ -122,6 +131,7 @@ const char *menu_items[] =
 #ifdef HAS_GPS
     "GPS",
 #endif
+    "Band Scope",
     "Settings",
     "Info",
     "About"
@@ -176,6 +186,15 @@ const char *authors[] =
     "Fred IU2NRO",
 };
 
+// Band scope frequency steps, in Hz
+const freq_t scope_steps[] =
+{
+    12500,
+    25000,
+    50000,
+    100000
+};
+
 // Calculate number of menu entries
 const uint8_t menu_num = sizeof(menu_items)/sizeof(menu_items[0]);
 const uint8_t settings_num = sizeof(settings_items)/sizeof(settings_items[0]);
@@ -185,167 +204,29 @@ const uint8_t settings_gps_num = sizeof(settings_gps_items)/sizeof(settings_gps_
 #endif
 const uint8_t info_num = sizeof(info_items)/sizeof(info_items[0]);
 const uint8_t author_num = sizeof(authors)/sizeof(authors[0]);
+const uint8_t scope_steps_num = sizeof(scope_steps)/sizeof(scope_steps[0]);
 
 const color_t color_black = {0, 0, 0, 255};
 const color_t color_grey = {60, 60, 60, 255};
 const color_t color_white = {255, 255, 255, 255};
 const color_t yellow_fab413 = {250, 180, 19, 255};
 
-layout_t layout;
 state_t last_state;
+static uint32_t last_versions[STATE_NUM_SECTIONS];
 ui_state_t ui_state;
 bool macro_menu = false;
-bool layout_ready = false;
 bool redraw_needed = true;
 
-layout_t _ui_calculateLayout()
-{
-    // Horizontal line height
-    const uint16_t hline_h = 1;
-    // Compensate for fonts printing below the start position
-    const uint16_t text_v_offset = 1;
-
-    // Calculate UI layout depending on vertical resolution
-    // Tytera MD380, MD-UV380
-    #if SCREEN_HEIGHT > 127
-
-    // Height and padding shown in diagram at beginning of file
-    const uint16_t top_h = 16;
-    const uint16_t top_pad = 4;
-    const uint16_t line1_h = 20;
-    const uint16_t line2_h = 20;
-    const uint16_t line3_h = 40;
-    const uint16_t menu_h = 16;
-    const uint16_t bottom_h = 20;
-    const uint16_t bottom_pad = top_pad;
-    const uint16_t status_v_pad = 2;
-    const uint16_t small_line_v_pad = 2;
-    const uint16_t big_line_v_pad = 6;
-    const uint16_t horizontal_pad = 4;
-
-    // Top bar font: 8 pt
-    const fontSize_t top_font = FONT_SIZE_8PT;
-    // Text line font: 8 pt
-    const fontSize_t line1_font = FONT_SIZE_8PT;
-    const fontSize_t line2_font = FONT_SIZE_8PT;
-    // Frequency line font: 16 pt
-    const fontSize_t line3_font = FONT_SIZE_16PT;
-    // Bottom bar font: 8 pt
-    const fontSize_t bottom_font = FONT_SIZE_8PT;
-    // TimeDate/Frequency input font
-    const fontSize_t input_font = FONT_SIZE_12PT;
-    // Menu font
-    const fontSize_t menu_font = FONT_SIZE_8PT;
-
-    // Radioddity GD-77
-    #elif SCREEN_HEIGHT > 63
-
-    // Height and padding shown in diagram at beginning of file
-    const uint16_t top_h = 11;
-    const uint16_t top_pad = 1;
-    const uint16_t line1_h = 10;
-    const uint16_t line2_h = 10;
-    const uint16_t line3_h = 16;
-    const uint16_t menu_h = 10;
-    const uint16_t bottom_h = 8;
-    const uint16_t bottom_pad = 0;
-    const uint16_t status_v_pad = 1;
-    const uint16_t small_line_v_pad = 1;
-    const uint16_t big_line_v_pad = 0;
-    const uint16_t horizontal_pad = 4;
-
-    // Top bar font: 6 pt
-    const fontSize_t top_font = FONT_SIZE_6PT;
-    // Middle line fonts: 5, 8, 8 pt
-    const fontSize_t line1_font = FONT_SIZE_6PT;
-    const fontSize_t line2_font = FONT_SIZE_6PT;
-    const fontSize_t line3_font = FONT_SIZE_10PT;
-    // Bottom bar font: 6 pt
-    const fontSize_t bottom_font = FONT_SIZE_6PT;
-    // TimeDate/Frequency input font
-    const fontSize_t input_font = FONT_SIZE_8PT;
-    // Menu font
-    const fontSize_t menu_font = FONT_SIZE_6PT;
-
-    // Radioddity RD-5R
-    #elif SCREEN_HEIGHT > 47
-
-    // Height and padding shown in diagram at beginning of file
-    const uint16_t top_h = 11;
-    const uint16_t top_pad = 1;
-    const uint16_t line1_h = 0;
-    const uint16_t line2_h = 10;
-    const uint16_t line3_h = 18;
-    const uint16_t menu_h = 10;
-    const uint16_t bottom_h = 0;
-    const uint16_t bottom_pad = 0;
-    const uint16_t status_v_pad = 1;
-    const uint16_t small_line_v_pad = 1;
-    const uint16_t big_line_v_pad = 0;
-    const uint16_t horizontal_pad = 4;
-
-    // Top bar font: 8 pt
-    const fontSize_t top_font = FONT_SIZE_6PT;
-    // Middle line fonts: 16, 16
-    const fontSize_t line2_font = FONT_SIZE_6PT;
-    const fontSize_t line3_font = FONT_SIZE_12PT;
-    // TimeDate/Frequency input font
-    const fontSize_t input_font = FONT_SIZE_8PT;
-    // Menu font
-    const fontSize_t menu_font = FONT_SIZE_6PT;
-    // Not present on this resolution
-    const fontSize_t line1_font = 0;
-    const fontSize_t bottom_font = 0;
-
-    #else
-    #error Unsupported vertical resolution!
-    #endif
-
-    // Calculate printing positions
-    point_t top_pos    = {horizontal_pad, top_h - status_v_pad - text_v_offset};
-    point_t line1_pos  = {horizontal_pad, top_h + top_pad + line1_h - small_line_v_pad - text_v_offset};
-    point_t line2_pos  = {horizontal_pad, top_h + top_pad + line1_h + line2_h - small_line_v_pad - text_v_offset};
-    point_t line3_pos  = {horizontal_pad, top_h + top_pad + line1_h + line2_h + line3_h - big_line_v_pad - text_v_offset};
-    point_t bottom_pos = {horizontal_pad, SCREEN_HEIGHT - bottom_pad - status_v_pad - text_v_offset};
-
-    layout_t new_layout =
-    {
-        hline_h,
-        top_h,
-        line1_h,
-        line2_h,
-        line3_h,
-        menu_h,
-        bottom_h,
-        status_v_pad,
-        horizontal_pad,
-        text_v_offset,
-        top_pos,
-        line1_pos,
-        line2_pos,
-        line3_pos,
-        bottom_pos,
-        top_font,
-        line1_font,
-        line2_font,
-        line3_font,
-        bottom_font,
-        input_font,
-        menu_font
-    };
-    return new_layout;
-}
-
-
 void ui_init()
 {
     redraw_needed = true;
-    layout = _ui_calculateLayout();
-    layout_ready = true;
     // Initialize struct ui_state to all zeroes
     // This syntax is called compound literal
     // https://stackoverflow.com/questions/6891720/initialize-reset-struct-to-zero-null
     ui_state = (const struct ui_state_t){ 0 };
+    ui_state.main_redraw = true;
+    // Codeplug is (re)loaded, drop any cached entry name
+    _ui_listCacheInvalidate();
 }
 
 void ui_drawSplashScreen(bool centered)
@@ -500,10 +381,55 @@ int _ui_fsm_loadChannel(uint16_t zone_index, bool *sync_rtx) {
         // Copy channel read to state
         state.channel = channel;
         *sync_rtx = true;
+        state_publish(STATE_RADIO);
     }
     return result;
 }
 
+freq_t _ui_scope_start_freq(freq_t center, freq_t step)
+{
+    freq_t half = (SCOPE_POINTS / 2) * step;
+    freq_t span = (SCOPE_POINTS - 1) * step;
+    freq_t start = (center > half) ? (center - half) : 0;
+
+    // Keep the sweep inside the band of the center frequency
+    const hwInfo_t* hwinfo = platform_getHwInfo();
+    freq_t min = 0;
+    freq_t max = 0;
+    // hwInfo_t frequencies are in MHz
+    if(hwinfo->vhf_band &&
+       center >= ((freq_t) hwinfo->vhf_minFreq * 1000000) &&
+       center <= ((freq_t) hwinfo->vhf_maxFreq * 1000000))
+    {
+        min = (freq_t) hwinfo->vhf_minFreq * 1000000;
+        max = (freq_t) hwinfo->vhf_maxFreq * 1000000;
+    }
+    else if(hwinfo->uhf_band &&
+            center >= ((freq_t) hwinfo->uhf_minFreq * 1000000) &&
+            center <= ((freq_t) hwinfo->uhf_maxFreq * 1000000))
+    {
+        min = (freq_t) hwinfo->uhf_minFreq * 1000000;
+        max = (freq_t) hwinfo->uhf_maxFreq * 1000000;
+    }
+
+    if(max == 0) return start;
+    if((start + span) > max) start = (max > span) ? (max - span) : 0;
+    if(start < min) start = min;
+    return start;
+}
+
+void _ui_fsm_startBandScope() {
+    // Sweep centered on current RX frequency
+    bandScopeCfg_t cfg;
+    cfg.points = SCOPE_POINTS;
+    cfg.step = scope_steps[ui_state.scope_step];
+    cfg.startFreq = _ui_scope_start_freq(state.channel.rx_frequency, cfg.step);
+    cfg.dwellTime = 10;
+    rtx_startBandScope(&cfg);
+    ui_state.scope_count = 0;
+    ui_state.scope_redraw = true;
+}
+
 void _ui_fsm_confirmVFOInput(bool *sync_rtx) {
     // Switch to TX input
     if(ui_state.input_set == SET_RX)
@@ -527,6 +453,7 @@ void _ui_fsm_confirmVFOInput(bool *sync_rtx) {
             state.channel.rx_frequency = ui_state.new_rx_frequency;
             state.channel.tx_frequency = ui_state.new_tx_frequency;
             *sync_rtx = true;
+            state_publish(STATE_RADIO);
         }
         state.ui_screen = MAIN_VFO;
     }
@@ -570,6 +497,7 @@ void _ui_fsm_insertVFONumber(kbd_msg_t msg, bool *sync_rtx) {
                 state.channel.rx_frequency = ui_state.new_rx_frequency;
                 state.channel.tx_frequency = ui_state.new_tx_frequency;
                 *sync_rtx = true;
+                state_publish(STATE_RADIO);
             }
             state.ui_screen = MAIN_VFO;
         }
@@ -585,6 +513,7 @@ void _ui_changeBrightness(int variation)
         state.settings.brightness =
         (state.settings.brightness < -variation) ? 0 : state.settings.brightness + variation;
     platform_setBacklightLevel(state.settings.brightness);
+    state_publish(STATE_SETTINGS);
 }
 
 void _ui_changeContrast(int variation)
@@ -596,6 +525,7 @@ void _ui_changeContrast(int variation)
         state.settings.contrast =
         (state.settings.contrast < -variation) ? 0 : state.settings.contrast + variation;
     display_setContrast(state.settings.contrast);
+    state_publish(STATE_SETTINGS);
 }
 
 void _ui_fsm_menuMacro(kbd_msg_t msg, bool *sync_rtx) {
@@ -611,6 +541,7 @@ void _ui_fsm_menuMacro(kbd_msg_t msg, bool *sync_rtx) {
             state.channel.fm.txTone %= MAX_TONE_INDEX;
             state.channel.fm.rxTone = state.channel.fm.txTone;
             *sync_rtx = true;
+            state_publish(STATE_RADIO);
             break;
         case 2:
             tone_flags++;
@@ -620,6 +551,7 @@ void _ui_fsm_menuMacro(kbd_msg_t msg, bool *sync_rtx) {
             state.channel.fm.txToneEn = tone_tx_enable;
             state.channel.fm.rxToneEn = tone_rx_enable;
             *sync_rtx = true;
+            state_publish(STATE_RADIO);
             break;
         case 3:
             if (state.channel.power == 1.0f)
@@ -627,11 +559,13 @@ void _ui_fsm_menuMacro(kbd_msg_t msg, bool *sync_rtx) {
             else
                 state.channel.power = 1.0f;
             *sync_rtx = true;
+            state_publish(STATE_RADIO);
             break;
         case 4:
             state.channel.bandwidth++;
             state.channel.bandwidth %= 3;
             *sync_rtx = true;
+            state_publish(STATE_RADIO);
             break;
         case 5:
             if(state.channel.mode == FM)
@@ -639,6 +573,7 @@ void _ui_fsm_menuMacro(kbd_msg_t msg, bool *sync_rtx) {
             else if(state.channel.mode == DMR)
                 state.channel.mode = FM;
             *sync_rtx = true;
+            state_publish(STATE_RADIO);
             break;
         case 7:
             _ui_changeBrightness(+25);
@@ -652,16 +587,19 @@ void _ui_fsm_menuMacro(kbd_msg_t msg, bool *sync_rtx) {
     if(msg.keys & KNOB_LEFT || msg.keys & KNOB_RIGHT) {
         state.sqlLevel = platform_getChSelector() - 1;
         *sync_rtx = true;
+        state_publish(STATE_RADIO);
     }
 #else // Use left and right buttons or relative position knob
     // NOTE: Use up and down for UV380 which has not yet a functional knob
     if(msg.keys & KEY_LEFT || msg.keys & KEY_DOWN || msg.keys & KNOB_LEFT) {
         state.sqlLevel = (state.sqlLevel == 0) ? 0 : state.sqlLevel - 1;
         *sync_rtx = true;
+        state_publish(STATE_RADIO);
     }
     else if(msg.keys & KEY_RIGHT || msg.keys & KEY_UP || msg.keys & KNOB_RIGHT) {
         state.sqlLevel = (state.sqlLevel == 15) ? 15 : state.sqlLevel + 1;
         *sync_rtx = true;
+        state_publish(STATE_RADIO);
     }
 #endif
 }
@@ -699,7 +637,49 @@ void _ui_menuBack(uint8_t prev_state)
 
 void ui_saveState()
 {
-    last_state = state;
+    (void) state_snapshot(&last_state, last_versions);
+}
+
+uint32_t ui_getTopics()
+{
+    // Battery is always needed for the low battery check
+    uint32_t topics = TOPIC_MASK(TOPIC_BATTERY);
+
+    switch(last_state.ui_screen)
+    {
+        case MAIN_VFO:
+        case MAIN_VFO_INPUT:
+        case MAIN_MEM:
+            topics |= TOPIC_MASK(TOPIC_TIME) | TOPIC_MASK(TOPIC_RSSI);
+            break;
+        case MENU_INFO:
+            topics |= TOPIC_MASK(TOPIC_RSSI);
+            break;
+        case MENU_GPS:
+            topics |= TOPIC_MASK(TOPIC_GPS);
+            break;
+        case MENU_BANDSCOPE:
+            topics |= TOPIC_MASK(TOPIC_BANDSCOPE);
+            break;
+        case SETTINGS_TIMEDATE:
+            topics |= TOPIC_MASK(TOPIC_TIME);
+            break;
+        default:
+            break;
+    }
+
+    // Macro menu shows the S-meter
+    if(macro_menu) topics |= TOPIC_MASK(TOPIC_RSSI);
+
+    return topics;
+}
+
+uint16_t ui_getRefreshPeriod()
+{
+    // Profiler entries are refreshed once per second
+    if(last_state.ui_screen == MENU_INFO) return 1000;
+
+    return 0;
 }
 
 void ui_updateFSM(event_t event, bool *sync_rtx)
@@ -724,6 +704,7 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
         {
             state.ui_screen = MAIN_VFO;
             state.emergency = true;
+            state_publish(STATE_RADIO);
         }
         return;
     }
@@ -757,6 +738,7 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                         state.channel.rx_frequency += 12500;
                         state.channel.tx_frequency += 12500;
                         *sync_rtx = true;
+                        state_publish(STATE_RADIO);
                     }
                 }
                 else if(msg.keys & KEY_DOWN || msg.keys & KNOB_LEFT)
@@ -768,6 +750,7 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                         state.channel.rx_frequency -= 12500;
                         state.channel.tx_frequency -= 12500;
                         *sync_rtx = true;
+                        state_publish(STATE_RADIO);
                     }
                 }
                 else if(msg.keys & KEY_ENTER)
@@ -781,6 +764,7 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                 {
                     // Save VFO channel
                     state.vfo_channel = state.channel;
+                    state_publish(STATE_RADIO);
                     int result = _ui_fsm_loadChannel(state.channel_index, sync_rtx);
                     // Read successful and channel is valid
                     if(result != -1)
@@ -845,6 +829,7 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                     state.channel = state.vfo_channel;
                     // Update RTX configuration
                     *sync_rtx = true;
+                    state_publish(STATE_RADIO);
                     // Switch to VFO screen
                     state.ui_screen = MAIN_VFO;
                 }
@@ -881,6 +866,10 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                             state.ui_screen = MENU_GPS;
                             break;
 #endif
+                        case M_BANDSCOPE:
+                            state.ui_screen = MENU_BANDSCOPE;
+                            _ui_fsm_startBandScope();
+                            break;
                         case M_SETTINGS:
                             state.ui_screen = MENU_SETTINGS;
                             break;
@@ -908,28 +897,19 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                     _ui_menuUp(1);
                 else if(msg.keys & KEY_DOWN || msg.keys & KNOB_RIGHT)
                 {
+                    // Names are looked up through the menu name cache,
+                    // reading past the end of the list fails
+                    char name[MAX_ENTRY_LEN];
+                    int  result = -1;
+                    uint16_t next = ui_state.menu_selected + 1;
                     if(state.ui_screen == MENU_ZONE)
-                    {
-                        zone_t zone;
-                        // menu_selected is 0-based while channels are 1-based
-                        // menu_selected == 0 corresponds to "All Channels" zone
-                        if(nvm_readZoneData(&zone, ui_state.menu_selected + 1) != -1)
-                            ui_state.menu_selected += 1;
-                    }
+                        result = _ui_getZoneName(name, sizeof(name), next);
                     else if(state.ui_screen == MENU_CHANNEL)
-                    {
-                        channel_t channel;
-                        // menu_selected is 0-based while channels are 1-based
-                        if(nvm_readChannelData(&channel, ui_state.menu_selected + 2) != -1)
-                            ui_state.menu_selected += 1;
-                    }
+                        result = _ui_getChannelName(name, sizeof(name), next);
                     else if(state.ui_screen == MENU_CONTACTS)
-                    {
-                        contact_t contact;
-                        // menu_selected is 0-based while channels are 1-based
-                        if(nvm_readContactData(&contact, ui_state.menu_selected + 2) != -1)
-                            ui_state.menu_selected += 1;
-                    }
+                        result = _ui_getContactName(name, sizeof(name), next);
+                    if(result != -1)
+                        ui_state.menu_selected += 1;
                 }
                 else if(msg.keys & KEY_ENTER)
                 {
@@ -945,12 +925,14 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                             state.zone_enabled = true;
                             result = nvm_readZoneData(&newzone, ui_state.menu_selected);
                         }
+                        state_publish(STATE_RADIO);
                         if(result != -1)
                         {
                             state.zone = newzone;
                             // If we were in VFO mode, save VFO channel
                             if(ui_state.last_main_state == MAIN_VFO)
                                 state.vfo_channel = state.channel;
+                            state_publish(STATE_RADIO);
                             // Load zone first channel
                             _ui_fsm_loadChannel(1, sync_rtx);
                             // Switch to MEM screen
@@ -961,7 +943,10 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                     {
                         // If we were in VFO mode, save VFO channel
                         if(ui_state.last_main_state == MAIN_VFO)
+                        {
                             state.vfo_channel = state.channel;
+                            state_publish(STATE_RADIO);
+                        }
                         _ui_fsm_loadChannel(ui_state.menu_selected + 1, sync_rtx);
                         // Switch to MEM screen
                         state.ui_screen = MAIN_MEM;
@@ -1013,9 +998,9 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
             // Info menu screen
             case MENU_INFO:
                 if(msg.keys & KEY_UP || msg.keys & KNOB_LEFT)
-                    _ui_menuUp(info_num);
+                    _ui_menuUp(info_num + 1 + prof_getThreadCount());
                 else if(msg.keys & KEY_DOWN || msg.keys & KNOB_RIGHT)
-                    _ui_menuDown(info_num);
+                    _ui_menuDown(info_num + 1 + prof_getThreadCount());
                 else if(msg.keys & KEY_ESC)
                     _ui_menuBack(MENU_TOP);
                 break;
@@ -1024,6 +1009,26 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                 if(msg.keys & KEY_ESC)
                     _ui_menuBack(MENU_TOP);
                 break;
+            // Band scope screen
+            case MENU_BANDSCOPE:
+                if(msg.keys & KEY_UP || msg.keys & KNOB_RIGHT)
+                {
+                    if(ui_state.scope_step < scope_steps_num - 1)
+                        ui_state.scope_step += 1;
+                    _ui_fsm_startBandScope();
+                }
+                else if(msg.keys & KEY_DOWN || msg.keys & KNOB_LEFT)
+                {
+                    if(ui_state.scope_step > 0)
+                        ui_state.scope_step -= 1;
+                    _ui_fsm_startBandScope();
+                }
+                else if(msg.keys & KEY_ESC)
+                {
+                    rtx_stopBandScope();
+                    _ui_menuBack(MENU_TOP);
+                }
+                break;
 #ifdef HAS_RTC
             // Time&Date settings screen
             case SETTINGS_TIMEDATE:
@@ -1146,6 +1151,7 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
                         default:
                             state.ui_screen = SETTINGS_GPS;
                     }
+                    state_publish(STATE_SETTINGS);
                 }
                 else if(msg.keys & KEY_UP || msg.keys & KNOB_LEFT)
                     _ui_menuUp(settings_gps_num);
@@ -1163,17 +1169,18 @@ void ui_updateFSM(event_t event, bool *sync_rtx)
 
 void ui_updateGUI()
 {
-    if(!layout_ready)
+    // Screens updated incrementally need a full redraw when entered
+    if(last_state.ui_screen != ui_state.drawn_screen)
     {
-        layout = _ui_calculateLayout();
-        layout_ready = true;
+        ui_state.drawn_screen = last_state.ui_screen;
+        ui_state.main_redraw  = true;
     }
     // Draw current GUI page
     switch(last_state.ui_screen)
     {
         // VFO main screen
         case MAIN_VFO:
-            _ui_drawMainVFO();
+            _ui_drawMainVFO(&ui_state);
             break;
         // VFO frequency input screen
         case MAIN_VFO_INPUT:
@@ -1181,7 +1188,7 @@ void ui_updateGUI()
             break;
         // MEM main screen
         case MAIN_MEM:
-            _ui_drawMainMEM();
+            _ui_drawMainMEM(&ui_state);
             break;
         // Top menu screen
         case MENU_TOP:
@@ -1217,6 +1224,10 @@ void ui_updateGUI()
         case MENU_ABOUT:
             _ui_drawMenuAbout();
             break;
+        // Band scope screen
+        case MENU_BANDSCOPE:
+            _ui_drawMenuBandScope(&ui_state);
+            break;
 #ifdef HAS_RTC
         // Time&Date settings screen
         case SETTINGS_TIMEDATE:
@@ -1246,9 +1257,17 @@ void ui_updateGUI()
     if(macro_menu) {
         _ui_drawDarkOverlay();
         _ui_drawMacroMenu(&last_state);
+        // Incrementally updated screens need a full redraw after the overlay
+        ui_state.scope_redraw = true;
+        ui_state.main_redraw  = true;
     }
 }
 
+void ui_prefetch()
+{
+    _ui_prefetchMenuList(last_state.ui_screen, ui_state.menu_selected);
+}
+
 void ui_terminate()
 {
 }
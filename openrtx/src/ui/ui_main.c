@@ -28,10 +28,140 @@
  *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
  ***************************************************************************/
 
-#include <stdio.h>
 #include <stdint.h>
 #include <ui.h>
 #include <string.h>
+#include <format.h>
+
+/*
+ * Retained widgets of the main VFO and MEM screens. Each widget keeps the value
+ * it was last drawn with and the screen area it covers: when the screen is
+ * already displayed, only the widgets whose value changed are cleared and drawn
+ * again, so that only their areas are marked as modified and sent to the
+ * display by gfx_render(). On small screens text lines can overlap by a few
+ * pixels: widgets intersecting a cleared area are drawn again in a second pass.
+ */
+#define WIDGET_VALUE_LEN 24
+
+enum
+{
+    WIDGET_MODE = 0,
+    WIDGET_CLOCK,
+    WIDGET_BATTERY,
+    WIDGET_ZONE,
+    WIDGET_CHANNEL,
+    WIDGET_FREQUENCY,
+    WIDGET_SMETER,
+    WIDGET_NUM
+};
+
+typedef struct
+{
+    point_t  start;                     // Area covered at the last draw
+    uint16_t width;
+    uint16_t height;
+    uint8_t  len;                       // Value length, zero if not drawn
+    bool     redraw;                    // Partially cleared by another widget
+    uint8_t  value[WIDGET_VALUE_LEN];   // Value at the last draw
+}
+widget_t;
+
+static widget_t widgets[WIDGET_NUM];
+
+/**
+ * Check if a widget has to be drawn with a new value. If so, the area covered
+ * by the widget is cleared and the new value is saved.
+ *
+ * @param id: widget identifier.
+ * @param value: value to be shown by the widget.
+ * @param len: length of the value, in bytes.
+ * @return true if the widget has to be drawn.
+ */
+static bool _ui_widgetChanged(uint8_t id, const void *value, uint8_t len)
+{
+    widget_t *w = &widgets[id];
+    if(len > WIDGET_VALUE_LEN) len = WIDGET_VALUE_LEN;
+    bool changed = (w->len != len) || (memcmp(w->value, value, len) != 0);
+    if((!changed) && (!w->redraw)) return false;
+
+    w->redraw = false;
+    if(!changed) return true;
+
+    if((w->len != 0) && (w->width != 0))
+    {
+        gfx_drawRect(w->start, w->width, w->height, color_black, true);
+
+        // Widgets drawn in the cleared area have to be drawn again
+        for(uint8_t i = 0; i < WIDGET_NUM; i++)
+        {
+            widget_t *o = &widgets[i];
+            if((i == id) || (o->len == 0) || (o->width == 0)) continue;
+            if((o->start.x < w->start.x + w->width)  &&
+               (w->start.x < o->start.x + o->width)  &&
+               (o->start.y < w->start.y + w->height) &&
+               (w->start.y < o->start.y + o->height))
+                o->redraw = true;
+        }
+    }
+
+    memcpy(w->value, value, len);
+    w->len = len;
+    return true;
+}
+
+/**
+ * Check if some widget has been partially cleared and needs to be drawn again.
+ */
+static bool _ui_widgetsPending()
+{
+    for(uint8_t i = 0; i < WIDGET_NUM; i++)
+    {
+        if(widgets[i].redraw) return true;
+    }
+
+    return false;
+}
+
+/**
+ * Print the text of a widget and save the area it covers.
+ *
+ * @param id: widget identifier.
+ * @param pos: text position, as given to gfx_print().
+ * @param font: text font.
+ * @param alignment: text alignment.
+ * @param text: text to be printed.
+ */
+static void _ui_drawWidgetText(uint8_t id, point_t pos, fontSize_t font,
+                               textAlign_t alignment, const char *text)
+{
+    widget_t *w = &widgets[id];
+    gfx_printBuffer(pos, font, alignment, color_white, text);
+
+    // Area covered by the glyphs actually drawn, so that clearing it does not
+    // touch the neighbouring widgets.
+    point_t size = gfx_getTextBox(pos, font, alignment, text, &w->start);
+    w->width     = size.x;
+    w->height    = size.y;
+}
+
+/**
+ * Update a text widget, drawing it only if its text changed.
+ */
+static void _ui_updateWidgetText(uint8_t id, point_t pos, fontSize_t font,
+                                 textAlign_t alignment, const char *text)
+{
+    if(_ui_widgetChanged(id, text, strlen(text)))
+        _ui_drawWidgetText(id, pos, font, alignment, text);
+}
+
+/**
+ * Force a full redraw of all the widgets, to be called after the screen has
+ * been cleared.
+ */
+static void _ui_resetWidgets()
+{
+    memset(widgets, 0x00, sizeof(widgets));
+}
 
 void _ui_drawMainBackground()
 {
@@ -43,61 +173,97 @@ void _ui_drawMainBackground()
 
 void _ui_drawMainTop()
 {
+    char buf[WIDGET_VALUE_LEN];
+
 #ifdef HAS_RTC
     // Print clock on top bar
     curTime_t local_time = state_getLocalTime(last_state.time);
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
-              color_white, "%02d:%02d:%02d", local_time.hour,
-              local_time.minute, local_time.second);
+    fmt_time(buf, sizeof(buf), local_time);
+    _ui_updateWidgetText(WIDGET_CLOCK, layout.top_pos, layout.top_font,
+                         TEXT_ALIGN_CENTER, buf);
 #endif
     // If the radio has no built-in battery, print input voltage
 #ifdef BAT_NONE
-    gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_RIGHT,
-              color_white,"%.1fV", last_state.v_bat);
+    size_t len = fmt_decimal(buf, sizeof(buf), last_state.v_bat, 3, 1);
+    fmt_string(buf + len, sizeof(buf) - len, "V", 1);
+    _ui_updateWidgetText(WIDGET_BATTERY, layout.top_pos, layout.top_font,
+                         TEXT_ALIGN_RIGHT, buf);
 #else
     // Otherwise print battery icon on top bar, use 4 px padding
     uint16_t bat_width = SCREEN_WIDTH / 9;
     uint16_t bat_height = layout.top_h - (layout.status_v_pad * 2);
     point_t bat_pos = {SCREEN_WIDTH - bat_width - layout.horizontal_pad,
                        layout.status_v_pad};
-    gfx_drawBattery(bat_pos, bat_width, bat_height, last_state.charge);
+    if(_ui_widgetChanged(WIDGET_BATTERY, &last_state.charge,
+                         sizeof(last_state.charge)))
+    {
+        gfx_drawBattery(bat_pos, bat_width, bat_height, last_state.charge);
+        // Battery button is one pixel past the icon width
+        widgets[WIDGET_BATTERY].start  = bat_pos;
+        widgets[WIDGET_BATTERY].width  = bat_width + 1;
+        widgets[WIDGET_BATTERY].height = bat_height;
+    }
 #endif
     // Print radio mode on top bar
+    const char *mode = "";
     switch(last_state.channel.mode)
     {
         case FM:
-        gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_LEFT,
-                  color_white, "FM");
+        mode = "FM";
         break;
         case DMR:
-        gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_LEFT,
-                  color_white, "DMR");
+        mode = "DMR";
         break;
     }
+    _ui_updateWidgetText(WIDGET_MODE, layout.top_pos, layout.top_font,
+                         TEXT_ALIGN_LEFT, mode);
 }
 
 void _ui_drawZoneChannel()
 {
+    char buf[WIDGET_VALUE_LEN];
+
     // Print Zone name
+    size_t len = fmt_string(buf, sizeof(buf), "zone: ", 6);
     if(!last_state.zone_enabled)
-        gfx_print(layout.line1_pos, layout.line1_font, TEXT_ALIGN_LEFT,
-                  color_white, "zone: All channels");
+        fmt_string(buf + len, sizeof(buf) - len, "All channels", 12);
     else
-        gfx_print(layout.line1_pos, layout.line1_font, TEXT_ALIGN_LEFT,
-                  color_white,  "zone: %.13s", last_state.zone.name);
+        fmt_string(buf + len, sizeof(buf) - len, last_state.zone.name, 13);
+    _ui_updateWidgetText(WIDGET_ZONE, layout.line1_pos, layout.line1_font,
+                         TEXT_ALIGN_LEFT, buf);
     // Print Channel name
-    gfx_print(layout.line2_pos, layout.line2_font, TEXT_ALIGN_LEFT,
-              color_white, "  %03d: %.12s",
-              last_state.channel_index, last_state.channel.name);
+    len  = fmt_string(buf, sizeof(buf), "  ", 2);
+    len += fmt_unsigned(buf + len, sizeof(buf) - len,
+                        last_state.channel_index, 3, '0');
+    len += fmt_string(buf + len, sizeof(buf) - len, ": ", 2);
+    fmt_string(buf + len, sizeof(buf) - len, last_state.channel.name, 12);
+    _ui_updateWidgetText(WIDGET_CHANNEL, layout.line2_pos, layout.line2_font,
+                         TEXT_ALIGN_LEFT, buf);
 }
 
 void _ui_drawFrequency()
 {
+    char buf[WIDGET_VALUE_LEN];
+
     // Print big numbers frequency
-    gfx_print(layout.line3_pos, layout.line3_font, TEXT_ALIGN_CENTER,
-              color_white, "%03lu.%05lu",
-              (unsigned long)last_state.channel.rx_frequency/1000000,
-              (unsigned long)last_state.channel.rx_frequency%1000000/10);
+    fmt_frequency(buf, sizeof(buf), last_state.channel.rx_frequency);
+    _ui_updateWidgetText(WIDGET_FREQUENCY, layout.line3_pos, layout.line3_font,
+                         TEXT_ALIGN_CENTER, buf);
+}
+
+/**
+ * Print a frequency of the VFO input screen, preceded by its label.
+ *
+ * @param pos: text position.
+ * @param label: frequency label, four characters.
+ * @param freq: frequency to be printed.
+ */
+static void _ui_drawInputFrequency(point_t pos, const char *label, freq_t freq)
+{
+    char buf[16];
+    size_t len = fmt_string(buf, sizeof(buf), label, 4);
+    fmt_frequency(buf + len, sizeof(buf) - len, freq);
+    gfx_printBuffer(pos, layout.input_font, TEXT_ALIGN_CENTER, color_white, buf);
 }
 
 void _ui_drawVFOMiddleInput(ui_state_t* ui_state)
@@ -111,10 +277,8 @@ void _ui_drawVFOMiddleInput(ui_state_t* ui_state)
     {
         if(ui_state->input_position == 0)
         {
-            gfx_print(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ">Rx:%03lu.%05lu",
-                      (unsigned long)ui_state->new_rx_frequency/1000000,
-                      (unsigned long)ui_state->new_rx_frequency%1000000/10);
+            _ui_drawInputFrequency(layout.line2_pos, ">Rx:",
+                                   ui_state->new_rx_frequency);
         }
         else
         {
@@ -122,35 +286,31 @@ void _ui_drawVFOMiddleInput(ui_state_t* ui_state)
             if(ui_state->input_position == 1)
                 strcpy(ui_state->new_rx_freq_buf, ">Rx:___._____");
             ui_state->new_rx_freq_buf[insert_pos] = input_char;
-            gfx_print(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ui_state->new_rx_freq_buf);
+            gfx_printBuffer(layout.line2_pos, layout.input_font,
+                            TEXT_ALIGN_CENTER, color_white,
+                            ui_state->new_rx_freq_buf);
         }
-        gfx_print(layout.line3_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                  color_white, " Tx:%03lu.%05lu",
-                  (unsigned long)last_state.channel.tx_frequency/1000000,
-                  (unsigned long)last_state.channel.tx_frequency%1000000/10);
+        _ui_drawInputFrequency(layout.line3_pos, " Tx:",
+                               last_state.channel.tx_frequency);
     }
     else if(ui_state->input_set == SET_TX)
     {
-        gfx_print(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                  color_white, " Rx:%03lu.%05lu",
-                  (unsigned long)ui_state->new_rx_frequency/1000000,
-                  (unsigned long)ui_state->new_rx_frequency%1000000/10);
+        _ui_drawInputFrequency(layout.line2_pos, " Rx:",
+                               ui_state->new_rx_frequency);
         // Replace Rx frequency with underscorses
         if(ui_state->input_position == 0)
         {
-            gfx_print(layout.line3_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ">Tx:%03lu.%05lu",
-                      (unsigned long)ui_state->new_rx_frequency/1000000,
-                      (unsigned long)ui_state->new_rx_frequency%1000000/10);
+            _ui_drawInputFrequency(layout.line3_pos, ">Tx:",
+                                   ui_state->new_rx_frequency);
         }
         else
         {
             if(ui_state->input_position == 1)
                 strcpy(ui_state->new_tx_freq_buf, ">Tx:___._____");
             ui_state->new_tx_freq_buf[insert_pos] = input_char;
-            gfx_print(layout.line3_pos, layout.input_font, TEXT_ALIGN_CENTER,
-                      color_white, ui_state->new_tx_freq_buf);
+            gfx_printBuffer(layout.line3_pos, layout.input_font,
+                            TEXT_ALIGN_CENTER, color_white,
+                            ui_state->new_tx_freq_buf);
         }
     }
 }
@@ -165,35 +325,73 @@ void _ui_drawBottom()
                            layout.status_v_pad +
                            layout.text_v_offset -
                            layout.bottom_h };
+    uint16_t smeter_h = layout.bottom_h - 1;
+
+    float value[] = {rssi, squelch};
+    if(!_ui_widgetChanged(WIDGET_SMETER, value, sizeof(value))) return;
+
     gfx_drawSmeter(smeter_pos,
                    SCREEN_WIDTH - 2 * layout.horizontal_pad,
-                   layout.bottom_h - 1,
+                   smeter_h,
                    rssi,
                    squelch,
                    color_white);
+
+    // S-meter spans the whole width, from the top of the S-level numbers
+    // printed above its start point to the level marks below its bars
+    uint8_t font_h = gfx_getFontHeight(FONT_SIZE_5PT);
+    widget_t *w = &widgets[WIDGET_SMETER];
+    w->start.x  = 0;
+    w->start.y  = (smeter_pos.y > font_h) ? (smeter_pos.y - font_h) : 0;
+    w->width    = SCREEN_WIDTH;
+    w->height   = smeter_pos.y + smeter_h + 1 - w->start.y;
+    if(w->start.y + w->height > SCREEN_HEIGHT)
+        w->height = SCREEN_HEIGHT - w->start.y;
 }
 
-void _ui_drawMainVFO()
+void _ui_drawMainVFO(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
-    _ui_drawMainTop();
-    _ui_drawFrequency();
-    _ui_drawBottom();
+    // Clear the screen only when entering it, then update the changed widgets
+    if(ui_state->main_redraw)
+    {
+        gfx_clearScreen();
+        _ui_resetWidgets();
+        ui_state->main_redraw = false;
+    }
+
+    do
+    {
+        _ui_drawMainTop();
+        _ui_drawFrequency();
+        _ui_drawBottom();
+    }
+    while(_ui_widgetsPending());
 }
 
 void _ui_drawMainVFOInput(ui_state_t* ui_state)
 {
     gfx_clearScreen();
+    _ui_resetWidgets();
     _ui_drawMainTop();
     _ui_drawVFOMiddleInput(ui_state);
     _ui_drawBottom();
 }
 
-void _ui_drawMainMEM()
+void _ui_drawMainMEM(ui_state_t* ui_state)
 {
-    gfx_clearScreen();
-    _ui_drawMainTop();
-    _ui_drawZoneChannel();
-    _ui_drawFrequency();
-    _ui_drawBottom();
+    if(ui_state->main_redraw)
+    {
+        gfx_clearScreen();
+        _ui_resetWidgets();
+        ui_state->main_redraw = false;
+    }
+
+    do
+    {
+        _ui_drawMainTop();
+        _ui_drawZoneChannel();
+        _ui_drawFrequency();
+        _ui_drawBottom();
+    }
+    while(_ui_widgetsPending());
 }
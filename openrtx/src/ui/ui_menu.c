@@ -32,15 +32,18 @@
 #include <stdint.h>
 #include <string.h>
 #include <ui.h>
+#include <format.h>
+#include <rtx.h>
+#include <profiler.h>
 #include <interfaces/nvmem.h>
 #include <interfaces/platform.h>
 
-void _ui_drawMenuList(uint8_t selected, int (*getCurrentEntry)(char *buf, uint8_t max_len, uint8_t index))
+void _ui_drawMenuList(uint16_t selected, int (*getCurrentEntry)(char *buf, uint8_t max_len, uint16_t index))
 {
     point_t pos = layout.line1_pos;
     // Number of menu entries that fit in the screen height
-    uint8_t entries_in_screen = (SCREEN_HEIGHT - 1 - pos.y) / layout.menu_h + 1;
-    uint8_t scroll = 0;
+    uint16_t entries_in_screen = (SCREEN_HEIGHT - 1 - pos.y) / layout.menu_h + 1;
+    uint16_t scroll = 0;
     char entry_buf[MAX_ENTRY_LEN] = "";
     color_t text_color = color_white;
     for(int item=0, result=0; (result == 0) && (pos.y < SCREEN_HEIGHT); item++)
@@ -60,20 +63,20 @@ void _ui_drawMenuList(uint8_t selected, int (*getCurrentEntry)(char *buf, uint8_
                 point_t rect_pos = {0, pos.y - layout.menu_h + 3};
                 gfx_drawRect(rect_pos, SCREEN_WIDTH, layout.menu_h, color_white, true);
             }
-            gfx_print(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
+            gfx_printBuffer(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
             pos.y += layout.menu_h;
         }
     }
 }
 
-void _ui_drawMenuListValue(ui_state_t* ui_state, uint8_t selected,
-                           int (*getCurrentEntry)(char *buf, uint8_t max_len, uint8_t index),
-                           int (*getCurrentValue)(char *buf, uint8_t max_len, uint8_t index))
+void _ui_drawMenuListValue(ui_state_t* ui_state, uint16_t selected,
+                           int (*getCurrentEntry)(char *buf, uint8_t max_len, uint16_t index),
+                           int (*getCurrentValue)(char *buf, uint8_t max_len, uint16_t index))
 {
     point_t pos = layout.line1_pos;
     // Number of menu entries that fit in the screen height
-    uint8_t entries_in_screen = (SCREEN_HEIGHT - 1 - pos.y) / layout.menu_h + 1;
-    uint8_t scroll = 0;
+    uint16_t entries_in_screen = (SCREEN_HEIGHT - 1 - pos.y) / layout.menu_h + 1;
+    uint16_t scroll = 0;
     char entry_buf[MAX_ENTRY_LEN] = "";
     char value_buf[MAX_ENTRY_LEN] = "";
     color_t text_color = color_white;
@@ -103,35 +106,35 @@ void _ui_drawMenuListValue(ui_state_t* ui_state, uint8_t selected,
                 point_t rect_pos = {0, pos.y - layout.menu_h + 3};
                 gfx_drawRect(rect_pos, SCREEN_WIDTH, layout.menu_h, color_white, full_rect);
             }
-            gfx_print(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
-            gfx_print(pos, layout.menu_font, TEXT_ALIGN_RIGHT, text_color, value_buf);
+            gfx_printBuffer(pos, layout.menu_font, TEXT_ALIGN_LEFT, text_color, entry_buf);
+            gfx_printBuffer(pos, layout.menu_font, TEXT_ALIGN_RIGHT, text_color, value_buf);
             pos.y += layout.menu_h;
         }
     }
 }
 
-int _ui_getMenuTopEntryName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getMenuTopEntryName(char *buf, uint8_t max_len, uint16_t index)
 {
     if(index >= menu_num) return -1;
     snprintf(buf, max_len, "%s", menu_items[index]);
     return 0;
 }
 
-int _ui_getSettingsEntryName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getSettingsEntryName(char *buf, uint8_t max_len, uint16_t index)
 {
     if(index >= settings_num) return -1;
     snprintf(buf, max_len, "%s", settings_items[index]);
     return 0;
 }
 
-int _ui_getDisplayEntryName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getDisplayEntryName(char *buf, uint8_t max_len, uint16_t index)
 {
     if(index >= display_num) return -1;
     snprintf(buf, max_len, "%s", display_items[index]);
     return 0;
 }
 
-int _ui_getDisplayValueName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getDisplayValueName(char *buf, uint8_t max_len, uint16_t index)
 {
     if(index >= display_num) return -1;
     uint8_t value = 0;
@@ -151,14 +154,14 @@ int _ui_getDisplayValueName(char *buf, uint8_t max_len, uint8_t index)
 }
 
 #ifdef HAS_GPS
-int _ui_getSettingsGPSEntryName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getSettingsGPSEntryName(char *buf, uint8_t max_len, uint16_t index)
 {
     if(index >= settings_gps_num) return -1;
     snprintf(buf, max_len, "%s", settings_gps_items[index]);
     return 0;
 }
 
-int _ui_getSettingsGPSValueName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getSettingsGPSValueName(char *buf, uint8_t max_len, uint16_t index)
 {
     if(index >= settings_gps_num) return -1;
     switch(index)
@@ -181,17 +184,40 @@ int _ui_getSettingsGPSValueName(char *buf, uint8_t max_len, uint8_t index)
 }
 #endif
 
-int _ui_getInfoEntryName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getInfoEntryName(char *buf, uint8_t max_len, uint16_t index)
 {
-    if(index >= info_num) return -1;
-    snprintf(buf, max_len, "%s", info_items[index]);
+    // Profiler entries follow the fixed ones: heap first, then the threads
+    profThread_t thread;
+    if(index < info_num)
+        snprintf(buf, max_len, "%s", info_items[index]);
+    else if(index == info_num)
+        snprintf(buf, max_len, "Heap");
+    else if(prof_getThreadInfo(index - info_num - 1, &thread))
+        snprintf(buf, max_len, "%s", thread.name);
+    else
+        return -1;
     return 0;
 }
 
-int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getInfoValueName(char *buf, uint8_t max_len, uint16_t index)
 {
     const hwInfo_t* hwinfo = platform_getHwInfo();
-    if(index >= info_num) return -1;
+    if(index == info_num)
+    {
+        profHeap_t heap = prof_getHeapInfo();
+        snprintf(buf, max_len, "%lu/%lu", (unsigned long) heap.used,
+                                          (unsigned long) heap.size);
+        return 0;
+    }
+    else if(index > info_num)
+    {
+        profThread_t thread;
+        if(!prof_getThreadInfo(index - info_num - 1, &thread)) return -1;
+        snprintf(buf, max_len, "%d%% %lu/%lu", thread.cpuLoad,
+                 (unsigned long) thread.stackUsed,
+                 (unsigned long) thread.stackSize);
+        return 0;
+    }
     switch(index)
     {
         case 0: // Git Version
@@ -199,18 +225,20 @@ int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
             break;
         case 1: // Battery voltage
         {
-            // Compute integer part and mantissa of voltage value, adding 50mV
-            // to mantissa for rounding to nearest integer
-            uint16_t volt  = last_state.v_bat / 1000;
-            uint16_t mvolt = ((last_state.v_bat - volt * 1000) + 50) / 100;
-            snprintf(buf, max_len, "%d.%dV", volt, mvolt);
+            // Voltage is in mV, print it rounded to tenths of volt
+            size_t len = fmt_decimal(buf, max_len, last_state.v_bat, 3, 1);
+            fmt_string(buf + len, max_len - len, "V", 1);
         }
             break;
         case 2: // Battery charge
             snprintf(buf, max_len, "%d%%", last_state.charge);
             break;
         case 3: // RSSI
-            snprintf(buf, max_len, "%.1fdBm", last_state.rssi);
+        {
+            int32_t rssi = (int32_t) (last_state.rssi * 100.0f);
+            size_t  len  = fmt_decimal(buf, max_len, rssi, 2, 1);
+            fmt_string(buf + len, max_len - len, "dBm", 3);
+        }
             break;
         case 4: // Model
             snprintf(buf, max_len, "%s", hwinfo->name);
@@ -231,40 +259,189 @@ int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
     return 0;
 }
 
-int _ui_getZoneName(char *buf, uint8_t max_len, uint8_t index)
+/*
+ * Small LRU cache of the names of zones, channels and contacts, which are
+ * otherwise read back from the nonvolatile memory for each visible list entry
+ * at every redraw. Failed reads are cached too, as they mark the end of a list.
+ */
+#define NAME_CACHE_SIZE 24
+#define NAME_LEN        sizeof(((channel_t *) 0)->name)
+
+enum
+{
+    LIST_ZONES = 0,
+    LIST_CHANNELS,
+    LIST_CONTACTS,
+    LIST_NUM
+};
+
+typedef struct
+{
+    uint32_t stamp;             // Last use, zero when the entry is empty
+    uint16_t index;             // Menu index of the entry
+    uint8_t  list;              // List the entry belongs to
+    int8_t   result;            // Result of the memory read
+    char     name[NAME_LEN + 1];
+}
+nameCacheEntry_t;
+
+static nameCacheEntry_t nameCache[NAME_CACHE_SIZE];
+static uint32_t cacheStamp = 0;
+static uint16_t lastSelected[LIST_NUM];
+
+static int _ui_readListName(char *name, uint8_t list, uint16_t index)
+{
+    int result = -1;
+
+    // Menu indices are 0-based, zones are 1-based with the "All channels"
+    // entry at index 0, channels and contacts are 1-based.
+    switch(list)
+    {
+        case LIST_ZONES:
+        {
+            zone_t zone;
+            result = nvm_readZoneData(&zone, index);
+            if(result != -1) fmt_string(name, NAME_LEN + 1, zone.name,
+                                        NAME_LEN);
+        }
+            break;
+
+        case LIST_CHANNELS:
+        {
+            channel_t channel;
+            result = nvm_readChannelData(&channel, index + 1);
+            if(result != -1) fmt_string(name, NAME_LEN + 1, channel.name,
+                                        NAME_LEN);
+        }
+            break;
+
+        case LIST_CONTACTS:
+        {
+            contact_t contact;
+            result = nvm_readContactData(&contact, index + 1);
+            if(result != -1) fmt_string(name, NAME_LEN + 1, contact.name,
+                                        NAME_LEN);
+        }
+            break;
+    }
+
+    return result;
+}
+
+static nameCacheEntry_t *_ui_getCachedName(uint8_t list, uint16_t index)
+{
+    nameCacheEntry_t *victim = &nameCache[0];
+
+    for(uint8_t i = 0; i < NAME_CACHE_SIZE; i++)
+    {
+        nameCacheEntry_t *entry = &nameCache[i];
+        if((entry->stamp != 0) && (entry->list == list) &&
+           (entry->index == index))
+        {
+            entry->stamp = ++cacheStamp;
+            return entry;
+        }
+
+        if(entry->stamp < victim->stamp) victim = entry;
+    }
+
+    victim->list   = list;
+    victim->index  = index;
+    victim->name[0] = '\0';
+    victim->result = _ui_readListName(victim->name, list, index);
+    victim->stamp  = ++cacheStamp;
+    return victim;
+}
+
+/**
+ * Load in the name cache the page of entries following the visible ones in
+ * the direction the list is being scrolled, when not already there.
+ *
+ * @param list: list being drawn.
+ * @param selected: currently selected entry.
+ */
+static void _ui_prefetchNames(uint8_t list, uint16_t selected)
+{
+    uint16_t entries_in_screen = (SCREEN_HEIGHT - 1 - layout.line1_pos.y)
+                               / layout.menu_h + 1;
+    uint16_t last = lastSelected[list];
+    lastSelected[list] = selected;
+
+    if(selected > last)
+    {
+        // The visible page ends with the selected entry once scrolled
+        uint16_t first = selected + 1;
+        if(selected < entries_in_screen) first = entries_in_screen;
+        for(uint16_t i = first; i < first + entries_in_screen; i++)
+        {
+            if(_ui_getCachedName(list, i)->result == -1) break;
+        }
+    }
+    else if((selected < last) && (selected >= entries_in_screen))
+    {
+        // Entries above the top of the visible page
+        uint16_t top   = selected - entries_in_screen + 1;
+        uint16_t first = (top > entries_in_screen) ? (top - entries_in_screen)
+                                                   : 0;
+        for(uint16_t i = first; i < top; i++)
+            (void) _ui_getCachedName(list, i);
+    }
+}
+
+void _ui_prefetchMenuList(uint8_t screen, uint16_t selected)
+{
+    switch(screen)
+    {
+        case MENU_ZONE:
+            _ui_prefetchNames(LIST_ZONES, selected);
+            break;
+
+        case MENU_CHANNEL:
+            _ui_prefetchNames(LIST_CHANNELS, selected);
+            break;
+
+        case MENU_CONTACTS:
+            _ui_prefetchNames(LIST_CONTACTS, selected);
+            break;
+    }
+}
+
+void _ui_listCacheInvalidate()
+{
+    memset(nameCache, 0x00, sizeof(nameCache));
+    memset(lastSelected, 0x00, sizeof(lastSelected));
+    cacheStamp = 0;
+}
+
+static int _ui_getListName(char *buf, uint8_t max_len, uint8_t list,
+                           uint16_t index)
+{
+    nameCacheEntry_t *entry = _ui_getCachedName(list, index);
+    if(entry->result != -1)
+        snprintf(buf, max_len, "%s", entry->name);
+    return entry->result;
+}
+
+int _ui_getZoneName(char *buf, uint8_t max_len, uint16_t index)
 {
-    int result = 0;
     // First zone "All channels" is not read from flash
     if(index == 0)
     {
         snprintf(buf, max_len, "All channels");
+        return 0;
     }
-    else
-    {
-        zone_t zone;
-        result = nvm_readZoneData(&zone, index);
-        if(result != -1)
-            snprintf(buf, max_len, "%s", zone.name);
-    }
-    return result;
+
+    return _ui_getListName(buf, max_len, LIST_ZONES, index);
 }
 
-int _ui_getChannelName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getChannelName(char *buf, uint8_t max_len, uint16_t index)
 {
-    channel_t channel;
-    int result = nvm_readChannelData(&channel, index + 1);
-    if(result != -1)
-        snprintf(buf, max_len, "%s", channel.name);
-    return result;
+    return _ui_getListName(buf, max_len, LIST_CHANNELS, index);
 }
 
-int _ui_getContactName(char *buf, uint8_t max_len, uint8_t index)
+int _ui_getContactName(char *buf, uint8_t max_len, uint16_t index)
 {
-    contact_t contact;
-    int result = nvm_readContactData(&contact, index + 1);
-    if(result != -1)
-        snprintf(buf, max_len, "%s", contact.name);
-    return result;
+    return _ui_getListName(buf, max_len, LIST_CONTACTS, index);
 }
 
 void _ui_drawMenuTop(ui_state_t* ui_state)
@@ -437,6 +614,57 @@ void _ui_drawMenuAbout()
     }
 }
 
+void _ui_drawMenuBandScope(ui_state_t* ui_state)
+{
+    bandScopeStats_t scope = rtx_getBandScopeStats();
+    uint16_t points = SCOPE_POINTS;
+    uint16_t first = ui_state->scope_count % points;
+    uint32_t count = scope.count - ui_state->scope_count;
+    point_t graph_pos = {0, layout.top_h + 1};
+    uint16_t graph_h = layout.bottom_pos.y - layout.bottom_h - graph_pos.y;
+
+    // Redraw the whole screen only when needed, otherwise update only the
+    // bars of the points acquired since last draw and the status line
+    if(ui_state->scope_redraw)
+    {
+        gfx_clearScreen();
+        // Print "Band Scope" on top bar
+        gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
+                  color_white, "Band Scope");
+        first = 0;
+        count = points;
+        ui_state->scope_redraw = false;
+    }
+    else
+    {
+        point_t status_pos = {0, layout.bottom_pos.y - layout.bottom_h};
+        gfx_drawRect(status_pos, SCREEN_WIDTH, SCREEN_HEIGHT - status_pos.y,
+                     color_black, true);
+    }
+
+    // Sweep restarted since last draw, refresh all the bars
+    if((scope.count < ui_state->scope_count) || (count > points))
+    {
+        first = 0;
+        count = points;
+    }
+
+    gfx_drawBandScope(graph_pos, SCREEN_WIDTH, graph_h, rtx_getBandScopeData(),
+                      points, first, count, yellow_fab413);
+    ui_state->scope_count = scope.count;
+
+    // Step in kHz and sweep rate
+    char buf[24];
+    size_t len = fmt_decimal(buf, sizeof(buf), scope_steps[ui_state->scope_step],
+                             3, 1);
+    len += fmt_string(buf + len, sizeof(buf) - len, "kHz ", 4);
+    len += fmt_unsigned(buf + len, sizeof(buf) - len,
+                        (uint32_t) scope.pointsPerSec, 0, ' ');
+    fmt_string(buf + len, sizeof(buf) - len, "pt/s", 4);
+    gfx_printBuffer(layout.bottom_pos, layout.bottom_font, TEXT_ALIGN_CENTER,
+                    color_white, buf);
+}
+
 void _ui_drawSettingsDisplay(ui_state_t* ui_state)
 {
     gfx_clearScreen();
@@ -471,12 +699,13 @@ void _ui_drawSettingsTimeDate()
     gfx_print(layout.top_pos, layout.top_font, TEXT_ALIGN_CENTER,
               color_white, "Time&Date");
     // Print current time and date
-    gfx_print(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
-              color_white, "%02d/%02d/%02d",
-              local_time.date, local_time.month, local_time.year);
-    gfx_print(layout.line3_pos, layout.input_font, TEXT_ALIGN_CENTER,
-              color_white, "%02d:%02d:%02d",
-              local_time.hour, local_time.minute, local_time.second);
+    char buf[9];
+    fmt_date(buf, sizeof(buf), local_time);
+    gfx_printBuffer(layout.line2_pos, layout.input_font, TEXT_ALIGN_CENTER,
+                    color_white, buf);
+    fmt_time(buf, sizeof(buf), local_time);
+    gfx_printBuffer(layout.line3_pos, layout.input_font, TEXT_ALIGN_CENTER,
+                    color_white, buf);
 }
 
 void _ui_drawSettingsTimeDateSet(ui_state_t* ui_state)
@@ -32,6 +32,8 @@
 #include <interfaces/gpio.h>
 #include <interfaces/delays.h>
 #include <hwconfig.h>
+#include <trace.h>
+#include <probe.h>
 #include <stdint.h>
 #include <I2C0.h>
 
@@ -50,6 +52,8 @@ void AT24Cx_terminate()
 
 }
 
+static PROBE_DEFINE(flashRead);
+
 void AT24Cx_readData(uint32_t addr, void* buf, size_t len)
 {
     uint16_t a = __builtin_bswap16((uint16_t) addr);
@@ -59,10 +63,14 @@ void AT24Cx_readData(uint32_t addr, void* buf, size_t len)
      * so we have to acquire exclusive ownership before exchanging data
      */
     i2c0_lockDeviceBlocking();
+    TRACE_BEGIN("AT24Cx_readData");
+    PROBE_BEGIN(flashRead);
 
     i2c0_write(devAddr, &a, 2, false);
     delayUs(10);
     i2c0_read(devAddr, buf, len);
 
+    PROBE_END(flashRead);
+    TRACE_END("AT24Cx_readData");
     i2c0_releaseDevice();
 }
@@ -35,6 +35,8 @@
 #include <hwconfig.h>
 #include <interfaces/gpio.h>
 #include <interfaces/delays.h>
+#include <trace.h>
+#include <probe.h>
 
 #define CMD_WRITE 0x02   /* Read data              */
 #define CMD_READ  0x03   /* Read data              */
@@ -115,8 +117,13 @@ ssize_t W25Qx_readSecurityRegister(uint32_t addr, void* buf, size_t len)
     return ((ssize_t) readLen);
 }
 
+static PROBE_DEFINE(flashRead);
+
 void W25Qx_readData(uint32_t addr, void* buf, size_t len)
 {
+    TRACE_BEGIN("W25Qx_readData");
+    PROBE_BEGIN(flashRead);
+
     gpio_clearPin(FLASH_CS);
     (void) spiFlash_SendRecv(CMD_READ);             /* Command        */
     (void) spiFlash_SendRecv((addr >> 16) & 0xFF);  /* Address high   */
@@ -129,6 +136,9 @@ void W25Qx_readData(uint32_t addr, void* buf, size_t len)
     }
 
     gpio_setPin(FLASH_CS);
+
+    PROBE_END(flashRead);
+    TRACE_END("W25Qx_readData");
 }
 
 bool W25Qx_eraseSector(uint32_t addr)
@@ -29,17 +29,38 @@
  ***************************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <interfaces/nvmem.h>
-
-// Simulate CPS with 16 channels, 16 zones, 16 contacts
-const uint32_t maxNumZones = 16;
-const uint32_t maxNumChannels = 16;
-const uint32_t maxNumContacts = 16;
+#include <interfaces/delays.h>
+#include <trace.h>
+
+/*
+ * Simulate CPS with 16 channels, 16 zones, 16 contacts. A larger synthetic
+ * codeplug can be requested by setting the OPENRTX_NVM_ENTRIES environment
+ * variable to the number of entries of each kind, while OPENRTX_NVM_DELAY_US
+ * emulates the time taken by each read of the external flash.
+ */
+static uint32_t maxNumZones    = 16;
+static uint32_t maxNumChannels = 16;
+static uint32_t maxNumContacts = 16;
+static uint32_t readDelay      = 0;
 const freq_t dummy_base_freq = 145500000;
 
 void nvm_init()
 {
+    const char *entries = getenv("OPENRTX_NVM_ENTRIES");
+    const char *delay   = getenv("OPENRTX_NVM_DELAY_US");
+
+    if(entries != NULL)
+    {
+        uint32_t num   = strtoul(entries, NULL, 10);
+        maxNumZones    = num;
+        maxNumChannels = num;
+        maxNumContacts = num;
+    }
+
+    if(delay != NULL) readDelay = strtoul(delay, NULL, 10);
 }
 
 void nvm_terminate()
@@ -62,11 +83,14 @@ int nvm_readChannelData(channel_t *channel, uint16_t pos)
 {
     if((pos <= 0) || (pos > maxNumChannels)) return -1;
 
+    TRACE_BEGIN("nvm_readChannelData");
+    if(readDelay > 0) delayUs(readDelay);
     /* Generate dummy channel name */
     snprintf(channel->name, 16, "Channel %d", pos);
     /* Generate dummy frequency values */
     channel->rx_frequency = dummy_base_freq + pos * 100000;
     channel->tx_frequency = dummy_base_freq + pos * 100000;
+    TRACE_END("nvm_readChannelData");
 
     return 0;
 }
@@ -75,6 +99,8 @@ int nvm_readZoneData(zone_t *zone, uint16_t pos)
 {
     if((pos <= 0) || (pos > maxNumZones)) return -1;
 
+    TRACE_BEGIN("nvm_readZoneData");
+    if(readDelay > 0) delayUs(readDelay);
     /* Generate dummy zone name */
     snprintf(zone->name, 16, "Zone %d", pos);
     memset(zone->member, 0, sizeof(zone->member));
@@ -82,6 +108,7 @@ int nvm_readZoneData(zone_t *zone, uint16_t pos)
     zone->member[0] = pos;
     zone->member[1] = pos+1;
     zone->member[2] = pos+2;
+    TRACE_END("nvm_readZoneData");
     return 0;
 }
 
@@ -89,8 +116,11 @@ int nvm_readContactData(contact_t *contact, uint16_t pos)
 {
     if((pos <= 0) || (pos > maxNumContacts)) return -1;
 
+    TRACE_BEGIN("nvm_readContactData");
+    if(readDelay > 0) delayUs(readDelay);
     /* Generate dummy contact name */
     snprintf(contact->name, 16, "Contact %d", pos);
+    TRACE_END("nvm_readContactData");
 
     return 0;
 }
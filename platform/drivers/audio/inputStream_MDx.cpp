@@ -33,6 +33,7 @@
 #include <toneGenerator_MDx.h>
 #include <interfaces/gpio.h>
 #include <hwconfig.h>
+#include <trace.h>
 #include <stdbool.h>
 #include <miosix.h>
 
@@ -48,6 +49,8 @@ uint8_t         bufMode   = BUF_LINEAR;  // Buffer management mode.
 
 void __attribute__((used)) DmaHandlerImpl()
 {
+    TRACE_ISR("adc_dma");
+
     if(DMA2->LISR & (DMA_LISR_TCIF2 | DMA_LISR_HTIF2))
     {
         switch(bufMode)
@@ -243,6 +246,8 @@ dataBlock_t inputStream_getData(streamId id)
 {
     (void) id;
 
+    TRACE_BEGIN("inputStream_getData");
+
     if(bufMode == BUF_LINEAR)
     {
         // Reload DMA configuration then start DMA and ADC, stopped in ISR
@@ -275,6 +280,7 @@ dataBlock_t inputStream_getData(streamId id)
     block.len  = bufLen;
     if(bufMode == BUF_CIRC_DOUBLE) block.len /= 2;
 
+    TRACE_END("inputStream_getData");
     return block;
 }
 
@@ -51,6 +51,30 @@ enum opstatus radioStatus;        // Current operating status
 HR_C6000& C6000  = HR_C6000::instance();  // HR_C5000 driver
 AT1846S& at1846s = AT1846S::instance();   // AT1846S driver
 
+/**
+ * \internal
+ * Program the AT1846S analog squelch threshold, interpolated from calibration
+ * data for the current RX frequency.
+ */
+void _setSqlThreshold()
+{
+    const bandCalData_t *cal = &(calData->data[currRxBand]);
+
+    uint8_t sqlTresh = 0;
+    if(currRxBand == BND_VHF)
+    {
+        sqlTresh = interpCalParameter(config->rxFrequency, calData->vhfCalPoints,
+                                      cal->analogSqlThresh, 8);
+    }
+    else
+    {
+        sqlTresh = interpCalParameter(config->rxFrequency, calData->uhfCalPoints,
+                                      cal->analogSqlThresh, 8);
+    }
+
+    at1846s.setAnalogSqlThresh(sqlTresh);
+}
+
 void radio_init(const rtxStatus_t *rtxState)
 {
     /*
@@ -266,19 +290,7 @@ void radio_updateConfiguration()
 
     C6000.writeCfgRegister(0x37, cal->digAudioGain);    // DACDATA gain
 
-    uint8_t sqlTresh = 0;
-    if(currRxBand == BND_VHF)
-    {
-        sqlTresh = interpCalParameter(config->rxFrequency, calData->vhfCalPoints,
-                                      cal->analogSqlThresh, 8);
-    }
-    else
-    {
-        sqlTresh = interpCalParameter(config->rxFrequency, calData->uhfCalPoints,
-                                      cal->analogSqlThresh, 8);
-    }
-
-    at1846s.setAnalogSqlThresh(sqlTresh);
+    _setSqlThreshold();
 
     /*
      * Parameters dependent on TX frequency only
@@ -348,6 +360,20 @@ void radio_updateConfiguration()
     if(radioStatus == TX) radio_enableTx();
 }
 
+void radio_updateRxFrequency()
+{
+    // Band change requires reloading calibration parameters, do a full update
+    if(getBandFromFrequency(config->rxFrequency) != currRxBand)
+    {
+        radio_updateConfiguration();
+        return;
+    }
+
+    // Squelch threshold is calibrated along the band, follow the new frequency
+    _setSqlThreshold();
+    if(radioStatus == RX) at1846s.setFrequency(config->rxFrequency);
+}
+
 float radio_getRssi()
 {
     return static_cast< float >(at1846s.readRSSI());
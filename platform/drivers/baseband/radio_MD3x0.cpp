@@ -381,6 +381,15 @@ void radio_updateConfiguration()
     if(radioStatus == TX) radio_enableTx();
 }
 
+void radio_updateRxFrequency()
+{
+    // Only the tuning voltage of the RX input filter depends on RX frequency
+    vtune_rx = interpCalParameter(config->rxFrequency, calData->rxFreq,
+                                  calData->rxSensitivity, 9);
+
+    if(radioStatus == RX) radio_enableRx();
+}
+
 float radio_getRssi()
 {
     /*
@@ -76,6 +76,11 @@ void radio_updateConfiguration()
 
 }
 
+void radio_updateRxFrequency()
+{
+
+}
+
 float radio_getRssi()
 {
     return -154.0f;
@@ -324,6 +324,18 @@ void radio_updateConfiguration()
     if(radioStatus == TX) radio_enableTx();
 }
 
+void radio_updateRxFrequency()
+{
+    // Band change requires reloading calibration parameters, do a full update
+    if(getBandFromFrequency(config->rxFrequency) != currRxBand)
+    {
+        radio_updateConfiguration();
+        return;
+    }
+
+    if(radioStatus == RX) at1846s.setFrequency(config->rxFrequency);
+}
+
 float radio_getRssi()
 {
     return static_cast< float > (at1846s.readRSSI());
@@ -29,12 +29,15 @@
  ***************************************************************************/
 
 #include <interfaces/radio.h>
+#include <emulator.h>
 #include <cstdio>
 #include <string>
 
+const rtxStatus_t *config;      // Pointer to data structure with radio configuration
+
 void radio_init(const rtxStatus_t *rtxState)
 {
-    (void) rtxState;
+    config = rtxState;
     puts("radio_linux: init() called");
 }
 
@@ -87,11 +90,35 @@ void radio_updateConfiguration()
     puts("radio_linux: updateConfiguration() called");
 }
 
+void radio_updateRxFrequency()
+{
+    // Called at high rate by frequency hopping functions, keep it quiet
+}
+
 float radio_getRssi()
 {
-    // Commented to reduce verbosity on Linux
-    // printf("radio_linux: requested RSSI at freq %d, returning -100dBm\n", rxFreq);
-    return -100.0f;
+    /*
+     * Simulated RSSI: strongest emulated carrier falling inside the current
+     * RX channel, or the noise floor set from the emulator CLI.
+     */
+    float rssi = Radio_State.RSSI;
+    if(config == NULL) return rssi;
+
+    int32_t halfBw = 6250;
+    if(config->bandwidth == BW_20) halfBw = 10000;
+    if(config->bandwidth == BW_25) halfBw = 12500;
+
+    for(int i = 0; i < EMU_MAX_CARRIERS; i++)
+    {
+        const carrier_t *c = &Radio_State.carriers[i];
+        if(c->frequency == 0) continue;
+
+        int32_t delta = static_cast< int32_t >(c->frequency - config->rxFrequency);
+        if((delta < -halfBw) || (delta > halfBw)) continue;
+        if(c->rssi > rssi) rssi = c->rssi;
+    }
+
+    return rssi;
 }
 
 enum opstatus radio_getStatus()
@@ -97,17 +97,20 @@
 
 /*
  * LCD framebuffer, dynamically allocated.
- * Pixel format is RGB565, 16 bit per pixel
+ * Pixel format is RGB565, 16 bit per pixel, stored big endian as expected by
+ * the display controller.
  */
 static uint16_t *frameBuffer;
 
 using namespace miosix;
 Thread *lcdWaiting = 0;
+static volatile bool transferActive = false;
 
 void __attribute__((used)) DmaImpl()
 {
     DMA2->HIFCR |= DMA_HIFCR_CTCIF7 | DMA_HIFCR_CTEIF7;    /* Clear flags */
     gpio_setPin(LCD_CS);
+    transferActive = false;
 
     if(lcdWaiting == 0) return;
     lcdWaiting->IRQwakeup();
@@ -444,6 +447,7 @@ void display_init()
 
 void display_terminate()
 {
+    display_waitRender();
     free(frameBuffer);
 
     /* Shut off FSMC and deallocate framebuffer */
@@ -451,12 +455,13 @@ void display_terminate()
     __DSB();
 }
 
-void display_renderRows(uint8_t startRow, uint8_t endRow)
+/**
+ * \internal
+ * Put screen data lines back to alternate function mode, since they are in
+ * common with keyboard buttons and the keyboard driver sets them as inputs.
+ */
+static void restoreDataLines()
 {
-    /*
-     * Put screen data lines back to alternate function mode, since they are in
-     * common with keyboard buttons and the keyboard driver sets them as inputs.
-     */
     gpio_setMode(LCD_D0, ALTERNATE);
     gpio_setMode(LCD_D1, ALTERNATE);
     gpio_setMode(LCD_D2, ALTERNATE);
@@ -465,24 +470,15 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
     gpio_setMode(LCD_D5, ALTERNATE);
     gpio_setMode(LCD_D6, ALTERNATE);
     gpio_setMode(LCD_D7, ALTERNATE);
+}
 
-    gpio_clearPin(LCD_CS);
+void display_renderRows(uint8_t startRow, uint8_t endRow)
+{
+    /* Complete the previous transfer before touching the data lines */
+    display_waitRender();
+    restoreDataLines();
 
-    /*
-     * First of all, convert pixels from little to big endian, for
-     * compatibility with the display driver. We do this after having brought
-     * the CS pin low, in this way user code calling the renderingInProgress
-     * function gets true as return value and does not stomp our work.
-     */
-    for(uint8_t y = startRow; y < endRow; y++)
-    {
-        for(uint8_t x = 0; x < SCREEN_WIDTH; x++)
-        {
-            size_t pos = x + y * SCREEN_WIDTH;
-            uint16_t pixel = frameBuffer[pos];
-            frameBuffer[pos] = __builtin_bswap16(pixel);
-        }
-    }
+    gpio_clearPin(LCD_CS);
 
     /* Configure start and end rows in display driver */
     writeCmd(CMD_RASET);
@@ -504,6 +500,7 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
     DMA2_Stream7->PAR  = ((uint32_t ) frameBuffer + (startRow * SCREEN_WIDTH
                                                      * sizeof(uint16_t)));
     DMA2_Stream7->M0AR = LCD_FSMC_ADDR_DATA;
+    transferActive     = true;
     DMA2_Stream7->CR = DMA_SxCR_CHSEL         /* Channel 7                   */
                      | DMA_SxCR_PINC          /* Increment source pointer    */
                      | DMA_SxCR_DIR_1         /* Memory to memory            */
@@ -512,25 +509,88 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
                      | DMA_SxCR_EN;           /* Start transfer              */
 
     /*
-     * Put the calling thread in waiting status until render completes.
+     * Return without waiting: the transfer proceeds in background and the
+     * end-of-transfer interrupt releases the chip select.
+     */
+}
+
+void display_renderRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
+{
+    /*
+     * Full width sections are contiguous in the framebuffer and are sent via
+     * DMA.
      */
+    if((x0 == 0) && (x1 >= SCREEN_WIDTH))
     {
-        FastInterruptDisableLock dLock;
-        lcdWaiting = Thread::IRQgetCurrentThread();
-        do
+        display_renderRows(y0, y1);
+        return;
+    }
+
+    /*
+     * Narrower sections are written by the CPU, row by row, in a window set
+     * through the column and row address registers.
+     */
+    display_waitRender();
+    restoreDataLines();
+    gpio_clearPin(LCD_CS);
+
+    writeCmd(CMD_CASET);
+    writeData(0x00);
+    writeData(x0);
+    writeData(0x00);
+    writeData(x1 - 1);
+    writeCmd(CMD_RASET);
+    writeData(0x00);
+    writeData(y0);
+    writeData(0x00);
+    writeData(y1 - 1);
+    writeCmd(CMD_RAMWR);
+
+    for(uint8_t y = y0; y < y1; y++)
+    {
+        const uint8_t *row = (const uint8_t *) &frameBuffer[y * SCREEN_WIDTH];
+        for(uint16_t i = x0 * 2; i < x1 * 2; i++)
         {
-            Thread::IRQwait();
-            {
-                FastInterruptEnableLock eLock(dLock);
-                Thread::yield();
-            }
-        } while(lcdWaiting);
+            writeData(row[i]);
+        }
     }
+
+    /* Restore the full width window used by row rendering */
+    writeCmd(CMD_CASET);
+    writeData(0x00);
+    writeData(0x00);
+    writeData(0x00);
+    writeData(SCREEN_WIDTH);
+
+    gpio_setPin(LCD_CS);
 }
 
 void display_render()
 {
     display_renderRows(0, SCREEN_HEIGHT);
+    display_waitRender();
+}
+
+void display_waitRender()
+{
+    /*
+     * Put the calling thread in waiting status until render completes.
+     */
+    FastInterruptDisableLock dLock;
+    while(transferActive)
+    {
+        lcdWaiting = Thread::IRQgetCurrentThread();
+        Thread::IRQwait();
+        {
+            FastInterruptEnableLock eLock(dLock);
+            Thread::yield();
+        }
+    }
+}
+
+void display_frameDone()
+{
+    /* Frames are not tracked, nothing to do */
 }
 
 bool display_renderingInProgress()
@@ -40,7 +40,9 @@
 
 /*
  * LCD framebuffer, allocated on the heap by display_init().
- * Pixel format is black and white, one bit per pixel
+ * Pixel format is black and white, one bit per pixel, stored in the controller
+ * memory layout: one byte per column of each 8-pixel high page, topmost pixel
+ * in the least significant bit.
  */
 static uint8_t *frameBuffer;
 
@@ -99,30 +101,30 @@ void display_terminate()
     }
 }
 
-void display_renderRow(uint8_t row)
+/**
+ * \internal
+ * Send a portion of a framebuffer page to the controller. The framebuffer is
+ * already in the controller memory layout, thus data is sent as it is.
+ * Has to be called with the SPI bus locked and the chip select asserted.
+ *
+ * @param page: page index.
+ * @param x0: first column.
+ * @param x1: last column, excluded.
+ */
+static void display_renderPage(uint8_t page, uint8_t x0, uint8_t x1)
 {
-    /* magic stuff */
-    uint8_t *buf = (frameBuffer + 128 * row);
-    for (uint8_t i = 0; i<16; i++)
+    uint8_t col   = x0 + 4;                  /* Visible area starts at column 4 */
+    uint8_t *data = frameBuffer + (page * SCREEN_WIDTH);
+
+    gpio_clearPin(LCD_RS);                   /* RS low -> command mode */
+    (void) spi2_sendRecv(0xB0 | page);       /* Set Y position         */
+    (void) spi2_sendRecv(0x10 | (col >> 4)); /* Set X position         */
+    (void) spi2_sendRecv(col & 0x0F);
+    gpio_setPin(LCD_RS);                     /* RS high -> data mode   */
+
+    for(uint8_t x = x0; x < x1; x++)
     {
-        uint8_t tmp[8] = {0};
-        for (uint8_t j = 0; j < 8; j++)
-        {
-            uint8_t tmp_buf = buf[j*16 + i];
-            int count = __builtin_popcount(tmp_buf);
-            while (count > 0)
-            {
-                int pos = __builtin_ctz(tmp_buf);
-                tmp[pos] |= 1UL << j;
-                tmp_buf &= ~(1 << pos);
-                count--;
-            }
-        }
-
-        for (uint8_t s = 0; s < 8; s++)
-        {
-            (void) spi2_sendRecv(tmp[s]);
-        }
+        (void) spi2_sendRecv(data[x]);
     }
 }
 
@@ -131,14 +133,24 @@ void display_renderRows(uint8_t startRow, uint8_t endRow)
     spi2_lockDeviceBlocking();
     gpio_clearPin(LCD_CS);
 
-    for(uint8_t row = startRow; row < endRow; row++)
+    for(uint8_t page = startRow; page < endRow; page++)
+    {
+        display_renderPage(page, 0, SCREEN_WIDTH);
+    }
+
+    gpio_setPin(LCD_CS);
+    spi2_releaseDevice();
+}
+
+void display_renderRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
+{
+    spi2_lockDeviceBlocking();
+    gpio_clearPin(LCD_CS);
+
+    /* Display is updated by whole 8-pixel high pages */
+    for(uint8_t page = y0 / 8; page < (y1 + 7) / 8; page++)
     {
-        gpio_clearPin(LCD_RS);            /* RS low -> command mode */
-        (void) spi2_sendRecv(0xB0 | row); /* Set Y position         */
-        (void) spi2_sendRecv(0x10);       /* Set X position         */
-        (void) spi2_sendRecv(0x04);
-        gpio_setPin(LCD_RS);              /* RS high -> data mode   */
-        display_renderRow(row);
+        display_renderPage(page, x0, x1);
     }
 
     gpio_setPin(LCD_CS);
@@ -150,6 +162,16 @@ void display_render()
     display_renderRows(0, SCREEN_HEIGHT / 8);
 }
 
+void display_waitRender()
+{
+    /* Rendering is synchronous, nothing to wait for */
+}
+
+void display_frameDone()
+{
+    /* Frames are not tracked, nothing to do */
+}
+
 bool display_renderingInProgress()
 {
     return (gpio_readPin(LCD_CS) == 0);
@@ -0,0 +1,392 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Headless display driver for the linux target: the framebuffer is kept in
+ * memory and rendered frames are optionally captured to PPM or PNG files.
+ */
+
+#include <interfaces/display.h>
+#include <display_headless.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef SCREEN_WIDTH
+#define SCREEN_WIDTH 160
+#endif
+
+#ifndef SCREEN_HEIGHT
+#define SCREEN_HEIGHT 128
+#endif
+
+#if defined(PIX_FMT_BW)
+#define FB_SIZE (((SCREEN_HEIGHT + 7) / 8) * SCREEN_WIDTH)
+#elif defined(PIX_FMT_GRAYSC)
+#define FB_SIZE (SCREEN_HEIGHT * SCREEN_WIDTH)
+#else
+#define FB_SIZE (SCREEN_HEIGHT * SCREEN_WIDTH * 2)
+#endif
+
+static uint8_t        *frameBuffer;               /* Framebuffer              */
+static uint8_t        *lastCapture;               /* Last captured frame      */
+static char            captureDir[256];           /* Capture directory        */
+static bool            captureEnabled = false;
+static bool            captureChanged = false;    /* Only changed frames      */
+static bool            lastValid      = false;    /* lastCapture is valid     */
+static bool            framePending   = false;    /* Frame not yet completed  */
+static uint8_t         captureFormat  = CAPTURE_PPM;
+static headlessStats_t stats;
+
+/**
+ * @internal
+ * Fetch the pixel at position (x, y) from the framebuffer, converting it to
+ * 24 bit RGB.
+ */
+static void fetchPixel(unsigned int x, unsigned int y, uint8_t *rgb)
+{
+#if defined(PIX_FMT_BW)
+    /* UC1701/ST7567 page layout, topmost pixel in the least significant bit */
+    uint8_t px = (frameBuffer[x + (y / 8) * SCREEN_WIDTH] & (1 << (y % 8)))
+               ? 0xFF : 0x00;
+    rgb[0] = px;
+    rgb[1] = px;
+    rgb[2] = px;
+#elif defined(PIX_FMT_GRAYSC)
+    uint8_t px = frameBuffer[x + y * SCREEN_WIDTH];
+    rgb[0] = px;
+    rgb[1] = px;
+    rgb[2] = px;
+#else
+    /* RGB565, stored big endian */
+    const uint8_t *cell = &frameBuffer[(x + y * SCREEN_WIDTH) * 2];
+    uint16_t px = (cell[0] << 8) | cell[1];
+    uint8_t  r  = (px >> 11) & 0x1F;
+    uint8_t  g  = (px >> 5)  & 0x3F;
+    uint8_t  b  = px & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+#endif
+}
+
+/**
+ * @internal
+ * Update a CRC-32 (ISO-HDLC polynomial, as used by PNG) with a block of data.
+ */
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for(uint8_t k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (-(crc & 1)));
+    }
+
+    return ~crc;
+}
+
+/**
+ * @internal
+ * Write a big endian 32 bit value.
+ */
+static void putBe32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = value >> 24;
+    dst[1] = value >> 16;
+    dst[2] = value >> 8;
+    dst[3] = value;
+}
+
+/**
+ * @internal
+ * Write a PNG chunk, computing its CRC.
+ */
+static void writeChunk(FILE *fp, const char *type, const uint8_t *data,
+                       size_t len)
+{
+    uint8_t hdr[8];
+    putBe32(hdr, len);
+    memcpy(&hdr[4], type, 4);
+
+    uint32_t crc = crc32(0, &hdr[4], 4);
+    crc = crc32(crc, data, len);
+
+    uint8_t trailer[4];
+    putBe32(trailer, crc);
+
+    fwrite(hdr, 1, sizeof(hdr), fp);
+    fwrite(data, 1, len, fp);
+    fwrite(trailer, 1, sizeof(trailer), fp);
+}
+
+/**
+ * @internal
+ * Write the framebuffer as a PNG image. Image data is stored in a zlib stream
+ * made of uncompressed deflate blocks, to avoid depending on zlib.
+ */
+static bool writePng(FILE *fp)
+{
+    const size_t rowLen = 1 + (SCREEN_WIDTH * 3);   /* Filter byte + pixels */
+    const size_t rawLen = rowLen * SCREEN_HEIGHT;
+    const size_t blocks = (rawLen + 65534) / 65535;
+    const size_t zLen   = 2 + (blocks * 5) + rawLen + 4;
+
+    uint8_t *raw  = malloc(rawLen);
+    uint8_t *zbuf = malloc(zLen);
+    if((raw == NULL) || (zbuf == NULL))
+    {
+        free(raw);
+        free(zbuf);
+        return false;
+    }
+
+    for(unsigned int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        uint8_t *row = &raw[y * rowLen];
+        row[0] = 0;                                 /* No filter            */
+        for(unsigned int x = 0; x < SCREEN_WIDTH; x++)
+            fetchPixel(x, y, &row[1 + (x * 3)]);
+    }
+
+    /* zlib header, deflate with 32k window and no compression */
+    size_t pos = 0;
+    zbuf[pos++] = 0x78;
+    zbuf[pos++] = 0x01;
+
+    uint32_t s1 = 1;
+    uint32_t s2 = 0;
+    for(size_t done = 0; done < rawLen;)
+    {
+        size_t len = rawLen - done;
+        if(len > 65535) len = 65535;
+
+        zbuf[pos++] = ((done + len) == rawLen) ? 0x01 : 0x00;
+        zbuf[pos++] = len & 0xFF;
+        zbuf[pos++] = len >> 8;
+        zbuf[pos++] = ~len & 0xFF;
+        zbuf[pos++] = (~len >> 8) & 0xFF;
+        memcpy(&zbuf[pos], &raw[done], len);
+        pos += len;
+
+        for(size_t i = done; i < done + len; i++)
+        {
+            s1 = (s1 + raw[i]) % 65521;
+            s2 = (s2 + s1) % 65521;
+        }
+
+        done += len;
+    }
+
+    putBe32(&zbuf[pos], (s2 << 16) | s1);           /* Adler-32 checksum    */
+    pos += 4;
+
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n',
+                                        0x1A, '\n'};
+    uint8_t ihdr[13];
+    putBe32(&ihdr[0], SCREEN_WIDTH);
+    putBe32(&ihdr[4], SCREEN_HEIGHT);
+    ihdr[8]  = 8;                                   /* Bit depth            */
+    ihdr[9]  = 2;                                   /* Truecolor            */
+    ihdr[10] = 0;                                   /* Deflate              */
+    ihdr[11] = 0;                                   /* Adaptive filtering   */
+    ihdr[12] = 0;                                   /* No interlace         */
+
+    fwrite(signature, 1, sizeof(signature), fp);
+    writeChunk(fp, "IHDR", ihdr, sizeof(ihdr));
+    writeChunk(fp, "IDAT", zbuf, pos);
+    writeChunk(fp, "IEND", NULL, 0);
+
+    free(raw);
+    free(zbuf);
+    return true;
+}
+
+/**
+ * @internal
+ * Write the framebuffer as a binary PPM image.
+ */
+static bool writePpm(FILE *fp)
+{
+    fprintf(fp, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for(unsigned int y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for(unsigned int x = 0; x < SCREEN_WIDTH; x++)
+        {
+            uint8_t rgb[3];
+            fetchPixel(x, y, rgb);
+            fwrite(rgb, 1, sizeof(rgb), fp);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ * Account for a render call, the frame is captured once completed.
+ */
+static void areaRendered(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
+{
+    stats.renders += 1;
+    stats.rows    += y1 - y0;
+    stats.pixels  += (x1 - x0) * (y1 - y0);
+    framePending   = true;
+}
+
+
+
+void display_init()
+{
+    frameBuffer = malloc(FB_SIZE);
+    lastCapture = malloc(FB_SIZE);
+    if((frameBuffer == NULL) || (lastCapture == NULL))
+    {
+        printf("Headless display framebuffer allocation failed!\n");
+        return;
+    }
+
+    memset(frameBuffer, 0xFF, FB_SIZE);
+    memset(&stats, 0x00, sizeof(stats));
+
+    const char *dir    = getenv("OPENRTX_CAPTURE_DIR");
+    const char *format = getenv("OPENRTX_CAPTURE_FORMAT");
+    const char *change = getenv("OPENRTX_CAPTURE_CHANGED");
+    uint8_t fmt = ((format != NULL) && (strcmp(format, "png") == 0))
+                ? CAPTURE_PNG : CAPTURE_PPM;
+    headless_setCapture(dir, fmt, (change != NULL) && (strcmp(change, "1") == 0));
+}
+
+void display_terminate()
+{
+    printf("Headless display: %u frames, %u renders, %u rows, %u pixels, "
+           "%u frames captured\n", stats.frames, stats.renders, stats.rows,
+           stats.pixels, stats.captured);
+    free(frameBuffer);
+    free(lastCapture);
+}
+
+void display_renderRows(uint8_t startRow, uint8_t endRow)
+{
+#if defined(PIX_FMT_BW)
+    /* 1bpp framebuffer is organised in pages of eight pixel rows */
+    uint16_t y0 = startRow * 8;
+    uint16_t y1 = endRow * 8;
+#else
+    uint16_t y0 = startRow;
+    uint16_t y1 = endRow;
+#endif
+    if(y1 > SCREEN_HEIGHT) y1 = SCREEN_HEIGHT;
+    if(y0 >= y1) return;
+
+    areaRendered(0, y0, SCREEN_WIDTH, y1);
+}
+
+void display_renderRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
+{
+    areaRendered(x0, y0, x1, y1);
+}
+
+void display_render()
+{
+    areaRendered(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    display_frameDone();
+}
+
+void display_waitRender()
+{
+    /* Rendering is synchronous, nothing to wait for */
+}
+
+void display_frameDone()
+{
+    if(!framePending) return;
+
+    framePending = false;
+    stats.frames += 1;
+
+    if(!captureEnabled) return;
+
+    if(captureChanged)
+    {
+        if(lastValid && (memcmp(lastCapture, frameBuffer, FB_SIZE) == 0))
+            return;
+
+        memcpy(lastCapture, frameBuffer, FB_SIZE);
+        lastValid = true;
+    }
+
+    char path[sizeof(captureDir) + 32];
+    snprintf(path, sizeof(path), "%s/frame_%06u.%s", captureDir, stats.frames,
+             (captureFormat == CAPTURE_PNG) ? "png" : "ppm");
+    if(headless_saveFrame(path, captureFormat)) stats.captured += 1;
+}
+
+bool display_renderingInProgress()
+{
+    return false;
+}
+
+void *display_getFrameBuffer()
+{
+    return (void *) (frameBuffer);
+}
+
+void display_setContrast(uint8_t contrast)
+{
+    (void) contrast;
+}
+
+void headless_setCapture(const char *dir, uint8_t format, bool changedOnly)
+{
+    captureEnabled = (dir != NULL);
+    captureChanged = changedOnly;
+    captureFormat  = format;
+    lastValid      = false;
+
+    if(dir != NULL) snprintf(captureDir, sizeof(captureDir), "%s", dir);
+}
+
+bool headless_saveFrame(const char *path, uint8_t format)
+{
+    FILE *fp = fopen(path, "wb");
+    if(fp == NULL) return false;
+
+    bool ok = (format == CAPTURE_PNG) ? writePng(fp) : writePpm(fp);
+    if(fclose(fp) != 0) ok = false;
+
+    return ok;
+}
+
+headlessStats_t headless_getStats()
+{
+    return stats;
+}
@@ -35,6 +35,7 @@
  */
 
 #include <interfaces/display.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <SDL2/SDL.h>
@@ -67,6 +68,20 @@ SDL_Texture *displayTexture; /* SDL rendering surface  */
 void *frameBuffer;           /* Pointer to framebuffer */
 bool inProgress;             /* Flag to signal when rendering is in progress */
 
+/*
+ * Framebuffer content is copied to the SDL texture and presented by a
+ * dedicated thread, emulating the DMA transfer of the real devices: the
+ * rendering functions only post the area to be updated and return. SDL
+ * renderers can be used only by the thread which created them, thus the
+ * window, the renderer and the texture are owned by the presenter thread.
+ */
+static pthread_t       presenter;
+static pthread_mutex_t presentMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  presentCond  = PTHREAD_COND_INITIALIZER;
+static SDL_Rect        presentRect;
+static bool            presenterRunning = false;
+static bool            presenterReady   = false;
+
 /**
  * @internal
  * Internal helper function which fetches pixel at position (x, y) from framebuffer
@@ -79,12 +94,14 @@ uint32_t fetchPixelFromFb(__attribute__((unused)) unsigned int x,
 
 #ifdef PIX_FMT_BW
     /*
-     * Black and white 1bpp format: framebuffer is an array of uint8_t, where
-     * each cell contains the values of eight pixels, one per bit.
+     * Black and white 1bpp format, in the native layout of the UC1701 and
+     * ST7567 controllers: framebuffer is an array of uint8_t, organised in
+     * pages of eight pixel rows. Each cell contains the values of a column of
+     * eight pixels, the topmost one in the least significant bit.
      */
     uint8_t *fb = (uint8_t *)(frameBuffer);
-    unsigned int cell = (x + y*SCREEN_WIDTH) / 8;
-    unsigned int elem = (x + y*SCREEN_WIDTH) % 8;
+    unsigned int cell = x + (y / 8) * SCREEN_WIDTH;
+    unsigned int elem = y % 8;
     if(fb[cell] & (1 << elem)) pixel = 0xFFFFFFFF;
 #endif
 
@@ -101,6 +118,124 @@ uint32_t fetchPixelFromFb(__attribute__((unused)) unsigned int x,
     return pixel;
 }
 
+#ifdef PIX_FMT_RGB565
+/**
+ * @internal
+ * Internal helper function which copies a run of RGB565 pixels from the
+ * framebuffer to the SDL texture. Framebuffer stores pixels big endian, as
+ * expected by the display controllers of the real devices, while the
+ * SDL_PIXELFORMAT_RGB565 texture uses the byte order of the host.
+ */
+static void copyPixelsFromFb(uint16_t *dst, const uint16_t *src, size_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for(size_t i = 0; i < count; i++)
+        dst[i] = __builtin_bswap16(src[i]);
+#else
+    memcpy(dst, src, count * sizeof(uint16_t));
+#endif
+}
+#endif
+
+/**
+ * @internal
+ * Copy a rectangular section of the framebuffer to the SDL texture and present
+ * it on the screen.
+ */
+static void presentRectangle(const SDL_Rect *rect)
+{
+    PIXEL_SIZE *pixels;
+    int pitch = 0;
+    if (SDL_LockTexture(displayTexture, rect, (void **) &pixels, &pitch) < 0)
+    {
+        printf("SDL_lock failed: %s\n", SDL_GetError());
+        return;
+    }
+    for (int y = rect->y; y < rect->y + rect->h; y++)
+    {
+        PIXEL_SIZE *row = (PIXEL_SIZE *) ((uint8_t *) pixels + (y - rect->y) * pitch);
+#ifdef PIX_FMT_RGB565
+        uint16_t *fb = (uint16_t *) (frameBuffer);
+        copyPixelsFromFb(row, &fb[rect->x + y * SCREEN_WIDTH], rect->w);
+#else
+        for (int x = rect->x; x < rect->x + rect->w; x++)
+            row[x - rect->x] = fetchPixelFromFb(x, y);
+#endif
+    }
+    SDL_UnlockTexture(displayTexture);
+    SDL_RenderCopy(renderer, displayTexture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+}
+
+/**
+ * @internal
+ * Create the SDL window, together with its renderer and the texture holding
+ * the screen content.
+ */
+static void createWindow()
+{
+    window = SDL_CreateWindow("OpenRTX",
+                              SDL_WINDOWPOS_UNDEFINED,
+                              SDL_WINDOWPOS_UNDEFINED,
+                              SCREEN_WIDTH * 3, SCREEN_HEIGHT * 3,
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+
+    renderer = SDL_CreateRenderer(window, -1, 0);
+    SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+    displayTexture = SDL_CreateTexture(renderer, PIXEL_FORMAT, SDL_TEXTUREACCESS_STREAMING,
+                                       SCREEN_WIDTH, SCREEN_HEIGHT);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, displayTexture, NULL, NULL);
+    SDL_RenderPresent(renderer);
+}
+
+/**
+ * @internal
+ * Destroy the SDL window, its renderer and the texture.
+ */
+static void destroyWindow()
+{
+    SDL_DestroyTexture(displayTexture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+}
+
+/**
+ * @internal
+ * Presenter thread: creates the SDL window, then waits for a rendering request,
+ * serves it and signals its completion.
+ */
+static void *presenterThread(__attribute__((unused)) void *arg)
+{
+    createWindow();
+
+    pthread_mutex_lock(&presentMutex);
+    presenterReady = true;
+    pthread_cond_broadcast(&presentCond);
+
+    while (presenterRunning)
+    {
+        if (!inProgress)
+        {
+            pthread_cond_wait(&presentCond, &presentMutex);
+            continue;
+        }
+
+        SDL_Rect rect = presentRect;
+        pthread_mutex_unlock(&presentMutex);
+        presentRectangle(&rect);
+        pthread_mutex_lock(&presentMutex);
+
+        inProgress = false;
+        pthread_cond_broadcast(&presentCond);
+    }
+    pthread_mutex_unlock(&presentMutex);
+
+    destroyWindow();
+
+    return NULL;
+}
+
 
 void display_init()
 {
@@ -110,21 +245,6 @@ void display_init()
 
     } else
     {
-
-        window = SDL_CreateWindow("OpenRTX",
-                                  SDL_WINDOWPOS_UNDEFINED,
-                                  SDL_WINDOWPOS_UNDEFINED,
-                                  SCREEN_WIDTH * 3, SCREEN_HEIGHT * 3,
-                                  SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
-
-        renderer = SDL_CreateRenderer(window, -1, 0);
-        SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
-        displayTexture = SDL_CreateTexture(renderer, PIXEL_FORMAT, SDL_TEXTUREACCESS_STREAMING,
-                                           SCREEN_WIDTH, SCREEN_HEIGHT);
-        SDL_RenderClear(renderer);
-        SDL_RenderCopy(renderer, displayTexture, NULL, NULL);
-        SDL_RenderPresent(renderer);
-
         /*
          * Black and white pixel format: framebuffer type is uint8_t where each
          * bit represents a pixel. We have to allocate
@@ -155,53 +275,109 @@ void display_init()
         frameBuffer = malloc(fbSize);
         memset(frameBuffer, 0xFFFF, fbSize);
         inProgress = false;
+
+        presenterRunning = true;
+        if (pthread_create(&presenter, NULL, presenterThread, NULL) != 0)
+        {
+            printf("SDL presenter thread creation failed!\n");
+            presenterRunning = false;
+            createWindow();
+            return;
+        }
+
+        /* Wait for the presenter thread to set up the window */
+        pthread_mutex_lock(&presentMutex);
+        while (!presenterReady)
+            pthread_cond_wait(&presentCond, &presentMutex);
+        pthread_mutex_unlock(&presentMutex);
     }
 }
 
 void display_terminate()
 {
-    while (inProgress)
-    {}         /* Wait until current render finishes */
+    display_waitRender();  /* Wait until current render finishes */
+
+    if (presenterRunning)
+    {
+        pthread_mutex_lock(&presentMutex);
+        presenterRunning = false;
+        pthread_cond_broadcast(&presentCond);
+        pthread_mutex_unlock(&presentMutex);
+        pthread_join(presenter, NULL);
+    }
+    else
+    {
+        destroyWindow();
+    }
+
     printf("Terminating SDL display emulator, goodbye!\n");
     free(frameBuffer);
-    SDL_DestroyWindow(window);
     SDL_Quit();
 }
 
-void display_renderRows(__attribute__((unused)) uint8_t startRow,
-                        __attribute__((unused)) uint8_t endRow)
+void display_renderRows(uint8_t startRow, uint8_t endRow)
 {
-    PIXEL_SIZE *pixels;
-    int pitch = 0;
-    if (SDL_LockTexture(displayTexture, NULL, (void **) &pixels, &pitch) < 0)
-    {
-        printf("SDL_lock failed: %s\n", SDL_GetError());
-    }
-    inProgress = true;
-#ifdef PIX_FMT_RGB565
-    uint16_t *fb = (uint16_t *) (frameBuffer);
-    memcpy(pixels, fb, sizeof(uint16_t) * SCREEN_HEIGHT * SCREEN_WIDTH);
+#ifdef PIX_FMT_BW
+    /* 1bpp framebuffer is organised in pages of eight pixel rows */
+    uint16_t y0 = startRow * 8;
+    uint16_t y1 = endRow * 8;
 #else
-    for (unsigned int x = 0; x < SCREEN_WIDTH; x++) {
-        for (unsigned int y = startRow; y < endRow; y++) {
-            pixels[x + y * SCREEN_WIDTH] = fetchPixelFromFb(x, y);
-        }
-    }
+    uint16_t y0 = startRow;
+    uint16_t y1 = endRow;
 #endif
-    SDL_UnlockTexture(displayTexture);
-    SDL_RenderCopy(renderer, displayTexture, NULL, NULL);
-    SDL_RenderPresent(renderer);
-    inProgress = false;
+    if (y1 > SCREEN_HEIGHT) y1 = SCREEN_HEIGHT;
+    if (y0 >= y1) return;
+
+    display_renderRect(0, y0, SCREEN_WIDTH, y1);
+}
+
+void display_renderRect(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1)
+{
+    SDL_Rect rect = {x0, y0, x1 - x0, y1 - y0};
+
+    /* No presenter thread, render synchronously */
+    if (!presenterRunning)
+    {
+        presentRectangle(&rect);
+        return;
+    }
+
+    pthread_mutex_lock(&presentMutex);
+    while (inProgress)
+        pthread_cond_wait(&presentCond, &presentMutex);
+
+    presentRect = rect;
+    inProgress  = true;
+    pthread_cond_broadcast(&presentCond);
+    pthread_mutex_unlock(&presentMutex);
 }
 
 void display_render()
 {
-    display_renderRows(0, SCREEN_HEIGHT);
+    display_renderRect(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    display_waitRender();
+}
+
+void display_waitRender()
+{
+    pthread_mutex_lock(&presentMutex);
+    while (inProgress)
+        pthread_cond_wait(&presentCond, &presentMutex);
+    pthread_mutex_unlock(&presentMutex);
+}
+
+void display_frameDone()
+{
+    /* Every transfer is shown as soon as it completes, nothing to do */
 }
 
 bool display_renderingInProgress()
 {
-    return inProgress;
+    pthread_mutex_lock(&presentMutex);
+    bool busy = inProgress;
+    pthread_mutex_unlock(&presentMutex);
+
+    return busy;
 }
 
 void *display_getFrameBuffer()
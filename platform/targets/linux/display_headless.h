@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef DISPLAY_HEADLESS_H
+#define DISPLAY_HEADLESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Headless display backend for the linux target.
+ *
+ * The framebuffer is kept in memory and never shown, allowing to run the
+ * firmware, benchmarks and UI tests without a window. Rendered frames can be
+ * captured to a directory, as PPM or PNG images named after their sequence
+ * number, either all of them or only the ones differing from the last captured
+ * frame. A frame is complete when display_frameDone() is called, after all its
+ * areas have been rendered.
+ *
+ * Capture can be configured at runtime through the following environment
+ * variables, read by display_init():
+ * - OPENRTX_CAPTURE_DIR: destination directory, capture is enabled if set;
+ * - OPENRTX_CAPTURE_FORMAT: "ppm" (default) or "png";
+ * - OPENRTX_CAPTURE_CHANGED: if set to "1", capture only the changed frames.
+ */
+
+/**
+ * Image format of the captured frames.
+ */
+enum captureFormat
+{
+    CAPTURE_PPM = 0,    /**< Binary PPM (P6), 24 bit RGB            */
+    CAPTURE_PNG         /**< PNG, 24 bit RGB, uncompressed          */
+};
+
+/**
+ * Data structure holding the headless display counters.
+ */
+typedef struct
+{
+    uint32_t frames;        /**< Number of completed frames                   */
+    uint32_t renders;       /**< Number of render calls                       */
+    uint32_t rows;          /**< Number of pixel rows pushed to the display   */
+    uint32_t pixels;        /**< Number of pixels pushed to the display       */
+    uint32_t captured;      /**< Number of frames written to disk             */
+}
+headlessStats_t;
+
+/**
+ * Configure the frame capture.
+ *
+ * @param dir: destination directory, NULL to disable the capture.
+ * @param format: image format, from enum captureFormat.
+ * @param changedOnly: if true, capture only the frames differing from the
+ * last captured one.
+ */
+void headless_setCapture(const char *dir, uint8_t format, bool changedOnly);
+
+/**
+ * Write the current framebuffer content to a file.
+ *
+ * @param path: file path.
+ * @param format: image format, from enum captureFormat.
+ * @return true on success.
+ */
+bool headless_saveFrame(const char *path, uint8_t format);
+
+/**
+ * Get the headless display counters.
+ *
+ * @return counters since the display initialisation.
+ */
+headlessStats_t headless_getStats();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISPLAY_HEADLESS_H */
@@ -35,7 +35,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-radio_state Radio_State = {12, 8.2f, 3, 4, 1, false};
+radio_state Radio_State = {-120.0f, 8.2f, 3, 4, 1, false, {{0, 0.0f}}};
 
 int CLIMenu()
 {
@@ -47,13 +47,14 @@ int CLIMenu()
     printf("4 -> Volume Level\n");
     printf("5 -> Channel selector\n");
     printf("6 -> Toggle PTT\n");
-    printf("7 -> Print current state\n");
-    printf("8 -> Exit\n");
+    printf("7 -> Set RF carrier\n");
+    printf("8 -> Print current state\n");
+    printf("9 -> Exit\n");
     printf("> ");
     do
     {
         scanf("%d", &choice);
-    } while (choice < 1 || choice > 8);
+    } while (choice < 1 || choice > 9);
     printf("\033[1;1H\033[2J");
     return choice;
 }
@@ -65,6 +66,21 @@ void updateValue(float *curr_value)
     scanf("%f", curr_value);
 }
 
+void updateCarrier()
+{
+    unsigned int index = 0;
+    printf("Carrier slot (0 - %d): \n", EMU_MAX_CARRIERS - 1);
+    scanf("%u", &index);
+    if(index >= EMU_MAX_CARRIERS) return;
+
+    carrier_t *c = &Radio_State.carriers[index];
+    printf("Current value: %u Hz, %f dBm\n", c->frequency, c->rssi);
+    printf("New frequency in Hz (0 to disable): \n");
+    scanf("%u", &c->frequency);
+    printf("New RSSI in dBm: \n");
+    scanf("%f", &c->rssi);
+}
+
 void printState()
 {
     printf("\nCurrent state\n");
@@ -73,7 +89,16 @@ void printState()
     printf("Mic    : %f\n", Radio_State.micLevel);
     printf("Volume : %f\n", Radio_State.volumeLevel);
     printf("Channel: %f\n", Radio_State.chSelector);
-    printf("PTT    : %s\n\n", Radio_State.PttStatus ? "true" : "false");
+    printf("PTT    : %s\n", Radio_State.PttStatus ? "true" : "false");
+
+    for(int i = 0; i < EMU_MAX_CARRIERS; i++)
+    {
+        carrier_t *c = &Radio_State.carriers[i];
+        if(c->frequency == 0) continue;
+        printf("Carrier: %u Hz, %f dBm\n", c->frequency, c->rssi);
+    }
+
+    printf("\n");
 
 }
 
@@ -103,6 +128,9 @@ void *startCLIMenu()
             case VAL_PTT:
                 Radio_State.PttStatus = Radio_State.PttStatus ? false : true;
                 break;
+            case VAL_CARRIER:
+                updateCarrier();
+                break;
             case PRINT_STATE:
                 printState();
                 break;
@@ -34,6 +34,10 @@
 #include <stdint.h>
 #include <SDL2/SDL.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #ifndef SCREEN_WIDTH
 #define SCREEN_WIDTH 160
 #endif
@@ -42,6 +46,12 @@
 #define SCREEN_HEIGHT 128
 #endif
 
+/**
+ * Maximum number of simulated RF carriers. Each carrier is seen by the radio
+ * driver only when the current RX frequency is within the channel bandwidth.
+ */
+#define EMU_MAX_CARRIERS 4
+
 enum choices
 {
     VAL_RSSI=1,
@@ -50,10 +60,18 @@ enum choices
     VAL_VOL,
     VAL_CH,
     VAL_PTT,
+    VAL_CARRIER,
     PRINT_STATE,
     EXIT
 };
 
+typedef struct
+{
+    uint32_t frequency;    /**< Carrier frequency in Hz, zero if unused */
+    float    rssi;         /**< Carrier strength at receiver input, in dBm */
+}
+carrier_t;
+
 typedef struct
 {
     float RSSI;
@@ -62,10 +80,15 @@ typedef struct
     float volumeLevel;
     float chSelector;
     bool PttStatus;
+    carrier_t carriers[EMU_MAX_CARRIERS];
 } radio_state;
 
 extern radio_state Radio_State;
 
 void emulator_start();
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* EMULATOR_H */
@@ -27,6 +27,7 @@
 
 #include <interfaces/platform.h>
 #include <interfaces/gpio.h>
+#include <interfaces/nvmem.h>
 #include <stdio.h>
 #include "emulator.h"
 #include <SDL2/SDL.h>
@@ -47,6 +48,7 @@ void platform_init()
     hwInfo.uhf_minFreq = 400;
     hwInfo.uhf_band    = 1;
 
+    nvm_init();
     emulator_start();
 }
 
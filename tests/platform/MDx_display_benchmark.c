@@ -34,52 +34,36 @@
 #include <hwconfig.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <os.h>
+#include <probe.h>
+#include <cycles.h>
 
-uint64_t benchmark(uint32_t n);
+static PROBE_DEFINE(gfx_render);
+
+void benchmark(uint32_t n);
 
 int main()
 {
     platform_init();
+    cycles_init();
     platform_setBacklightLevel(255);
 
     gfx_init();
     kbd_init();
 
-    /*
-     * Setup timer for time measurement: input clock is twice the APB2 clock, so
-     * is 168MHz. Setting the prescaler to 33 we get a tick frequency of
-     * 5,09090909091 MHz, that is a resolution of 0.196 us per tick.
-     * Considering that the timer has a 16-bit counter, we have rollover in
-     * 12.87 ms.
-     */
-
-    static const uint32_t clkDivider = 33;
-
-    RCC->APB2ENR |= RCC_APB2ENR_TIM9EN;
-
-    TIM9->PSC = clkDivider - 1;
-    TIM9->ARR = 0xFFFF;
-    TIM9->CR1 = TIM_CR1_CEN;
-
     uint32_t numIterations = 128;
 
     while(1)
     {
         getchar();
 
-        uint64_t tot_ticks = benchmark(numIterations);
-
-        float totalTime_s = ((float)(tot_ticks * clkDivider))/168000000.0f;
-        printf("Average values over %ld iterations:\r\n", numIterations);
-        printf("- %lld ticks\r\n- %f ms\r\n", tot_ticks, totalTime_s*1000.0f);
-
+        probe_reset(&probe_gfx_render);
+        benchmark(numIterations);
+        probe_dump();
     }
 }
 
-uint64_t benchmark(uint32_t n)
+void benchmark(uint32_t n)
 {
-    uint64_t totalTime = 0;
     uint32_t dummy = 0;
 
     for(uint32_t i = 0; i < n; i++)
@@ -89,16 +73,13 @@ uint64_t benchmark(uint32_t n)
         color_t color_red = {255, 0, 0, 255};
         color_t color_white = {255, 255, 255, 255};
         gfx_drawRect(origin, 160, 20, color_red, 1);
-        gfx_print(origin, buffer, FONT_SIZE_24PT, TEXT_ALIGN_LEFT,
-                  color_white, "KEK");
+        gfx_print(origin, FONT_SIZE_24PT, TEXT_ALIGN_LEFT, color_white, "KEK");
 
         dummy += kbd_getKeys();
 
         /* Measure the time taken by gfx_render() */
-        TIM9->CNT = 0;
+        PROBE_BEGIN(gfx_render);
         gfx_render();
-        totalTime += TIM9->CNT;
+        PROBE_END(gfx_render);
     }
-
-    return totalTime/n;
 }
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Band scope demo for the linux target: a couple of carriers are placed in the
+ * emulator, then the band around them is swept printing the resulting graph
+ * and the sweep speed.
+ */
+
+#include <interfaces/platform.h>
+#include <interfaces/delays.h>
+#include <emulator.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <rtx.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+int main()
+{
+    pthread_mutex_t mutex;
+    pthread_mutex_init(&mutex, NULL);
+
+    platform_init();
+    rtx_init(&mutex);
+
+    rtxStatus_t cfg = rtx_getCurrentStatus();
+    cfg.opMode      = FM;
+    cfg.bandwidth   = BW_12_5;
+    cfg.rxFrequency = 430100000;
+    cfg.txFrequency = 430100000;
+    cfg.sqlLevel    = 3;
+    rtx_configure(&cfg);
+
+    Radio_State.carriers[0].frequency = 430000000;
+    Radio_State.carriers[0].rssi      = -70.0f;
+    Radio_State.carriers[1].frequency = 430250000;
+    Radio_State.carriers[1].rssi      = -95.0f;
+
+    bandScopeCfg_t scope;
+    scope.points    = 40;
+    scope.step      = 12500;
+    scope.startFreq = cfg.rxFrequency - (scope.points / 2) * scope.step;
+    scope.dwellTime = 10;
+    rtx_startBandScope(&scope);
+
+    // Same scheduling of the rtx thread, for three seconds
+    long long lastUpdate = 0;
+    long long start      = getTick();
+    while((getTick() - start) < 3000)
+    {
+        rtx_sampleRssi();
+
+        long long now = getTick();
+        if((now - lastUpdate) >= 30)
+        {
+            rtx_taskFunc();
+            lastUpdate = now;
+        }
+
+        sleepFor(0u, rtx_getRssiPeriod());
+    }
+
+    bandScopeStats_t st = rtx_getBandScopeStats();
+    const int8_t *data  = rtx_getBandScopeData();
+
+    for(uint16_t i = 0; i < scope.points; i++)
+    {
+        printf("%9lu %4ddBm ", (unsigned long) (scope.startFreq + i * scope.step),
+               data[i]);
+        for(int16_t l = -127; l < data[i]; l += 3) putchar('#');
+        putchar('\n');
+    }
+
+    printf("points=%lu sweeps=%lu speed=%.1fpt/s\n", (unsigned long) st.count,
+           (unsigned long) st.sweeps, st.pointsPerSec);
+
+    rtx_stopBandScope();
+    rtx_taskFunc();
+
+    rtx_terminate();
+    platform_terminate();
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Benchmark of the 1bpp display data preparation, to be built for the linux
+ * target with -Dlinux_pixfmt=bw. The VFO screen is drawn, then the byte stream
+ * sent to the UC1701/ST7567 controllers is produced both with the transpose of
+ * a row-major framebuffer, as done before by the display drivers, and with the
+ * plain copy of the page-major framebuffer. The two streams are also compared.
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/display.h>
+#include <interfaces/platform.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <state.h>
+#include <ui.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+#ifndef PIX_FMT_BW
+#error This benchmark requires the 1bpp pixel format, build with -Dlinux_pixfmt=bw
+#endif
+
+#define NUM_PAGES  (SCREEN_HEIGHT / 8)
+#define FB_BYTES   (SCREEN_WIDTH * NUM_PAGES)
+#define ITERATIONS 20000
+
+static uint8_t rowMajor[FB_BYTES];
+static uint8_t stream[FB_BYTES];
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+/*
+ * Transpose of a row-major framebuffer page, as previously done by the
+ * display_renderRow() function of the UC1701 and ST7567 drivers.
+ */
+static void transposePage(const uint8_t *fb, uint8_t page, uint8_t *out)
+{
+    const uint8_t *buf = fb + (SCREEN_WIDTH * page);
+    for(uint8_t i = 0; i < (SCREEN_WIDTH / 8); i++)
+    {
+        uint8_t tmp[8] = {0};
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            uint8_t tmp_buf = buf[j * (SCREEN_WIDTH / 8) + i];
+            int count = __builtin_popcount(tmp_buf);
+            while(count > 0)
+            {
+                int pos = __builtin_ctz(tmp_buf);
+                tmp[pos] |= 1UL << j;
+                tmp_buf &= ~(1 << pos);
+                count--;
+            }
+        }
+
+        memcpy(out, tmp, sizeof(tmp));
+        out += 8;
+    }
+}
+
+int main()
+{
+    platform_init();
+    state_init();
+    gfx_init();
+    ui_init();
+
+    state.ui_screen = MAIN_VFO;
+    ui_saveState();
+    ui_updateGUI();
+
+    // Build the equivalent row-major framebuffer
+    const uint8_t *fb = (const uint8_t *) display_getFrameBuffer();
+    memset(rowMajor, 0x00, sizeof(rowMajor));
+    for(uint16_t y = 0; y < SCREEN_HEIGHT; y++)
+    {
+        for(uint16_t x = 0; x < SCREEN_WIDTH; x++)
+        {
+            if((fb[x + (y / 8) * SCREEN_WIDTH] & (1 << (y % 8))) == 0)
+                continue;
+
+            uint16_t pos = x + y * SCREEN_WIDTH;
+            rowMajor[pos / 8] |= 1 << (pos % 8);
+        }
+    }
+
+    double start = now();
+    for(uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        for(uint8_t page = 0; page < NUM_PAGES; page++)
+            transposePage(rowMajor, page, &stream[page * SCREEN_WIDTH]);
+        __asm__ volatile("" ::: "memory");
+    }
+    double transposeTime = (now() - start) / ITERATIONS;
+    bool   match         = (memcmp(stream, fb, FB_BYTES) == 0);
+
+    start = now();
+    for(uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        for(uint8_t page = 0; page < NUM_PAGES; page++)
+            memcpy(&stream[page * SCREEN_WIDTH], &fb[page * SCREEN_WIDTH],
+                   SCREEN_WIDTH);
+        __asm__ volatile("" ::: "memory");
+    }
+    double copyTime = (now() - start) / ITERATIONS;
+
+    printf("row-major transpose: %8.3f us/frame\n", transposeTime);
+    printf("page-major copy:     %8.3f us/frame\n", copyTime);
+    printf("streams %s\n", match ? "match" : "DIFFER");
+
+    return 0;
+}
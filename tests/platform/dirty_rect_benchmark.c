@@ -0,0 +1,154 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Partial display update benchmark for the linux target. Typical UI updates
+ * are drawn through the real UI code, then sent to the display first as whole
+ * frames and then through the dirty region tracking of gfx_render(). For each
+ * kind of update, the bytes and pixels sent to the display and the time per
+ * update, drawing included, are printed.
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/platform.h>
+#include <stdio.h>
+#include <time.h>
+#include <state.h>
+#include <ui.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+#define NUM_UPDATES 200
+
+#if defined PIX_FMT_RGB565
+#define PIXEL_BYTES 2.0f
+#define NUM_ROWS    SCREEN_HEIGHT
+#elif defined PIX_FMT_GRAYSC
+#define PIXEL_BYTES 1.0f
+#define NUM_ROWS    SCREEN_HEIGHT
+#else
+#define PIXEL_BYTES 0.125f
+#define NUM_ROWS    (SCREEN_HEIGHT / 8)
+#endif
+
+typedef enum
+{
+    UPDATE_CLOCK = 0,
+    UPDATE_RSSI,
+    UPDATE_BATTERY,
+    UPDATE_NONE,
+    UPDATE_SCREEN,
+    UPDATE_NUM
+}
+update_t;
+
+static const char *names[] = {"clock tick", "RSSI change", "battery",
+                              "no change", "screen switch"};
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+static void applyUpdate(update_t type, uint32_t i)
+{
+    switch(type)
+    {
+        case UPDATE_CLOCK:
+            state.time.second = i % 60;
+            break;
+
+        case UPDATE_RSSI:
+            state.rssi = -127.0f + (i % 80);
+            break;
+
+        case UPDATE_BATTERY:
+            state.charge = 100 - (i % 100);
+            state_publish(STATE_POWER);
+            break;
+
+        case UPDATE_SCREEN:
+            state.ui_screen = (i % 2) ? MENU_TOP : MAIN_VFO;
+            break;
+
+        default:
+            break;
+    }
+
+    ui_saveState();
+    ui_updateGUI();
+}
+
+static void benchmark(update_t type, bool partial)
+{
+    // Start from the VFO screen, fully rendered
+    state.ui_screen = MAIN_VFO;
+    applyUpdate(UPDATE_NONE, 0);
+    gfx_render();
+
+    uint32_t startPixels = gfx_getRenderedPixels();
+    double   start       = now();
+
+    for(uint32_t i = 1; i <= NUM_UPDATES; i++)
+    {
+        applyUpdate(type, i);
+        if(partial)
+            gfx_render();
+        else
+            gfx_renderRows(0, NUM_ROWS);
+    }
+
+    double   elapsed = (now() - start) / NUM_UPDATES;
+    uint32_t pixels  = SCREEN_WIDTH * SCREEN_HEIGHT * NUM_UPDATES;
+    if(partial) pixels = gfx_getRenderedPixels() - startPixels;
+
+    printf("%-14s %-8s %10.1f %12.1f %9.1f\n", names[type],
+           partial ? "partial" : "full",
+           (pixels * PIXEL_BYTES) / NUM_UPDATES,
+           ((float) pixels) / NUM_UPDATES, elapsed);
+}
+
+int main()
+{
+    platform_init();
+    state_init();
+    gfx_init();
+    ui_init();
+
+    printf("Update         Render   Bytes/upd   Pixels/upd    us/upd\n");
+    for(uint8_t type = 0; type < UPDATE_NUM; type++)
+    {
+        benchmark(type, false);
+        benchmark(type, true);
+    }
+
+    return 0;
+}
@@ -49,6 +49,9 @@ void drawRect(int x, int y, int width, int height, uint16_t color)
     int y_max = y + height;
     uint16_t *buf = (uint16_t *)(display_getFrameBuffer());
 
+    /* Framebuffer pixels are stored big endian */
+    color = __builtin_bswap16(color);
+
     for(int i=y; i < y_max; i++)
     {
         for(int j=x; j < x_max; j++)
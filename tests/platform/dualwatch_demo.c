@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Dual watch demo for the linux target: the main and secondary channel are
+ * monitored while simulated carriers are keyed on and off through the emulator
+ * state, printing the dual watch statistics once per second.
+ */
+
+#include <interfaces/platform.h>
+#include <interfaces/delays.h>
+#include <interfaces/radio.h>
+#include <emulator.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <rtx.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+static const freq_t mainFreq = 430100000;
+static const freq_t secFreq  = 145500000;
+
+int main()
+{
+    pthread_mutex_t mutex;
+    pthread_mutex_init(&mutex, NULL);
+
+    platform_init();
+    rtx_init(&mutex);
+
+    rtxStatus_t mainCfg = rtx_getCurrentStatus();
+    mainCfg.opMode      = FM;
+    mainCfg.bandwidth   = BW_12_5;
+    mainCfg.rxFrequency = mainFreq;
+    mainCfg.txFrequency = mainFreq;
+    mainCfg.sqlLevel    = 3;
+
+    rtxStatus_t secCfg  = mainCfg;
+    secCfg.rxFrequency  = secFreq;
+
+    rtx_configure(&mainCfg);
+    rtx_setDualWatch(&secCfg, 150);
+
+    long long lastUpdate = 0;
+
+    for(uint32_t sec = 0; sec < 20; sec++)
+    {
+        // Key up the secondary channel in 3s bursts, main channel in 5s bursts
+        Radio_State.carriers[0].frequency = ((sec % 6) < 3)  ? secFreq  : 0;
+        Radio_State.carriers[0].rssi      = -80.0f;
+        Radio_State.carriers[1].frequency = ((sec % 10) > 5) ? mainFreq : 0;
+        Radio_State.carriers[1].rssi      = -70.0f;
+
+        // Same scheduling of the rtx thread, for one second
+        long long start = getTick();
+        while((getTick() - start) < 1000)
+        {
+            rtx_sampleRssi();
+
+            long long now = getTick();
+            if((now - lastUpdate) >= 30)
+            {
+                rtx_taskFunc();
+                lastUpdate = now;
+            }
+
+            sleepFor(0u, rtx_getRssiPeriod());
+        }
+
+        dualWatchStats_t st = rtx_getDualWatchStats();
+        printf("t=%2lus leg=%d locked=%d switches=%lu rate=%.2fHz "
+               "activity=%lu/%lu missed=%lu\n", (unsigned long) sec,
+               st.activeLeg, st.locked, (unsigned long) st.switches,
+               st.switchRate, (unsigned long) st.activity[0],
+               (unsigned long) st.activity[1], (unsigned long) st.missed);
+    }
+
+    rtx_setDualWatch(NULL, 0);
+    rtx_taskFunc();
+    rtx_terminate();
+    platform_terminate();
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Formatting benchmark for the linux target. Each of the fields printed by
+ * the main screen is formatted both with the C library, as the user interface
+ * used to do, and with the fmt_* routines, checking that the two outputs match
+ * over the input range, also when truncated, and reporting the time per call
+ * of each implementation.
+ */
+
+#include <format.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+#define ITERATIONS 2000000
+
+typedef enum
+{
+    FIELD_FREQUENCY = 0,
+    FIELD_CHANNEL,
+    FIELD_VOLTAGE,
+    FIELD_TIME,
+    FIELD_CALLSIGN,
+    FIELD_NUM
+}
+field_t;
+
+static const char *fieldNames[] = { "frequency", "channel", "voltage", "time",
+                                    "callsign" };
+
+static const char *callsigns[] = { "iu2kwo", " IU2KIN", "iu2nro/p",
+                                   "dl0xyz-12 test", "W1AW" };
+
+static volatile size_t sink;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+static curTime_t makeTime(uint32_t i)
+{
+    curTime_t t;
+    t.hour   = i % 24;
+    t.minute = (i / 24) % 60;
+    t.second = (i / 7) % 60;
+    t.day    = 1;
+    t.date   = 1 + (i % 31);
+    t.month  = 1 + (i % 12);
+    t.year   = i % 100;
+    return t;
+}
+
+/*
+ * Format a field with the C library.
+ */
+static size_t formatPrintf(field_t field, uint32_t i, char *buf, size_t len)
+{
+    switch(field)
+    {
+        case FIELD_FREQUENCY:
+        {
+            unsigned long freq = 136000000 + i * 12500;
+            return snprintf(buf, len, "%03lu.%05lu", freq / 1000000,
+                            freq % 1000000 / 10);
+        }
+
+        case FIELD_CHANNEL:
+            return snprintf(buf, len, "  %03d: %.12s", (int) (i % 1024),
+                            "Repeater R7 Milano");
+
+        case FIELD_VOLTAGE:
+        {
+            // Reference rounding, the old "%d.%d" split is wrong above x.95V
+            int tenths = ((i % 20000) + 50) / 100;
+            return snprintf(buf, len, "%d.%dV", tenths / 10, tenths % 10);
+        }
+
+        case FIELD_TIME:
+        {
+            curTime_t t = makeTime(i);
+            return snprintf(buf, len, "%02d:%02d:%02d", t.hour, t.minute,
+                            t.second);
+        }
+
+        case FIELD_CALLSIGN:
+        {
+            const char *src = callsigns[i % 5];
+            while(*src == ' ') src++;
+            size_t n = 0;
+            while((n < FMT_CALLSIGN_LEN) && (n < (len - 1)) &&
+                  (isalnum((unsigned char) src[n]) || (src[n] == '/') ||
+                   (src[n] == '-')))
+            {
+                buf[n] = toupper((unsigned char) src[n]);
+                n++;
+            }
+            buf[n] = '\0';
+            return n;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Format a field with the fmt_* routines.
+ */
+static size_t formatFmt(field_t field, uint32_t i, char *buf, size_t len)
+{
+    size_t n = 0;
+
+    switch(field)
+    {
+        case FIELD_FREQUENCY:
+            return fmt_frequency(buf, len, 136000000 + i * 12500);
+
+        case FIELD_CHANNEL:
+            n  = fmt_string(buf, len, "  ", 2);
+            n += fmt_unsigned(buf + n, len - n, i % 1024, 3, '0');
+            n += fmt_string(buf + n, len - n, ": ", 2);
+            n += fmt_string(buf + n, len - n, "Repeater R7 Milano", 12);
+            return n;
+
+        case FIELD_VOLTAGE:
+            n  = fmt_decimal(buf, len, i % 20000, 3, 1);
+            n += fmt_string(buf + n, len - n, "V", 1);
+            return n;
+
+        case FIELD_TIME:
+            return fmt_time(buf, len, makeTime(i));
+
+        case FIELD_CALLSIGN:
+            return fmt_callsign(buf, len, callsigns[i % 5]);
+
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Run a formatter over the benchmark inputs, return the time per call in ns.
+ */
+static double benchmark(field_t field,
+                        size_t (*format)(field_t, uint32_t, char *, size_t))
+{
+    char buf[24];
+
+    double start = now();
+    for(uint32_t i = 0; i < ITERATIONS; i++)
+        sink += format(field, i, buf, sizeof(buf));
+    double elapsed = now() - start;
+
+    return elapsed / ITERATIONS;
+}
+
+/*
+ * Compare the output of the two implementations, also with short buffers to
+ * exercise truncation, return the number of mismatches.
+ */
+static uint32_t check(field_t field)
+{
+    uint32_t errors = 0;
+
+    for(uint32_t i = 0; i < 100000; i++)
+    {
+        char   ref[24];
+        char   out[24];
+        size_t len = (i % 4 == 0) ? (1 + i % 11) : sizeof(ref);
+
+        memset(out, 0x55, sizeof(out));
+        size_t refLen = formatPrintf(field, i, ref, len);
+        size_t outLen = formatFmt(field, i, out, len);
+
+        // snprintf returns the untruncated length
+        if(refLen >= len) refLen = len - 1;
+        if((refLen != outLen) || (strcmp(ref, out) != 0))
+        {
+            if(errors == 0)
+                printf("%s: expected \"%s\", got \"%s\"\n", fieldNames[field],
+                       ref, out);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+int main()
+{
+    printf("field      snprintf (ns)  fmt (ns)  speedup  mismatches\n");
+
+    for(int field = 0; field < FIELD_NUM; field++)
+    {
+        uint32_t errors = check(field);
+        double   ref    = benchmark(field, formatPrintf);
+        double   fmt    = benchmark(field, formatFmt);
+        printf("%-10s %13.1f %9.1f %7.1fx %11u\n", fieldNames[field], ref,
+               fmt, ref / fmt, errors);
+    }
+
+    return 0;
+}
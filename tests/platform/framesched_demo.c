@@ -0,0 +1,216 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Frame scheduler demo for the linux target. A producer thread simulates a
+ * fast knob rotation, posting bursts of events 2ms apart, and status changes
+ * every 100ms; a consumer thread processes them like the UI thread does,
+ * drawing a frame, which takes 5ms, whenever the scheduler allows it. Then a
+ * periodic refresh is run alone, without any event, and finally together with
+ * a key event posted shortly before each refresh, which defers it because of
+ * the frame rate cap. For each phase the number of frames per event and the
+ * latency from event to frame are printed; before the scheduler, every event
+ * caused a frame.
+ */
+
+#include <interfaces/delays.h>
+#include <framesched.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <swtimer.h>
+#include <queue.h>
+#include <event.h>
+
+#define PAYLOAD_MASK 0x0FFFFFFF
+#define PAYLOAD_STOP 0x3FFFFFFF
+
+static queue_t   queue;
+static swtimer_t stopTimer;
+
+/**
+ * Post an event carrying the posting time, in ms.
+ */
+static void postEvent(uint8_t type)
+{
+    event_t event;
+    event.type    = type;
+    event.payload = getTick() & PAYLOAD_MASK;
+
+    if(type == EVENT_STATUS)
+        (void) queue_postCoalesced(&queue, event.value, EVENT_STATUS);
+    else
+        (void) queue_post(&queue, event.value);
+}
+
+static void *producer(void *arg)
+{
+    (void) arg;
+
+    // Bursts of 20 knob steps every 300ms, status changes every 100ms
+    for(uint32_t t = 0; t < 3000; t += 2)
+    {
+        if(((t % 300) < 40)) postEvent(EVENT_KBD);
+        if((t % 100) == 0)   postEvent(EVENT_STATUS);
+        delayMs(2);
+    }
+
+    return NULL;
+}
+
+static void *mixedProducer(void *arg)
+{
+    (void) arg;
+
+    // One key event 10ms before each deadline of the 100ms periodic refresh,
+    // timed from the start not to drift onto the deadlines
+    long long start = getTick();
+    for(uint8_t i = 0; i < 20; i++)
+    {
+        long long now = getTick();
+        long long at  = start + 90 + (i * 100);
+        if(at > now) delayMs(at - now);
+        postEvent(EVENT_KBD);
+    }
+
+    return NULL;
+}
+
+static void stop(void *arg)
+{
+    (void) arg;
+
+    event_t event;
+    event.type    = EVENT_KBD;
+    event.payload = PAYLOAD_STOP;
+    (void) queue_post(&queue, event.value);
+}
+
+/**
+ * Process the events like the UI thread, until the stop event.
+ */
+static void consumer(const char *name, uint16_t period)
+{
+    framesched_init(&queue, FRAMESCHED_DEFAULT_FPS);
+    framesched_setPeriodic(0, period);
+
+    uint32_t  maxLatency = 0;
+    uint64_t  sumLatency = 0;
+    long long oldest     = -1;      // Posting time of the oldest undrawn event
+    bool      running    = true;
+    long long refresh    = getTick() + period;  // Next periodic refresh time
+    uint32_t  refreshes  = 0;       // Periodic refresh times elapsed
+    uint32_t  onTime     = 0;       // Refreshes drawn within 4/5 of a period
+
+    while(running)
+    {
+        event_t event;
+        (void) queue_pend(&queue, &event.value, true);
+
+        do
+        {
+            if(event.type == EVENT_FRAME) continue;
+            if(event.payload == PAYLOAD_STOP)
+            {
+                running = false;
+                continue;
+            }
+
+            if(oldest < 0) oldest = event.payload;
+            framesched_event(true);
+        }
+        while(queue_pend(&queue, &event.value, false));
+
+        if(framesched_frameDue())
+        {
+            delayMs(5);
+            framesched_frameDone();
+
+            // Any frame drawn after a refresh time also refreshes the screen
+            long long now = getTick();
+            if((period != 0) && (now >= refresh))
+            {
+                if((now - refresh) <= ((period * 4) / 5)) onTime += 1;
+                while(refresh <= now)
+                {
+                    refresh   += period;
+                    refreshes += 1;
+                }
+            }
+
+            if(oldest >= 0)
+            {
+                uint32_t latency = (getTick() & PAYLOAD_MASK) - oldest;
+                if(latency > maxLatency) maxLatency = latency;
+                sumLatency += latency;
+                oldest      = -1;
+            }
+        }
+    }
+
+    frameschedStats_t st = framesched_getStats();
+    uint32_t drawn = st.frames - st.periodic;
+    printf("%-9s events %4u frames %4u (periodic %3u, deferred %3u) "
+           "frames/event %.3f latency avg %3ums max %3ums\n", name, st.events,
+           st.frames, st.periodic, st.deferred,
+           (st.events > 0) ? ((float) st.frames / st.events) : 0.0f,
+           (drawn > 0) ? (uint32_t)(sumLatency / drawn) : 0, maxLatency);
+    if(period != 0)
+        printf("%-9s periodic refreshes drawn on time %u of %u\n", name, onTime,
+               refreshes);
+}
+
+int main()
+{
+    queue_init(&queue);
+    swtimer_init();
+
+    pthread_t timerThread;
+    pthread_create(&timerThread, NULL, swtimer_task, NULL);
+
+    // Event bursts for three seconds, drawn at most at the default frame rate
+    pthread_t producerThread;
+    pthread_create(&producerThread, NULL, producer, NULL);
+    swtimer_start(&stopTimer, 3100, 0, stop, NULL);
+    consumer("bursts", 0);
+    pthread_join(producerThread, NULL);
+
+    // Periodic refresh every 250ms for two seconds, without events
+    swtimer_start(&stopTimer, 2000, 0, stop, NULL);
+    consumer("periodic", 250);
+
+    // Periodic refresh every 100ms for two seconds, each one deferred by a key
+    // event: all the 20 refreshes must still be drawn
+    pthread_create(&producerThread, NULL, mixedProducer, NULL);
+    swtimer_start(&stopTimer, 2050, 0, stop, NULL);
+    consumer("mixed", 100);
+    pthread_join(producerThread, NULL);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Drawing primitives benchmark for the linux target. Frames are only drawn in
+ * the framebuffer and never sent to the display, so that the time measured is
+ * the one of the graphics primitives alone. Full screen fills, rectangles,
+ * text, the top menu and the info menu are benchmarked.
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/platform.h>
+#include <stdio.h>
+#include <time.h>
+#include <state.h>
+#include <ui.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+static void fillScreen(uint32_t i)
+{
+    color_t color = {i & 0xFF, 0x80, 0x40, 255};
+    gfx_fillScreen(color);
+}
+
+static void drawRects(uint32_t i)
+{
+    color_t color = {0xFF, i & 0xFF, 0x40, 255};
+    gfx_clearScreen();
+    for(uint16_t y = 0; y < SCREEN_HEIGHT; y += 16)
+    {
+        point_t pos = {(y + i) % 32, y};
+        gfx_drawRect(pos, SCREEN_WIDTH / 2, 12, color, true);
+        pos.x += SCREEN_WIDTH / 2;
+        gfx_drawRect(pos, SCREEN_WIDTH / 3, 12, color, false);
+    }
+}
+
+static void drawText(uint32_t i)
+{
+    color_t white = {255, 255, 255, 255};
+    gfx_clearScreen();
+    for(uint8_t line = 1; line <= 8; line++)
+    {
+        gfx_printLine(line, 8, 0, 0, 0, FONT_SIZE_6PT, TEXT_ALIGN_LEFT, white,
+                      "Line %d: %lu abcdefghij", line, (unsigned long) i);
+    }
+}
+
+static void drawScreen(uint8_t screen)
+{
+    state.ui_screen = screen;
+    ui_saveState();
+    ui_updateGUI();
+}
+
+static void drawMenu(uint32_t i)
+{
+    (void) i;
+    drawScreen(MENU_TOP);
+}
+
+static void drawInfo(uint32_t i)
+{
+    (void) i;
+    drawScreen(MENU_INFO);
+}
+
+static void drawVFO(uint32_t i)
+{
+    state.time.second = i % 60;
+    drawScreen(MAIN_VFO);
+}
+
+static void benchmark(const char *name, void (*draw)(uint32_t),
+                      uint32_t iterations)
+{
+    double start = now();
+    for(uint32_t i = 0; i < iterations; i++) draw(i);
+    double elapsed = now() - start;
+
+    printf("%-14s %10.1f us/frame %10.0f frames/s\n", name,
+           elapsed / iterations, (iterations * 1e6) / elapsed);
+}
+
+int main()
+{
+    platform_init();
+    state_init();
+    gfx_init();
+    ui_init();
+
+    benchmark("fill screen", fillScreen, 2000);
+    benchmark("rectangles",  drawRects,  2000);
+    benchmark("text lines",  drawText,   2000);
+    benchmark("top menu",    drawMenu,   2000);
+    benchmark("info menu",   drawInfo,   2000);
+    benchmark("VFO screen",  drawVFO,    2000);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Menu list scrolling benchmark for the linux target. A large synthetic
+ * codeplug is requested to the emulated nonvolatile memory, with a delay on
+ * each read to model the external flash, then the zone, channel and contact
+ * menus are scrolled down and back up through the real UI code. The time per
+ * scroll step and per redraw of an unchanged list, rendering included, are
+ * printed for each list.
+ *
+ * Usage: menu_list_benchmark [entries] [read delay in us]
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/platform.h>
+#include <interfaces/keyboard.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <event.h>
+#include <state.h>
+#include <ui.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+#define NUM_STEPS   200
+#define NUM_REDRAWS 200
+
+static const uint8_t screens[] = {MENU_ZONE, MENU_CHANNEL, MENU_CONTACTS};
+static const char   *names[]   = {"zones", "channels", "contacts"};
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+static void redraw()
+{
+    ui_saveState();
+    ui_updateGUI();
+    gfx_render();
+    gfx_waitRender();
+    ui_prefetch();
+}
+
+static double scroll(keyboard_t key, uint32_t steps)
+{
+    kbd_msg_t msg;
+    msg.value = 0;
+    msg.keys  = key;
+
+    event_t event;
+    event.type    = EVENT_KBD;
+    event.payload = msg.value;
+
+    double start = now();
+    for(uint32_t i = 0; i < steps; i++)
+    {
+        bool sync_rtx = false;
+        ui_updateFSM(event, &sync_rtx);
+        redraw();
+    }
+
+    return (now() - start) / steps;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *entries = (argc > 1) ? argv[1] : "10000";
+    const char *delay   = (argc > 2) ? argv[2] : "20";
+    setenv("OPENRTX_NVM_ENTRIES", entries, 1);
+    setenv("OPENRTX_NVM_DELAY_US", delay, 1);
+
+    platform_init();
+    state_init();
+    gfx_init();
+    ui_init();
+
+    printf("%s entries, %s us per read\n", entries, delay);
+    printf("List        down us/step   up us/step  redraw us\n");
+    for(uint8_t i = 0; i < sizeof(screens); i++)
+    {
+        state.ui_screen = screens[i];
+        redraw();
+
+        double down = scroll(KEY_DOWN, NUM_STEPS);
+        double up   = scroll(KEY_UP, NUM_STEPS / 2);
+
+        double start = now();
+        for(uint32_t j = 0; j < NUM_REDRAWS; j++) redraw();
+        double still = (now() - start) / NUM_REDRAWS;
+
+        printf("%-10s %13.1f %12.1f %10.1f\n", names[i], down, up, still);
+
+        // Back to the top of the list, like leaving the menu does
+        state.ui_screen = MENU_TOP;
+        scroll(KEY_ESC, 1);
+    }
+
+    return 0;
+}
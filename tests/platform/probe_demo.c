@@ -0,0 +1,82 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Latency probe demo for the linux target: frame rendering, channel reads and
+ * 1ms sleeps are measured by three probes, whose statistics are printed at the
+ * end.
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/delays.h>
+#include <interfaces/nvmem.h>
+#include <stdio.h>
+#include <probe.h>
+
+static PROBE_DEFINE(render);
+static PROBE_DEFINE(readChannel);
+static PROBE_DEFINE(sleep);
+
+int main()
+{
+    static const color_t white = {255, 255, 255, 255};
+
+    nvm_init();
+    gfx_init();
+
+    for(int i = 0; i < 100; i++)
+    {
+        gfx_clearScreen();
+        gfx_drawRect((point_t) {0, i}, SCREEN_WIDTH, 20, white, true);
+
+        PROBE_BEGIN(render);
+        gfx_render();
+        PROBE_END(render);
+    }
+
+    channel_t channel;
+    for(uint16_t i = 1; i <= 16; i++)
+    {
+        PROBE_BEGIN(readChannel);
+        nvm_readChannelData(&channel, i);
+        PROBE_END(readChannel);
+    }
+
+    for(int i = 0; i < 100; i++)
+    {
+        PROBE_BEGIN(sleep);
+        sleepFor(0u, 1u);
+        PROBE_END(sleep);
+    }
+
+    probe_dump();
+
+    return 0;
+}
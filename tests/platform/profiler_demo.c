@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Profiler demo for the linux target: three threads with different CPU loads
+ * and stack usage are registered and run for three seconds, while the main
+ * thread updates the CPU loads and prints the profiling data every second.
+ */
+
+#include <interfaces/delays.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <profiler.h>
+
+typedef struct
+{
+    const char *name;
+    uint32_t    busyMs;     // Busy time in each 10ms period
+    size_t      stackBuf;   // Stack space touched in each work unit
+}
+worker_t;
+
+static volatile bool running = true;
+
+static void busyWait(uint32_t ms)
+{
+    long long end = getTick() + ms;
+    while(getTick() < end) ;
+}
+
+static void __attribute__((noinline)) useStack(size_t size)
+{
+    volatile char buf[size];
+    for(size_t i = 0; i < size; i++) buf[i] = 0x55;
+    (void) buf[0];
+}
+
+static void *worker(void *arg)
+{
+    worker_t *w  = (worker_t *) arg;
+    int8_t    id = prof_registerThread(w->name);
+
+    while(running)
+    {
+        prof_begin(id);
+        busyWait(w->busyMs);
+        useStack(w->stackBuf);
+        prof_end(id);
+
+        sleepFor(0u, 10 - w->busyMs);
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    static worker_t workers[] =
+    {
+        {"Idle",   0,  256},
+        {"Light",  1,  2048},
+        {"Heavy",  5,  16384}
+    };
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 65536);
+
+    pthread_t threads[3];
+    for(int i = 0; i < 3; i++)
+        pthread_create(&threads[i], &attr, worker, &workers[i]);
+
+    for(int i = 0; i < 3; i++)
+    {
+        sleepFor(1u, 0u);
+        prof_update();
+        prof_dump();
+    }
+
+    running = false;
+    for(int i = 0; i < 3; i++)
+        pthread_join(threads[i], NULL);
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Message queue benchmark for the linux target: a set of producer threads post
+ * messages to a single consumer, first through the lock-free queue and then
+ * through the previous mutex-based implementation, reproduced below.
+ * Producers retry when the queue is full, so that both runs deliver the same
+ * number of messages, and the total time, throughput and drops are printed.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <queue.h>
+#include <event.h>
+
+#define NUM_PRODUCERS 4
+#define NUM_MESSAGES  200000
+
+/*
+ * Mutex and condition variable based queue, as it was before the lock-free
+ * implementation.
+ */
+#define MSG_QTY 10
+
+typedef struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    uint8_t read_pos;
+    uint8_t write_pos;
+    uint8_t msg_num;
+    uint32_t buffer[MSG_QTY];
+}
+mutexQueue_t;
+
+static void mq_init(mutexQueue_t *q)
+{
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    q->read_pos  = 0;
+    q->write_pos = 0;
+    q->msg_num   = 0;
+}
+
+static bool mq_pend(mutexQueue_t *q, uint32_t *msg)
+{
+    pthread_mutex_lock(&q->mutex);
+    while(q->msg_num == 0)
+    {
+        pthread_cond_wait(&q->not_empty, &q->mutex);
+    }
+
+    *msg = q->buffer[q->read_pos];
+    q->read_pos = (q->read_pos + 1) % MSG_QTY;
+    q->msg_num -= 1;
+    pthread_mutex_unlock(&q->mutex);
+
+    return true;
+}
+
+static bool mq_post(mutexQueue_t *q, uint32_t msg)
+{
+    pthread_mutex_lock(&q->mutex);
+    if(q->msg_num >= MSG_QTY)
+    {
+        pthread_mutex_unlock(&q->mutex);
+        return false;
+    }
+
+    q->buffer[q->write_pos] = msg;
+    q->write_pos = (q->write_pos + 1) % MSG_QTY;
+    if(q->msg_num == 0) pthread_cond_signal(&q->not_empty);
+    q->msg_num += 1;
+    pthread_mutex_unlock(&q->mutex);
+
+    return true;
+}
+
+static queue_t      lfQueue;
+static mutexQueue_t mQueue;
+static bool         useLockFree;
+static uint32_t     drops[NUM_PRODUCERS];
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double) ts.tv_sec) + ((double) ts.tv_nsec) / 1e9;
+}
+
+static void *producer(void *arg)
+{
+    uint32_t id = (uint32_t) ((uintptr_t) arg);
+
+    for(uint32_t i = 0; i < NUM_MESSAGES; i++)
+    {
+        event_t ev;
+        ev.type    = EVENT_KBD;
+        ev.payload = (id << 24) | i;
+
+        while(1)
+        {
+            bool ok = useLockFree ? queue_post(&lfQueue, ev.value)
+                                  : mq_post(&mQueue, ev.value);
+            if(ok) break;
+            drops[id] += 1;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void runBenchmark(const char *name, bool lockFree)
+{
+    pthread_t threads[NUM_PRODUCERS];
+    uint32_t  last[NUM_PRODUCERS];
+    uint32_t  errors = 0;
+    uint32_t  dropped = 0;
+
+    useLockFree = lockFree;
+    for(uint8_t i = 0; i < NUM_PRODUCERS; i++)
+    {
+        drops[i] = 0;
+        last[i]  = 0xFFFFFF;
+    }
+
+    double start = now();
+
+    for(uint8_t i = 0; i < NUM_PRODUCERS; i++)
+    {
+        pthread_create(&threads[i], NULL, producer, (void *) ((uintptr_t) i));
+    }
+
+    // Check that messages of each producer are received in order
+    for(uint32_t i = 0; i < NUM_PRODUCERS * NUM_MESSAGES; i++)
+    {
+        event_t ev;
+        if(lockFree) queue_pend(&lfQueue, &ev.value, true);
+        else         mq_pend(&mQueue, &ev.value);
+
+        uint32_t id  = ev.payload >> 24;
+        uint32_t cnt = ev.payload & 0xFFFFFF;
+        if(cnt != ((last[id] + 1) & 0xFFFFFF)) errors += 1;
+        last[id] = cnt;
+    }
+
+    double elapsed = now() - start;
+
+    for(uint8_t i = 0; i < NUM_PRODUCERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        dropped += drops[i];
+    }
+
+    printf("%-10s %8.1f ms %10.0f msg/s %9u full %u out of order\n", name,
+           elapsed * 1000.0, (NUM_PRODUCERS * NUM_MESSAGES) / elapsed,
+           dropped, errors);
+}
+
+int main()
+{
+    queue_init(&lfQueue);
+    mq_init(&mQueue);
+
+    printf("%d producers, %d messages each\n", NUM_PRODUCERS, NUM_MESSAGES);
+    runBenchmark("mutex", false);
+    runBenchmark("lock-free", true);
+
+    // Priority and coalescing: status refreshes collapse into a single one
+    // and keypresses are delivered before them
+    event_t ev;
+    ev.type    = EVENT_STATUS;
+    ev.payload = 0;
+    for(uint8_t i = 0; i < 10; i++)
+    {
+        queue_postCoalesced(&lfQueue, ev.value, EVENT_STATUS);
+    }
+
+    ev.type = EVENT_KBD;
+    queue_postPriority(&lfQueue, ev.value);
+
+    printf("Delivered:");
+    while(queue_pend(&lfQueue, &ev.value, false))
+    {
+        printf(" %s", (ev.type == EVENT_KBD) ? "KBD" : "STATUS");
+    }
+
+    printf("\nOverflows: %u\n", queue_getOverflows(&lfQueue));
+
+    queue_terminate(&lfQueue);
+
+    return 0;
+}
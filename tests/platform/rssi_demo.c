@@ -0,0 +1,105 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * RSSI acquisition demo for the linux target: the RSSI level of the emulator is
+ * swept across the squelch threshold while printing the filtered value, the
+ * sampling period and the statistics over the history.
+ * The RSSI level can also be changed at runtime from the emulator CLI.
+ */
+
+#include <interfaces/platform.h>
+#include <interfaces/delays.h>
+#include <emulator.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <rssi.h>
+#include <rtx.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+static float toDbm(const int32_t value)
+{
+    return ((float) value) / (1 << RSSI_FRAC_BITS);
+}
+
+int main()
+{
+    pthread_mutex_t mutex;
+    pthread_mutex_init(&mutex, NULL);
+
+    platform_init();
+    rtx_init(&mutex);
+
+    rtxStatus_t cfg = rtx_getCurrentStatus();
+    cfg.opMode      = FM;
+    cfg.bandwidth   = BW_12_5;
+    cfg.rxFrequency = 430100000;
+    cfg.txFrequency = 430100000;
+    cfg.sqlLevel    = 3;
+    rtx_configure(&cfg);
+
+    // Squelch threshold for level 3 is -113.8dBm
+    static const float levels[] = {-120.0f, -116.0f, -112.0f, -100.0f, -80.0f,
+                                   -112.0f, -120.0f};
+
+    long long lastUpdate = 0;
+
+    for(uint8_t i = 0; i < sizeof(levels)/sizeof(levels[0]); i++)
+    {
+        Radio_State.RSSI = levels[i];
+
+        // Same scheduling of the rtx thread, for one second
+        long long start = getTick();
+        while((getTick() - start) < 1000)
+        {
+            rtx_sampleRssi();
+
+            long long now = getTick();
+            if((now - lastUpdate) >= 30)
+            {
+                rtx_taskFunc();
+                lastUpdate = now;
+            }
+
+            sleepFor(0u, rtx_getRssiPeriod());
+        }
+
+        rssiStats_t st = rssi_getStats();
+        printf("in=%6.1fdBm rssi=%7.2fdBm period=%2ums min=%7.2f avg=%7.2f "
+               "max=%7.2f len=%u count=%lu\n", levels[i], rtx_getRssi(),
+               rtx_getRssiPeriod(), toDbm(st.min), toDbm(st.avg),
+               toDbm(st.max), st.length, (unsigned long) st.count);
+    }
+
+    rtx_terminate();
+    platform_terminate();
+
+    return 0;
+}
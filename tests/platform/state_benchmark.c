@@ -0,0 +1,205 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Radio state snapshot benchmark for the linux target: a thread continuously
+ * parses NMEA sentences while the main thread simulates UI events, one
+ * keypress every ten status refreshes. State mutex hold times, the time the
+ * UI waits for the mutex and the bytes copied per event are measured first
+ * with a whole state copy and GPS parsing done under the state mutex, then with
+ * versioned section snapshots.
+ */
+
+#include <interfaces/platform.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <time.h>
+#include <state.h>
+#include <gps.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+#define NUM_EVENTS 5000
+
+static const char *nmea[] =
+{
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A",
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47",
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39",
+    "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75",
+    "$GPGSV,2,2,08,15,61,109,45,17,12,049,42,21,57,285,44,22,27,247,43*7C",
+    "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48"
+};
+
+static pthread_mutex_t state_mutex;
+static state_t         last_state;
+static uint32_t        versions[STATE_NUM_SECTIONS];
+static volatile bool   useSnapshot;
+static volatile bool   running;
+
+typedef struct
+{
+    double   total;
+    double   max;
+    uint32_t count;
+}
+holdStats_t;
+
+static holdStats_t gpsHold;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double) ts.tv_sec) * 1e6 + ((double) ts.tv_nsec) / 1e3;
+}
+
+static void addSample(holdStats_t *s, double value)
+{
+    s->total += value;
+    s->count += 1;
+    if(value > s->max) s->max = value;
+}
+
+static void *gps_thread(void *arg)
+{
+    (void) arg;
+
+    gps_t gps_data;
+    memset(&gps_data, 0x00, sizeof(gps_t));
+    uint8_t i = 0;
+
+    while(running)
+    {
+        char line[128];
+        strcpy(line, nmea[i]);
+        i = (i + 1) % (sizeof(nmea)/sizeof(nmea[0]));
+
+        if(useSnapshot)
+        {
+            gps_taskFunc(line, strlen(line), &gps_data, false);
+            state_publishGps(&gps_data);
+            addSample(&gpsHold, 0.0);
+        }
+        else
+        {
+            pthread_mutex_lock(&state_mutex);
+            double start = now();
+            gps_taskFunc(line, strlen(line), &state.gps_data, false);
+            addSample(&gpsHold, now() - start);
+            pthread_mutex_unlock(&state_mutex);
+        }
+
+        usleep(50);
+    }
+
+    return NULL;
+}
+
+static void runBenchmark(const char *name, bool snapshot)
+{
+    holdStats_t uiHold;
+    holdStats_t uiWait;
+    memset(&uiHold, 0x00, sizeof(holdStats_t));
+    memset(&uiWait, 0x00, sizeof(holdStats_t));
+    memset(&gpsHold, 0x00, sizeof(holdStats_t));
+    memset(versions, 0x00, sizeof(versions));
+    size_t bytes = 0;
+
+    useSnapshot = snapshot;
+    running     = true;
+
+    pthread_t gps;
+    pthread_create(&gps, NULL, gps_thread, NULL);
+
+    for(uint32_t i = 0; i < NUM_EVENTS; i++)
+    {
+        double start = now();
+        pthread_mutex_lock(&state_mutex);
+        double locked = now();
+        addSample(&uiWait, locked - start);
+
+        // Simulated keypress or status refresh
+        if((i % 10) == 0)
+        {
+            state.channel.rx_frequency += 12500;
+            state_publish(STATE_RADIO);
+            state_publish(STATE_SETTINGS);
+        }
+        else
+        {
+            state.v_bat += 1;
+            state_publish(STATE_POWER);
+        }
+
+        if(snapshot)
+        {
+            bytes += state_snapshot(&last_state, versions);
+        }
+        else
+        {
+            last_state = state;
+            bytes += sizeof(state_t);
+        }
+
+        addSample(&uiHold, now() - locked);
+        pthread_mutex_unlock(&state_mutex);
+
+        // Let the GPS thread run between events
+        usleep(100);
+    }
+
+    running = false;
+    pthread_join(gps, NULL);
+
+    printf("%-9s %6.1f B/event, UI hold %5.2f/%6.1fus, UI wait %5.2f/%6.1fus, "
+           "GPS hold %5.2f/%6.1fus (avg/max)\n", name,
+           ((double) bytes) / NUM_EVENTS, uiHold.total / uiHold.count,
+           uiHold.max, uiWait.total / uiWait.count, uiWait.max,
+           gpsHold.total / gpsHold.count, gpsHold.max);
+}
+
+int main()
+{
+    platform_init();
+    state_init();
+    pthread_mutex_init(&state_mutex, NULL);
+
+    printf("sizeof(state_t) = %lu bytes, %d events\n",
+           (unsigned long) sizeof(state_t), NUM_EVENTS);
+
+    runBenchmark("copy", false);
+    runBenchmark("snapshot", true);
+
+    platform_terminate();
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * State bus demo for the linux target: ten minutes of an idle radio are
+ * simulated, publishing once per second the time, a noisy battery voltage and
+ * a noisy RSSI reading as the radio state update does. Two subscribers, one showing the main
+ * screen and one showing a menu, count their wakeups, which were one per second
+ * each before the introduction of the bus.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <queue.h>
+#include <statebus.h>
+
+#define SECONDS 600
+
+static queue_t mainQueue;
+static queue_t menuQueue;
+
+static float noise(float amplitude)
+{
+    return amplitude * (((float) rand() / (float) RAND_MAX) * 2.0f - 1.0f);
+}
+
+static uint32_t drain(queue_t *q, int8_t id, uint32_t *topics)
+{
+    uint32_t msg;
+    uint32_t count = 0;
+    while(queue_pend(q, &msg, false))
+    {
+        uint32_t dirty = statebus_collect(id);
+        for(uint8_t t = 0; t < TOPIC_NUM; t++)
+        {
+            if(dirty & TOPIC_MASK(t)) topics[t] += 1;
+        }
+
+        count += 1;
+    }
+
+    return count;
+}
+
+int main()
+{
+    queue_init(&mainQueue);
+    queue_init(&menuQueue);
+    statebus_init();
+
+    int8_t mainId = statebus_subscribe(TOPIC_MASK(TOPIC_TIME)    |
+                                       TOPIC_MASK(TOPIC_BATTERY) |
+                                       TOPIC_MASK(TOPIC_RSSI), &mainQueue);
+    int8_t menuId = statebus_subscribe(TOPIC_MASK(TOPIC_BATTERY), &menuQueue);
+
+    uint32_t mainWakeups = 0;
+    uint32_t menuWakeups = 0;
+    uint32_t mainTopics[TOPIC_NUM] = {0};
+    uint32_t menuTopics[TOPIC_NUM] = {0};
+    float    v_bat = 7400.0f;
+
+    for(uint32_t sec = 0; sec < SECONDS; sec++)
+    {
+        // Slowly discharging battery, noise on voltage and RSSI readings
+        v_bat -= 0.2f;
+        float rssi = -120.0f + noise(0.8f);
+
+        statebus_update(TOPIC_TIME, sec);
+        statebus_update(TOPIC_BATTERY, (int32_t) (v_bat + noise(15.0f)));
+        statebus_update(TOPIC_RSSI, (int32_t) (rssi * 10.0f));
+
+        mainWakeups += drain(&mainQueue, mainId, mainTopics);
+        menuWakeups += drain(&menuQueue, menuId, menuTopics);
+    }
+
+    statebusStats_t st = statebus_getStats();
+
+    printf("%d seconds, %d wakeups per subscriber before\n", SECONDS, SECONDS);
+    printf("main screen: %u wakeups (time %u, battery %u, rssi %u)\n",
+           mainWakeups, mainTopics[TOPIC_TIME], mainTopics[TOPIC_BATTERY],
+           mainTopics[TOPIC_RSSI]);
+    printf("menu screen: %u wakeups (battery %u)\n", menuWakeups,
+           menuTopics[TOPIC_BATTERY]);
+    printf("updates %u, filtered %u, published %u, wakeups %u\n", st.updates,
+           st.filtered, st.published, st.wakeups);
+
+    queue_terminate(&mainQueue);
+    queue_terminate(&menuQueue);
+
+    return 0;
+}
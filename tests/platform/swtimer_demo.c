@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Software timer demo for the linux target: a set of periodic timers, with the
+ * same periods of the keyboard scan, rtx update and radio state update, and a
+ * one-shot timer run for five seconds. One of the timers periodically takes
+ * longer than its period, to show overrun detection. Jitter statistics of each
+ * timer are printed at the end.
+ */
+
+#include <interfaces/delays.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <swtimer.h>
+
+static swtimer_t timers[5];
+static uint32_t  slowCount = 0;
+
+static void callback(void *arg)
+{
+    (void) arg;
+}
+
+static void slowCallback(void *arg)
+{
+    (void) arg;
+
+    // Every ten runs, take twice the timer period
+    slowCount += 1;
+    if((slowCount % 10) == 0) delayMs(100);
+}
+
+static void oneShot(void *arg)
+{
+    printf("one-shot timer fired after %lldms\n", getTick() - *((long long *) arg));
+}
+
+int main()
+{
+    static const char *names[] = {"25ms", "30ms", "1000ms", "50ms slow",
+                                  "one-shot"};
+
+    swtimer_init();
+
+    long long start = getTick();
+    swtimer_start(&timers[0], 0, 25,   callback, NULL);
+    swtimer_start(&timers[1], 0, 30,   callback, NULL);
+    swtimer_start(&timers[2], 0, 1000, callback, NULL);
+    swtimer_start(&timers[3], 0, 50,   slowCallback, NULL);
+    swtimer_start(&timers[4], 1234, 0, oneShot, &start);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, swtimer_task, NULL);
+
+    sleepFor(5u, 0u);
+
+    for(uint8_t i = 0; i < 5; i++)
+    {
+        swtimer_stop(&timers[i]);
+        swtimerStats_t st = swtimer_getStats(&timers[i]);
+        printf("%-10s count %4u missed %3u jitter avg %5uus max %6uus\n",
+               names[i], st.count, st.missed, st.avgJitter, st.maxJitter);
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Text rendering benchmark for the linux target. For each font size, lines of
+ * text are drawn in the framebuffer and never sent to the display, then the
+ * number of glyphs drawn per second is reported. Lines cycling over all the
+ * printable characters are the worst case for the glyph cache, while lines of
+ * digits are representative of frequencies and other numeric fields.
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/platform.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+#define NUM_LINES  16
+#define ITERATIONS 4000
+
+static const char *sizeNames[] = { "5pt", "6pt", "8pt", "9pt", "10pt", "12pt",
+                                   "16pt", "18pt", "24pt" };
+
+static const char *allChars = "!\"#$%&'()*+,-./0123456789:;<=>?@"
+                              "ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`"
+                              "abcdefghijklmnopqrstuvwxyz{|}~";
+
+static const char *digits   = "0123456789.";
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+/*
+ * Build a line of text fitting the screen width, taking characters in sequence
+ * from a given set, starting from the given position.
+ */
+static size_t buildLine(fontSize_t size, const char *set, size_t first,
+                        char *line, size_t maxLen)
+{
+    GFXfont  f     = fonts[size];
+    size_t   num   = strlen(set);
+    uint16_t width = 0;
+    size_t   len   = 0;
+
+    while(len < (maxLen - 1))
+    {
+        char    c   = set[(first + len) % num];
+        uint8_t adv = f.glyph[c - f.first].xAdvance;
+        if((width + adv) >= SCREEN_WIDTH) break;
+
+        width      += adv;
+        line[len++] = c;
+    }
+
+    line[len] = '\0';
+    return len;
+}
+
+/*
+ * Draw lines of text built from a given character set, return the number of
+ * glyphs drawn per second.
+ */
+static double benchmark(fontSize_t size, const char *set)
+{
+    char   lines[NUM_LINES][64];
+    size_t glyphsPerRound = 0;
+
+    for(int i = 0; i < NUM_LINES; i++)
+    {
+        glyphsPerRound += buildLine(size, set, i * 7, lines[i],
+                                    sizeof(lines[i]));
+    }
+
+    color_t white = {255, 255, 255, 255};
+    point_t pos   = {0, (SCREEN_HEIGHT / 2) + (gfx_getFontHeight(size) / 2)};
+
+    double start = now();
+    for(uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        gfx_clearScreen();
+        for(int l = 0; l < NUM_LINES; l++)
+            gfx_printBuffer(pos, size, TEXT_ALIGN_LEFT, white, lines[l]);
+    }
+    double elapsed = now() - start;
+
+    return (((double) glyphsPerRound) * ITERATIONS * 1e6) / elapsed;
+}
+
+int main()
+{
+    platform_init();
+    gfx_init();
+
+    printf("size  all chars (glyphs/s)  digits (glyphs/s)\n");
+
+    for(int size = FONT_SIZE_5PT; size <= FONT_SIZE_24PT; size++)
+    {
+        double all = benchmark(size, allChars);
+        double num = benchmark(size, digits);
+        printf("%-5s %20.0f %18.0f\n", sizeNames[size], all, num);
+    }
+
+    return 0;
+}
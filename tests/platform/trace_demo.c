@@ -0,0 +1,109 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Trace recorder demo for the linux target, to be built with the trace meson
+ * option enabled. First the cost of a single event is measured, then a worker
+ * thread reads channels from the nonvolatile memory while the main thread
+ * renders frames. The trace is saved at exit in Chrome trace format.
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/delays.h>
+#include <interfaces/nvmem.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include <trace.h>
+
+#ifndef ENABLE_TRACE
+#error "This demo requires ENABLE_TRACE"
+#endif
+
+static void *worker(void *arg)
+{
+    (void) arg;
+
+    channel_t channel;
+    for(uint16_t i = 1; i <= 20; i++)
+    {
+        nvm_readChannelData(&channel, i);
+        TRACE_COUNTER("channel", i);
+        sleepFor(0u, 5u);
+    }
+
+    return NULL;
+}
+
+static void *benchmark(void *arg)
+{
+    (void) arg;
+
+    // Measure the cost of a single event, in a thread of its own so that its
+    // records do not overwrite the ones of the main thread
+    const uint32_t numEvents = 1000000;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(uint32_t i = 0; i < numEvents; i++)
+        TRACE_COUNTER("bench", i);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = ((end.tv_sec - start.tv_sec) * 1e9
+              +  (end.tv_nsec - start.tv_nsec)) / numEvents;
+    printf("%.1f ns per event\n", ns);
+
+    return NULL;
+}
+
+int main()
+{
+    trace_init();
+    nvm_init();
+    gfx_init();
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, benchmark, NULL);
+    pthread_join(thread, NULL);
+
+    pthread_create(&thread, NULL, worker, NULL);
+
+    for(int i = 0; i < 10; i++)
+    {
+        gfx_clearScreen();
+        gfx_render();
+        sleepFor(0u, 10u);
+    }
+
+    pthread_join(thread, NULL);
+
+    printf("Trace saved in %s\n", TRACE_FILE);
+
+    return 0;
+}
@@ -0,0 +1,377 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   As a special exception, if other files instantiate templates or use   *
+ *   macros or inline functions from this file, or you compile this file   *
+ *   and link it with other works to produce a work based on this file,    *
+ *   this file does not by itself cause the resulting work to be covered   *
+ *   by the GNU General Public License. However the source code for this   *
+ *   file must still be made available in accordance with the GNU General  *
+ *   Public License. This exception does not invalidate any other reasons  *
+ *   why a work based on this file might be covered by the GNU General     *
+ *   Public License.                                                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+/**
+ * Scripted UI automation harness for the linux target, best built with the
+ * headless display backend. Keyboard and knob events are read from a script
+ * and injected into the UI event queue, then processed like the UI thread
+ * does: the UI state machine is updated and the GUI is drawn and rendered for
+ * each event. Processing and rendering times of each event are recorded and
+ * summarised per key; optionally, a hash of each rendered frame is written to
+ * a file, to be compared against a golden run. The clock shown on the screen
+ * is fixed, for the hashes to be reproducible.
+ *
+ * Usage: ui_replay [-r] [-v] [-o hashes.txt] [script]
+ *  -r: real time, wait the delays of the script instead of skipping them. The
+ *      UI and the timers always run on the system clock, the delays are only
+ *      summed into the scripted time reported for each event;
+ *  -v: print a line for each event;
+ *  -o: write the frame hashes to the given file.
+ *
+ * Script format, one step per line, '#' starts a comment:
+ *   <delay> <key> [x<count>] [long]
+ * where delay is the time in milliseconds from the previous step, key is one
+ * of the names below, count repeats the step and "long" sends a long press.
+ * Each step posts a key press event and a key release event. A built-in
+ * navigation flow is run if no script is given.
+ */
+
+#include <interfaces/graphics.h>
+#include <interfaces/display.h>
+#include <interfaces/platform.h>
+#include <interfaces/keyboard.h>
+#include <interfaces/delays.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <event.h>
+#include <queue.h>
+#include <state.h>
+#include <ui.h>
+#undef main     //necessary to avoid conflicts with SDL_main
+
+#if defined PIX_FMT_RGB565
+#define FB_BYTES (SCREEN_WIDTH * SCREEN_HEIGHT * 2)
+#elif defined PIX_FMT_GRAYSC
+#define FB_BYTES (SCREEN_WIDTH * SCREEN_HEIGHT)
+#else
+#define FB_BYTES ((SCREEN_WIDTH * SCREEN_HEIGHT) / 8)
+#endif
+
+#define MAX_EVENTS 65536
+
+extern queue_t ui_queue;
+
+typedef struct
+{
+    const char *name;
+    keyboard_t  key;
+}
+keyName_t;
+
+static const keyName_t keyNames[] =
+{
+    {"0", KEY_0}, {"1", KEY_1}, {"2", KEY_2}, {"3", KEY_3}, {"4", KEY_4},
+    {"5", KEY_5}, {"6", KEY_6}, {"7", KEY_7}, {"8", KEY_8}, {"9", KEY_9},
+    {"STAR", KEY_STAR},   {"HASH", KEY_HASH}, {"ENTER", KEY_ENTER},
+    {"ESC", KEY_ESC},     {"UP", KEY_UP},     {"DOWN", KEY_DOWN},
+    {"LEFT", KEY_LEFT},   {"RIGHT", KEY_RIGHT}, {"MONI", KEY_MONI},
+    {"F1", KEY_F1},       {"KNOB_LEFT", KNOB_LEFT},
+    {"KNOB_RIGHT", KNOB_RIGHT}
+};
+
+#define NUM_KEY_NAMES (sizeof(keyNames) / sizeof(keyNames[0]))
+
+static const char *defaultScript =
+    "# Open the menu, walk through it and back to the VFO screen\n"
+    "0    ENTER\n"
+    "150  DOWN x8\n"
+    "150  UP x8\n"
+    "# Info screen, scrolled with the knob\n"
+    "150  DOWN x6\n"
+    "150  ENTER\n"
+    "100  KNOB_RIGHT x10\n"
+    "150  ESC\n"
+    "150  ESC\n"
+    "# Tune the VFO with the knob and type a frequency\n"
+    "100  KNOB_RIGHT x100\n"
+    "100  KNOB_LEFT x100\n"
+    "200  4\n"
+    "150  3\n"
+    "150  0\n"
+    "150  1\n"
+    "150  2\n"
+    "150  5\n"
+    "150  ENTER\n";
+
+typedef struct
+{
+    uint32_t count;
+    double   fsmSum;
+    double   fsmMax;
+    double   renderSum;
+    double   renderMax;
+}
+keyStats_t;
+
+static keyStats_t keyStats[NUM_KEY_NAMES];
+static double     fsmTimes[MAX_EVENTS];
+static double     renderTimes[MAX_EVENTS];
+static uint32_t   numEvents = 0;
+static bool       realTime  = false;
+static bool       verbose   = false;
+static FILE      *hashFile  = NULL;
+static double     scriptMs  = 0.0;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1e6) + (ts.tv_nsec / 1e3);
+}
+
+static uint32_t frameHash()
+{
+    // 32-bit FNV-1a over the framebuffer sent to the display
+    const uint8_t *fb   = (const uint8_t *) display_getFrameBuffer();
+    uint32_t       hash = 2166136261u;
+    for(size_t i = 0; i < FB_BYTES; i++)
+        hash = (hash ^ fb[i]) * 16777619u;
+
+    return hash;
+}
+
+static int cmpDouble(const void *a, const void *b)
+{
+    double x = *((const double *) a);
+    double y = *((const double *) b);
+    return (x > y) - (x < y);
+}
+
+/**
+ * Post an event to the UI queue and process it like the UI thread.
+ */
+static void injectEvent(uint8_t keyIdx, keyboard_t keys, bool longPress)
+{
+    kbd_msg_t msg;
+    msg.value      = 0;
+    msg.keys       = keys;
+    msg.long_press = longPress;
+
+    event_t event;
+    event.type    = EVENT_KBD;
+    event.payload = msg.value;
+    (void) queue_postPriority(&ui_queue, event.value);
+
+    while(queue_pend(&ui_queue, &event.value, false))
+    {
+        bool sync_rtx = false;
+
+        double start = now();
+        ui_updateFSM(event, &sync_rtx);
+        ui_saveState();
+        double fsm = now();
+        ui_updateGUI();
+        gfx_render();
+        gfx_waitRender();
+        double end = now();
+        ui_prefetch();
+
+        double fsmTime    = fsm - start;
+        double renderTime = end - fsm;
+        keyStats_t *ks    = &keyStats[keyIdx];
+        ks->count        += 1;
+        ks->fsmSum       += fsmTime;
+        ks->renderSum    += renderTime;
+        if(fsmTime > ks->fsmMax)       ks->fsmMax    = fsmTime;
+        if(renderTime > ks->renderMax) ks->renderMax = renderTime;
+
+        if(numEvents < MAX_EVENTS)
+        {
+            fsmTimes[numEvents]    = fsmTime;
+            renderTimes[numEvents] = renderTime;
+        }
+
+        uint32_t hash = (hashFile != NULL || verbose) ? frameHash() : 0;
+        if(hashFile != NULL)
+            fprintf(hashFile, "%u %s%s %08x\n", numEvents,
+                    keyNames[keyIdx].name, (msg.keys != 0) ? "" : " up", hash);
+        if(verbose)
+            printf("%6u %10.1f %-10s %-4s %8.1f %8.1f %08x\n", numEvents,
+                   scriptMs, keyNames[keyIdx].name,
+                   (msg.keys != 0) ? "down" : "up", fsmTime, renderTime, hash);
+
+        numEvents += 1;
+    }
+}
+
+/**
+ * Run a single script step: wait the delay, then press and release the key.
+ */
+static bool runStep(char *line, unsigned int lineNum)
+{
+    char *hash = strchr(line, '#');
+    if(hash != NULL) *hash = '\0';
+
+    char *tok = strtok(line, " \t\r\n");
+    if(tok == NULL) return true;
+
+    unsigned long delay = strtoul(tok, NULL, 10);
+    char *key = strtok(NULL, " \t\r\n");
+    if(key == NULL)
+    {
+        fprintf(stderr, "line %u: missing key\n", lineNum);
+        return false;
+    }
+
+    uint8_t keyIdx = 0;
+    while((keyIdx < NUM_KEY_NAMES) && (strcmp(keyNames[keyIdx].name, key) != 0))
+        keyIdx++;
+
+    if(keyIdx == NUM_KEY_NAMES)
+    {
+        fprintf(stderr, "line %u: unknown key %s\n", lineNum, key);
+        return false;
+    }
+
+    unsigned long count     = 1;
+    bool          longPress = false;
+    while((tok = strtok(NULL, " \t\r\n")) != NULL)
+    {
+        if(tok[0] == 'x')
+            count = strtoul(&tok[1], NULL, 10);
+        else if(strcmp(tok, "long") == 0)
+            longPress = true;
+    }
+
+    for(unsigned long i = 0; i < count; i++)
+    {
+        scriptMs += delay;
+        if(realTime) delayMs(delay);
+
+        injectEvent(keyIdx, keyNames[keyIdx].key, longPress);
+        injectEvent(keyIdx, 0, false);
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *hashPath = NULL;
+    int opt;
+    while((opt = getopt(argc, argv, "rvo:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'r': realTime = true;     break;
+            case 'v': verbose  = true;     break;
+            case 'o': hashPath = optarg;   break;
+            default:
+                fprintf(stderr, "usage: %s [-r] [-v] [-o hashes] [script]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    FILE *script = NULL;
+    if(optind < argc)
+    {
+        script = fopen(argv[optind], "r");
+        if(script == NULL)
+        {
+            fprintf(stderr, "cannot open %s\n", argv[optind]);
+            return 1;
+        }
+    }
+    else
+    {
+        script = fmemopen((void *) defaultScript, strlen(defaultScript), "r");
+    }
+
+    if(hashPath != NULL)
+    {
+        hashFile = fopen(hashPath, "w");
+        if(hashFile == NULL)
+        {
+            fprintf(stderr, "cannot open %s\n", hashPath);
+            return 1;
+        }
+    }
+
+    platform_init();
+    state_init();
+    gfx_init();
+    ui_init();
+    queue_init(&ui_queue);
+
+    // Fixed clock, for the frame hashes to be reproducible
+    curTime_t time = {12, 0, 0, 1, 1, 1, 21};
+    state.time     = time;
+
+    // Initial screen
+    ui_saveState();
+    ui_updateGUI();
+    gfx_render();
+
+    if(verbose) printf(" event    time_ms key        dir   fsm_us render_us hash\n");
+
+    char         line[256];
+    unsigned int lineNum = 0;
+    double       start   = now();
+    while(fgets(line, sizeof(line), script) != NULL)
+    {
+        lineNum++;
+        if(!runStep(line, lineNum)) return 1;
+    }
+    double elapsed = now() - start;
+
+    fclose(script);
+    if(hashFile != NULL) fclose(hashFile);
+
+    printf("\nkey         events   fsm avg   fsm max  render avg  render max (us)\n");
+    for(uint8_t i = 0; i < NUM_KEY_NAMES; i++)
+    {
+        const keyStats_t *ks = &keyStats[i];
+        if(ks->count == 0) continue;
+        printf("%-10s %7u %9.1f %9.1f %11.1f %11.1f\n", keyNames[i].name,
+               ks->count, ks->fsmSum / ks->count, ks->fsmMax,
+               ks->renderSum / ks->count, ks->renderMax);
+    }
+
+    uint32_t n = (numEvents < MAX_EVENTS) ? numEvents : MAX_EVENTS;
+    if(n > 0)
+    {
+        qsort(fsmTimes, n, sizeof(double), cmpDouble);
+        qsort(renderTimes, n, sizeof(double), cmpDouble);
+        printf("\n%u events in %.1f ms (%s, %.0f ms scripted)\n",
+               numEvents, elapsed / 1000.0,
+               realTime ? "real time" : "delays skipped", scriptMs);
+        printf("fsm    p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+               fsmTimes[n / 2], fsmTimes[(n * 99) / 100], fsmTimes[n - 1]);
+        printf("render p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+               renderTimes[n / 2], renderTimes[(n * 99) / 100],
+               renderTimes[n - 1]);
+    }
+
+    return 0;
+}